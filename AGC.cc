@@ -14,134 +14,136 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define AGC_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define AGC_NEON
+#endif
 #include "AGC.h"
+#include "Stream.h"
 
 /* ---------------------------------------------------------------------- */
-void AGC::init(float target) {
+void AGC::init(float target, float attackSamples, float decaySamples, int lookahead) {
   this->target = target;
-  // Build correction table
-  for (int i = 0; i < SIZE_OF_CORRECTION_TABLE; i++) {
-    if (i) {
-      correctionTable[i].ratio = i * 0.1;
-      correctionTable[i].dBCorrection = logf(correctionTable[i].ratio) / logf(10.0) * 10.0;
-    } else {
-      correctionTable[i].ratio = 0.0;
-      correctionTable[i].dBCorrection = -20.0;
-    }
-  }
-  // tweak values where ratio is near 1.0
-  correctionTable[8].dBCorrection = -0.45;
-  correctionTable[9].dBCorrection = -0.05;
-  correctionTable[10].dBCorrection = 0.0;
-  correctionTable[11].dBCorrection = 0.05;
-  correctionTable[12].dBCorrection = 0.35;
-  // Build dB to gain table
-  gainDB = GAIN_MIN_DB;
-  for (int i = 0; i < SIZE_OF_GAIN_TABLE; i++) {
-    gainTable[i].gainDB = gainDB;
-    if (i == (SIZE_OF_GAIN_TABLE - 1)) {
-      gainTable[i].baseGain = powf(10.0, gainDB/10.0);
-      gainTable[i].deltaGain = 0.0;
-      gainTable[i-1].deltaGain = (gainTable[i].baseGain - gainTable[i-1].baseGain)/3.0;
-    } else {
-      gainTable[i].baseGain = powf(10.0, gainDB/10.0);
-      if (i) gainTable[i-1].deltaGain = (gainTable[i].baseGain - gainTable[i-1].baseGain)/3.0;
-    }
-    gainDB += GAIN_DELTA;
-  }
-  // Write out tables
-  fprintf(stderr, "AGC Correction Table\n");
-  for (int i = 0; i < SIZE_OF_CORRECTION_TABLE; i++) {
-    fprintf(stderr, "index: %d, correction ratio: %f, correction in dB: %f\n", i, correctionTable[i].ratio,
-            correctionTable[i].dBCorrection);
-  }
-  fprintf(stderr, "dB to Gain Table\n");
-  for (int i = 0; i < SIZE_OF_GAIN_TABLE; i++) {
-    fprintf(stderr, "index: %d, Gain in dB: %f, base gain: %f, gain delta %f\n", i, gainTable[i].gainDB,
-            gainTable[i].baseGain, gainTable[i].deltaGain);
-  }
-  // set initial gains for main loop
-  gain = 100.0;
-  gainDB = 20.0;
+  this->lookahead = lookahead > 0 ? lookahead : 0;
+  // the envelope must be within 5% of a new level by the time it is output
+  if (this->lookahead > 0 && attackSamples > this->lookahead / 3.0) attackSamples = this->lookahead / 3.0;
+  attack = attackSamples > 0.0 ? expf(-SEGMENT / attackSamples) : 0.0;
+  decay = decaySamples > 0.0 ? expf(-SEGMENT / decaySamples) : 0.0;
+  window = (this->lookahead + SEGMENT - 1) / SEGMENT + 1;
+  windowIndex = 0;
+  levels = reinterpret_cast<float *>(calloc(window, sizeof(float)));
+  started = false;
+  envelope = 0.0;
+  peak = 0.0;
+  gain = 1.0;
+  buffer = reinterpret_cast<float *>(calloc(this->lookahead + BUFFER_SIZE, sizeof(float)));
+  output = reinterpret_cast<float *>(malloc(BUFFER_SIZE * sizeof(float)));
 }
 
 AGC::AGC(void) {
-  init(1.0);
+  init(1.0, DEFAULT_ATTACK, DEFAULT_DECAY, 0);
 }
 
 AGC::AGC(float target) {
-  init(target);
+  init(target, DEFAULT_ATTACK, DEFAULT_DECAY, 0);
 }
 
+AGC::AGC(float target, float attackSamples, float decaySamples, int lookahead) {
+  init(target, attackSamples, decaySamples, lookahead);
+}
+
+/* ---------------------------------------------------------------------- */
+//  Each segment of new input moves the envelope and sets the gain at the
+//  end of the matching segment of output, lookahead samples older; the
+//  gain between is a straight line, so there are no steps.
 void AGC::doWork() {
-  float signal[BUFFER_SIZE];
-  float output[BUFFER_SIZE];
-  float * signalPtr = 0;
-  float * outputPtr = 0;
-  fprintf(stderr, "AGC with target value of %f\n", target);
-  bool done = false;
-  size_t count = 0;
-  float observedTarget = 0.0;
-  while (!done) {
-    // fprintf(stderr, "top of loop, sizeof correctionTable: %d, sizeof gainTable: %d,
-    // sizeof signal: %d, sizeof output: %d\n", sizeof(correctionTable), sizeof(gainTable),
-    // sizeof(signal), sizeof(output));
-    count = fread(&signal, sizeof(float), BUFFER_SIZE, stdin);
-    // fprintf(stderr, "read done\n");
-    if (count < BUFFER_SIZE) {
-      done = true;
-      continue;
+  fprintf(stderr, "AGC with target value of %f, lookahead of %d samples\n", target, lookahead);
+  float * signal = buffer + lookahead;
+  for (;;) {
+    int count = Stream::input()->read(signal, sizeof(float), BUFFER_SIZE);
+    for (int done = 0; done < count; done += SEGMENT) {
+      int size = count - done < SEGMENT ? count - done : SEGMENT;
+      float newGain = adjustGain(findTarget(signal + done, size));
+      ramp(buffer + done, output + done, size, newGain);
     }
-    signalPtr = signal;
-    outputPtr = output;
-    for (size_t i = 0; i < BUFFER_SIZE; i++) {  // apply gain
-      *outputPtr++ = *signalPtr++ * gain;
+    Stream::output()->write(output, sizeof(float), count);
+    memmove(buffer, buffer + count, lookahead * sizeof(float));
+    if (count < BUFFER_SIZE) {
+      // what is still delayed goes out at the last gain
+      for (int i = 0; i < lookahead; i++) buffer[i] *= gain;
+      Stream::output()->write(buffer, sizeof(float), lookahead);
+      break;
     }
-    // fprintf(stderr, "doing write\n");
-    fwrite(output, sizeof(float), count, stdout);
-    // find target within input
-    // fprintf(stderr, "finding target\n");
-    observedTarget = findTarget(output, BUFFER_SIZE);
-    // calculate new gain for next pass
-    // fprintf(stderr, "calculating new gain\n");
-    gain = adjustGain(observedTarget);
-    fprintf(stderr, "gain: %f, gainDB: %f, target: %f\n", gain, gainDB, observedTarget);
   }
 }
 
-float AGC::findTarget(float * buffer, size_t size) {
+/* ---------------------------------------------------------------------- */
+float AGC::findTarget(const float * buffer, int size) {
+  int i = 0;
   float absoluteSum = 0.0;
-  for (size_t i = 0; i < size; i++) {
-    absoluteSum += fabsf(*buffer++);
-  }
-  return absoluteSum * scale;
+#if defined(AGC_SSE)
+  const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+  __m128 sums = _mm_setzero_ps();
+  for (; i + 4 <= size; i += 4) sums = _mm_add_ps(sums, _mm_and_ps(_mm_loadu_ps(buffer + i), magnitude));
+  float lanes[4];
+  _mm_storeu_ps(lanes, sums);
+  absoluteSum = (lanes[0] + lanes[1]) + (lanes[2] + lanes[3]);
+#elif defined(AGC_NEON)
+  float32x4_t sums = vdupq_n_f32(0.0f);
+  for (; i + 4 <= size; i += 4) sums = vaddq_f32(sums, vabsq_f32(vld1q_f32(buffer + i)));
+  float32x2_t pairs = vadd_f32(vget_low_f32(sums), vget_high_f32(sums));
+  absoluteSum = vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+#endif
+  for (; i < size; i++) absoluteSum += fabsf(buffer[i]);
+  return absoluteSum / size;
 }
 
+/* ---------------------------------------------------------------------- */
 float AGC::adjustGain(float observedTarget) {
-  float perfectCorrection = target/observedTarget;
-  // fprintf(stderr, "perfectCorrection: %f, target: %f, observedTarget: %f\n",
-  // perfectCorrection, target, observedTarget);
-  float correctionDB = 0.0;
-  float rawGain = 0.0;
-  int i = 0;
-  if (perfectCorrection > MAX_CORRECTION_ALLOWED) {
-    perfectCorrection = MAX_CORRECTION_ALLOWED;
+  // the envelope follows the highest level the delayed output has yet to pass
+  float level = windowPeak(observedTarget);
+  float coefficient = level > envelope ? attack : decay;
+  envelope = started ? level + coefficient * (envelope - level) : level;
+  // silence asks for an infinite gain, held to the limit like any other
+  float newGain = target / envelope;
+  if (newGain > GAIN_MAX) newGain = GAIN_MAX;
+  if (!(newGain >= GAIN_MIN)) newGain = GAIN_MIN;
+  if (!started) {
+    gain = newGain;  // no ramp from an arbitrary gain at the start
+    started = true;
   }
-  while (correctionTable[i].ratio < perfectCorrection && i < SIZE_OF_CORRECTION_TABLE) i++;
-  correctionDB = correctionTable[i].dBCorrection;
-  gainDB += correctionDB;
-  // fprintf(stderr, "gainDB: %f, correctionDB: %f, observedTarget: %f\n", gainDB, correctionDB, observedTarget);
-  // convert gain in dB to gain
-  if (gainDB < GAIN_MIN_DB) {
-    gainDB = GAIN_MIN_DB;
-  } else  if (gainDB > GAIN_MAX_DB) {
-    gainDB = GAIN_MAX_DB;
+  return newGain;
+}
+
+/* ---------------------------------------------------------------------- */
+//  The segment of output being ramped is lookahead samples behind the
+//  input, so every level measured since it was input is still ahead of it.
+float AGC::windowPeak(float level) {
+  float leaving = levels[windowIndex];
+  levels[windowIndex] = level;
+  windowIndex = (windowIndex + 1) % window;
+  if (level >= peak) {
+    peak = level;
+  } else if (leaving >= peak) {
+    peak = level;
+    for (int i = 0; i < window; i++) if (levels[i] > peak) peak = levels[i];
   }
-  i = 0;
-  while (gainTable[i].gainDB < gainDB && i < SIZE_OF_GAIN_TABLE) i++;
-  rawGain = gainTable[i].baseGain + (gainDB - gainTable[i].gainDB)*gainTable[i].deltaGain;
-  return (ALPHA * rawGain + BETA * gain);
+  return peak;
+}
+
+/* ---------------------------------------------------------------------- */
+void AGC::ramp(const float * input, float * output, int size, float endGain) {
+  const float step = (endGain - gain) / size;
+  const float start = gain;
+  for (int i = 0; i < size; i++) output[i] = input[i] * (start + step * (i + 1));
+  gain = endGain;
 }
-AGC::~AGC(void) {
-};
 
+AGC::~AGC(void) {
+  free(buffer);
+  free(output);
+  free(levels);
+}
@@ -2,7 +2,13 @@
 #define AGC_H_
 /*
  *      AGC.h - Automatic Gain Control - produce a gain that keeps a signal 
- *              at a target level.
+ *              at a target level.  An envelope follower with separate
+ *              attack and decay tracks the average absolute level every
+ *              few samples, the gain ramps linearly between those points,
+ *              and an optional lookahead delays the signal so the gain has
+ *              come down before a peak reaches the output: the envelope
+ *              follows the highest level across the lookahead and rises
+ *              within it.
  *
  *      Copyright (C) 2022 
  *          Mark Broihier
@@ -15,32 +21,41 @@
 /* ---------------------------------------------------------------------- */
 class AGC {
  private:
-  const size_t BUFFER_SIZE = 4096;
-  const float scale = 1.0 / BUFFER_SIZE;
-  struct CorrectionRecord { float ratio; float dBCorrection; };
-  struct GainRecord { float baseGain; float deltaGain; float gainDB; };
-  static const int SIZE_OF_CORRECTION_TABLE = 30;
-  static const int SIZE_OF_GAIN_TABLE = 17;
-  const float MAX_CORRECTION_ALLOWED = 2.9;
-  // these constants are in dB
-  const float GAIN_MIN_DB = -19.0;
-  const float GAIN_MAX_DB = 29.0;
-  const float GAIN_DELTA = 3.0;
-  const float ALPHA = 0.2;
-  const float BETA = 1.0 - ALPHA;
-  struct CorrectionRecord correctionTable[SIZE_OF_CORRECTION_TABLE];
-  struct GainRecord gainTable[SIZE_OF_GAIN_TABLE];
+  static const int BUFFER_SIZE = 4096;
+  static const int SEGMENT = 32;                 // samples between points of the gain ramp
+  // gain limits, -19 and 29 dB as 10 log
+  static constexpr float GAIN_MIN = 0.012589;
+  static constexpr float GAIN_MAX = 794.33;
   float target;
-  float gain;
-  float gainDB;
-  void init(float target);
-  float findTarget(float * buffer, size_t size);
+  float attack;            // envelope coefficients per segment, for a rising and a falling level
+  float decay;
+  int lookahead;           // samples the output is delayed behind the envelope
+  int window;              // segments of input the delayed output has yet to pass
+  int windowIndex;
+  float * levels;          // level of each of those segments
+  bool started;            // the envelope has its first measurement
+  float envelope;          // average absolute level
+  float peak;              // highest level across the window
+  float gain;              // at the end of the last segment
+  float * buffer;          // lookahead samples of history, then the block
+  float * output;
+  void init(float target, float attackSamples, float decaySamples, int lookahead);
+  float findTarget(const float * buffer, int size);
   float adjustGain(float observedTarget);
+  void ramp(const float * input, float * output, int size, float endGain);
+  float windowPeak(float level);
 
  public:
+  // time constants of the envelope, in samples
+  static constexpr float DEFAULT_ATTACK = 512.0;
+  static constexpr float DEFAULT_DECAY = 16384.0;
+
   void doWork();
   AGC(void);
   explicit AGC(float target);
+  // attack and decay time constants in samples, lookahead in samples; with
+  // a lookahead the attack is at most a third of it
+  AGC(float target, float attackSamples, float decaySamples, int lookahead);
   ~AGC(void);
 };
 #endif  // AGC_H_
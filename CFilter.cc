@@ -4,6 +4,13 @@
  *      Copyright (C) 2022
  *          Mark Broihier
  *
+ *  A block of bytes is widened to integers, run through each integrator
+ *  in turn and every decimation'th sum through the combs.  The integers
+ *  wrap, and that is harmless: as long as they are as wide as the filter's
+ *  output can grow (8 bits plus order * log2(decimation * delay)), the
+ *  combs' differences come out exact.  32 bit integrators are used when
+ *  that is enough, 64 bit otherwise.  The integrators and combs are in
+ *  CICKernels, shared with the CIC stage of MultiStageDecimator.
  */
 
 /* ---------------------------------------------------------------------- */
@@ -16,90 +23,185 @@
 #include <string.h>
 
 #include "CFilter.h"
+#include "CICKernels.h"
+#include "FIRKernels.h"
+#include "KaiserWindow.h"
+#include "Stream.h"
 
 /* ---------------------------------------------------------------------- */
 CFilter::CFilter(int decimation) {
-  doWork(decimation);
+  doWork(decimation, 2, 2, false, 0, false);
 }
 /* ---------------------------------------------------------------------- */
-void CFilter::doWork(int decimation) {
+CFilter::CFilter(int decimation, bool unsignedInput) {
+  doWork(decimation, 2, 2, unsignedInput, 0, false);
+}
+/* ---------------------------------------------------------------------- */
+CFilter::CFilter(int decimation, int order, int delay, bool unsignedInput, int compensationTaps) {
+  doWork(decimation, order, delay, unsignedInput, compensationTaps, true);
+}
+/* ---------------------------------------------------------------------- */
+void CFilter::doWork(int decimation, int order, int delay, bool unsignedInput, int compensationTaps,
+                     bool normalize) {
+  BUFFER_SIZE = 0;
+  inputBuffer = 0;
+  outputBuffer = 0;
+  work32 = 0;
+  work64 = 0;
+  sums = 0;
+  combs = 0;
+  differences = 0;
+  compensation = 0;
+  compensationBuffer = 0;
+  int bits = 8 + ceil(order * log2(static_cast<double>(decimation) * delay));
+  if (decimation < 1 || order < 1 || delay < 1 || bits > MAX_BITS ||
+      (compensationTaps != 0 && (compensationTaps < 3 || !(compensationTaps & 1)))) {
+    fprintf(stderr, "CIC filter needs decimation, order and delay of 1 or more, at most %d bits of gain and "
+            "an odd number of compensation coefficients (3 or more)\n", MAX_BITS - 8);
+    return;
+  }
   this->decimation = decimation;
-  BUFFER_SIZE = decimation * 2;
-  inputBuffer = reinterpret_cast<signed char *>(malloc(decimation * 2 * sizeof(signed char)));
-  outputBuffer = reinterpret_cast<float *>(malloc(2 * sizeof(float)));
+  this->order = order;
+  this->delay = delay;
+  this->unsignedInput = unsignedInput;
+  this->compensationTaps = compensationTaps;
+  wide = bits > 32;
+  outputs = BLOCK_SAMPLES / decimation;
+  if (outputs < 1) outputs = 1;
+  int samples = outputs * decimation;
+  BUFFER_SIZE = samples * 2;
+  inputBuffer = reinterpret_cast<unsigned char *>(malloc(BUFFER_SIZE * sizeof(unsigned char)));
+  outputBuffer = reinterpret_cast<float *>(malloc(outputs * 2 * sizeof(float)));
+  work32 = reinterpret_cast<uint32_t *>(malloc(samples * 2 * sizeof(uint32_t)));
+  if (wide) work64 = reinterpret_cast<uint64_t *>(malloc(samples * 2 * sizeof(uint64_t)));
+  sums = reinterpret_cast<uint64_t *>(calloc(order * 2, sizeof(uint64_t)));
+  combs = reinterpret_cast<uint64_t *>(calloc(order * delay * 2, sizeof(uint64_t)));
+  combIndex = 0;
+  differences = reinterpret_cast<uint64_t *>(malloc(outputs * 2 * sizeof(uint64_t)));
+  scale = normalize ? 1.0 / (pow(static_cast<double>(decimation) * delay, order) * 128.0) : 1.0;
+  fprintf(stderr, "CIC filter: decimation %d, order %d, differential delay %d, %d bit integrators\n",
+          decimation, order, delay, wide ? 64 : 32);
+  if (compensationTaps) designCompensation();
+}
+
+/* ---------------------------------------------------------------------- */
+//  The inverse of the CIC response up to the cutoff, and nothing above,
+//  windowed to compensationTaps coefficients.  With a differential delay
+//  the droop steepens in proportion, so the flattened band narrows with it.
+void CFilter::designCompensation(void) {
+  const int STEPS = 512;
+  double cutoff = COMPENSATION_CUTOFF / delay;
+  auto inverse = [&](double f) {  // f a fraction of the output rate
+    if (f == 0.0) return 1.0;
+    double response = sin(M_PI * delay * f) / (decimation * delay * sin(M_PI * f / decimation));
+    return pow(fabs(response), -order);
+  };
+  float * coefficients = KaiserWindow::window(compensationTaps, COMPENSATION_ATTENUATION);
+  int middle = (compensationTaps - 1) / 2;
+  double sum = 0.0;
+  for (int n = 0; n <= middle; n++) {
+    double integral = 0.0;
+    for (int step = 0; step < STEPS; step++) {
+      double f = (step + 0.5) * cutoff / STEPS;
+      integral += inverse(f) * cos(2.0 * M_PI * f * (n - middle));
+    }
+    coefficients[n] = coefficients[compensationTaps - 1 - n] = 2.0 * integral * cutoff / STEPS * coefficients[n];
+  }
+  for (int n = 0; n < compensationTaps; n++) sum += coefficients[n];
+  for (int n = 0; n < compensationTaps; n++) coefficients[n] /= sum;
+  compensation = FIRKernels::interleave(coefficients, compensationTaps);
+  free(coefficients);
+  compensationBuffer = reinterpret_cast<float *>(calloc((compensationTaps - 1 + outputs) * 2, sizeof(float)));
+  fprintf(stderr, "CIC droop compensation: %d coefficients, cutoff at %.3f of the output rate, %.2f dB of lift there\n",
+          compensationTaps, cutoff, 20.0 * log10(inverse(cutoff)));
 }
 
 /* ---------------------------------------------------------------------- */
 int CFilter::readSignalPipe() {
-  int count = fread(inputBuffer, sizeof(signed char), BUFFER_SIZE, stdin);
+  int count = Stream::input()->read(inputBuffer, sizeof(unsigned char), BUFFER_SIZE);
   return count;
 }
 
 /* ---------------------------------------------------------------------- */
-int CFilter::writeSignalPipe() {
-  int count = fwrite(outputBuffer, sizeof(float), 2, stdout);
+int CFilter::writeSignalPipe(int blockOutputs) {
+  int count = Stream::output()->write(outputBuffer, sizeof(float), blockOutputs * 2);
   return count;
 }
 
 /* ---------------------------------------------------------------------- */
-//  Taken from rtlsdr_wsprd.c
-void CFilter::filterSignal() {
-  int IIntegrator1= 0.0;
-  int QIntegrator1 = 0.0;
-  int IIntegrator2= 0.0;
-  int QIntegrator2 = 0.0;
-  int Iy1 = 0.0;
-  int It1z = 0.0;
-  int It1y = 0.0;
-  int Qy1 = 0.0;
-  int Qt1z = 0.0;
-  int Qt1y = 0.0;
-  int Iy2 = 0.0;
-  int It2z = 0.0;
-  int It2y = 0.0;
-  int Qy2 = 0.0;
-  int Qt2z = 0.0;
-  int Qt2y = 0.0;
-
+//  The first blockOutputs worth of samples in inputBuffer through the
+//  integrators, left in work32 or work64.
+void CFilter::integrate(int blockOutputs) {
+  int samples = blockOutputs * decimation;
+  CICKernels::widen(inputBuffer, samples * 2, unsignedInput, work32);
+  if (wide) {
+    CICKernels::extend(work32, samples * 2, work64);
+    for (int k = 0; k < order; k++) CICKernels::integrate64(work64, samples, sums + 2 * k);
+  } else {
+    for (int k = 0; k < order; k++) {
+      uint32_t sum[2] = { static_cast<uint32_t>(sums[2 * k]), static_cast<uint32_t>(sums[2 * k + 1]) };
+      CICKernels::integrate32(work32, samples, sum);
+      sums[2 * k] = sum[0];
+      sums[2 * k + 1] = sum[1];
+    }
+  }
+}
 
+/* ---------------------------------------------------------------------- */
+void CFilter::filterSignal() {
+  if (!valid()) return;
   for (;;) {
-    if (readSignalPipe() != BUFFER_SIZE) {
+    int count = readSignalPipe();
+    // a short read is the end of the stream, after the whole outputs it holds
+    int blockOutputs = count == BUFFER_SIZE ? outputs : count / (2 * decimation);
+    if (blockOutputs > 0) filterBlock(blockOutputs);
+    if (count != BUFFER_SIZE) {
       fprintf(stderr, "Short read....\n");
-      exit(-1);
+      Stream::output()->close();
+      return;
     }
+  }
+}
 
-    signed char * sample = inputBuffer;
-    for (int i = 0; i < decimation; i++) {
-      IIntegrator1 += *sample++;
-      QIntegrator1 += *sample++;
-      IIntegrator2 += IIntegrator1;
-      QIntegrator2 += QIntegrator1;
-    }
-    Iy1 = IIntegrator2 - It1z;
-    It1z = It1y;
-    It1y = IIntegrator2;
-    Qy1 = QIntegrator2 - Qt1z;
-    Qt1z = Qt1y;
-    Qt1y = QIntegrator2;
-
-    Iy2 = Iy1 - It2z;
-    It2z = It2y;
-    It2y = Iy1;
-    Qy2 = Qy1 - Qt2z;
-    Qt2z = Qt2y;
-    Qt2y = Qy1;
-    outputBuffer[0] = Iy2;
-    outputBuffer[1] = Qy2;
-    if (debug) {
-      fprintf(stderr, "II1: %d, II2: %d, QI1: %d, QI2: %d\n", IIntegrator1, IIntegrator2, QIntegrator1, QIntegrator2);
+/* ---------------------------------------------------------------------- */
+//  blockOutputs worth of inputBuffer, at most a whole block, through the
+//  filter to the output stream.
+void CFilter::filterBlock(int blockOutputs) {
+  integrate(blockOutputs);
+  // combs on the sums kept, differences taken at the integrators' width
+  if (wide) {
+    CICKernels::comb(work64, blockOutputs, decimation, order, delay, combs, combIndex, differences);
+  } else {
+    CICKernels::comb(work32, blockOutputs, decimation, order, delay, combs, combIndex, differences);
+  }
+  float * output = compensationTaps ? compensationBuffer + (compensationTaps - 1) * 2 : outputBuffer;
+  for (int n = 0; n < blockOutputs * 2; n++) {
+    if (wide) {
+      output[n] = static_cast<int64_t>(differences[n]) * scale;
+    } else {
+      output[n] = static_cast<int32_t>(static_cast<uint32_t>(differences[n])) * scale;
     }
-    writeSignalPipe();
   }
+  if (debug) {
+    for (int k = 0; k < blockOutputs; k++) fprintf(stderr, "I: %f, Q: %f\n", output[2 * k], output[2 * k + 1]);
+  }
+  if (compensationTaps) {
+    FIRKernels::decimateSymmetricInterleaved(compensation, compensationTaps, compensationBuffer, 1, outputBuffer,
+                                             blockOutputs);
+    memmove(compensationBuffer, compensationBuffer + blockOutputs * 2, (compensationTaps - 1) * 2 * sizeof(float));
+  }
+  writeSignalPipe(blockOutputs);
 }
 
 /* ---------------------------------------------------------------------- */
 CFilter::~CFilter(void) {
   if (inputBuffer) free(inputBuffer);
   if (outputBuffer) free(outputBuffer);
+  if (work32) free(work32);
+  if (work64) free(work64);
+  if (sums) free(sums);
+  if (combs) free(combs);
+  if (differences) free(differences);
+  if (compensation) free(compensation);
+  if (compensationBuffer) free(compensationBuffer);
 }
-
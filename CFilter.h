@@ -1,7 +1,10 @@
 #ifndef CFILTER_H_
 #define CFILTER_H_
 /*
- *      CFilter.h - Comb filter class
+ *      CFilter.h - Comb filter class - a cascaded integrator comb (CIC)
+ *                  decimator for byte I/Q streams, of any order and
+ *                  differential delay, with an optional FIR to flatten its
+ *                  passband droop
  *
  *      Copyright (C) 2022
  *          Mark Broihier
@@ -9,23 +12,53 @@
  */
 
 /* ---------------------------------------------------------------------- */
-
+#include <stdint.h>
 /* ---------------------------------------------------------------------- */
 class CFilter {
  private:
   static const bool debug = false;
+  static const int BLOCK_SAMPLES = 1 << 14;  // input samples per block, rounded to a whole output
+  static const int MAX_BITS = 64;            // widest integrators
+  static constexpr double COMPENSATION_CUTOFF = 0.25;      // of the output rate
+  static constexpr double COMPENSATION_ATTENUATION = 60.0;  // dB
   int BUFFER_SIZE;   // number of bytes to read from the pipe
-  signed char * inputBuffer;  // buffer read directly from stream
+  unsigned char * inputBuffer;  // buffer read directly from stream
   float * outputBuffer;    // filtered I/Q values
   int decimation;
+  int order;               // number of integrators and of combs
+  int delay;               // differential delay of the combs, in outputs
+  bool unsignedInput;      // RTL style bytes centered on 128
+  bool wide;               // 64 bit integrators, else 32 bit
+  int outputs;             // outputs per block
+  uint32_t * work32;       // the block, widened and integrated
+  uint64_t * work64;
+  uint64_t * sums;         // integrator state, I/Q pairs
+  uint64_t * combs;        // the last delay inputs of each comb, I/Q pairs
+  int combIndex;
+  uint64_t * differences;  // the combs' outputs, I/Q pairs
+  double scale;            // integer output to float
+  int compensationTaps;    // 0 for none
+  float * compensation;    // coefficients duplicated for I/Q
+  float * compensationBuffer;  // taps - 1 outputs of history, then the block
 
   int readSignalPipe();
-  int writeSignalPipe();
-  void doWork(int decimation);
+  int writeSignalPipe(int blockOutputs);
+  void doWork(int decimation, int order, int delay, bool unsignedInput, int compensationTaps, bool normalize);
+  void designCompensation(void);
+  void integrate(int blockOutputs);
+  void filterBlock(int blockOutputs);
 
  public:
+  // the original filter: order 2, differential delay 2 and the output left
+  // scaled by the filter's gain
   explicit CFilter(int decimation);
+  CFilter(int decimation, bool unsignedInput);
+  // any order and delay, output scaled to a gain of 1 with full scale bytes
+  // at +/-1.0, and a droop compensation FIR of compensationTaps (odd) when
+  // not 0
+  CFilter(int decimation, int order, int delay, bool unsignedInput, int compensationTaps);
 
+  bool valid(void) { return BUFFER_SIZE > 0; }
   void filterSignal();
 
   ~CFilter(void);
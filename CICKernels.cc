@@ -0,0 +1,204 @@
+/*
+ *      CICKernels.cc - integrators and combs of the cascaded integrator comb
+ *                      filters
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  The integers wrap, and that is harmless: as long as they are as wide as
+ *  the filter's output can grow, the combs' differences come out exact.  A
+ *  running sum of I/Q pairs is a prefix sum, which the vector versions do
+ *  two pairs to a 128 bit register, or one pair in 64 bits.
+ */
+
+/* ---------------------------------------------------------------------- */
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CIC_SSE2
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CIC_NEON
+#endif
+
+#include "CICKernels.h"
+
+/* ---------------------------------------------------------------------- */
+void CICKernels::widen(const unsigned char * bytes, int count, bool unsignedInput, uint32_t * out) {
+  int n = 0;
+  unsigned char flip = unsignedInput ? 0x80 : 0;
+#if defined(CIC_SSE2)
+  const __m128i flips = _mm_set1_epi8(static_cast<char>(flip));
+  for (; n + 16 <= count; n += 16) {
+    __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(bytes + n)), flips);
+    __m128i low = _mm_srai_epi16(_mm_unpacklo_epi8(x, x), 8);  // sign extended to 16 bits
+    __m128i high = _mm_srai_epi16(_mm_unpackhi_epi8(x, x), 8);
+    __m128i * destination = reinterpret_cast<__m128i *>(out + n);
+    _mm_storeu_si128(destination, _mm_srai_epi32(_mm_unpacklo_epi16(low, low), 16));
+    _mm_storeu_si128(destination + 1, _mm_srai_epi32(_mm_unpackhi_epi16(low, low), 16));
+    _mm_storeu_si128(destination + 2, _mm_srai_epi32(_mm_unpacklo_epi16(high, high), 16));
+    _mm_storeu_si128(destination + 3, _mm_srai_epi32(_mm_unpackhi_epi16(high, high), 16));
+  }
+#elif defined(CIC_NEON)
+  const uint8x16_t flips = vdupq_n_u8(flip);
+  for (; n + 16 <= count; n += 16) {
+    int8x16_t x = vreinterpretq_s8_u8(veorq_u8(vld1q_u8(bytes + n), flips));
+    int16x8_t low = vmovl_s8(vget_low_s8(x));
+    int16x8_t high = vmovl_s8(vget_high_s8(x));
+    vst1q_u32(out + n, vreinterpretq_u32_s32(vmovl_s16(vget_low_s16(low))));
+    vst1q_u32(out + n + 4, vreinterpretq_u32_s32(vmovl_s16(vget_high_s16(low))));
+    vst1q_u32(out + n + 8, vreinterpretq_u32_s32(vmovl_s16(vget_low_s16(high))));
+    vst1q_u32(out + n + 12, vreinterpretq_u32_s32(vmovl_s16(vget_high_s16(high))));
+  }
+#endif
+  for (; n < count; n++) out[n] = static_cast<signed char>(bytes[n] ^ flip);
+}
+
+/* ---------------------------------------------------------------------- */
+void CICKernels::extend(const uint32_t * in, int count, uint64_t * out) {
+  int n = 0;
+#if defined(CIC_SSE2)
+  for (; n + 4 <= count; n += 4) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + n));
+    __m128i sign = _mm_srai_epi32(x, 31);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + n), _mm_unpacklo_epi32(x, sign));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + n + 2), _mm_unpackhi_epi32(x, sign));
+  }
+#elif defined(CIC_NEON)
+  for (; n + 4 <= count; n += 4) {
+    int32x4_t x = vreinterpretq_s32_u32(vld1q_u32(in + n));
+    vst1q_u64(out + n, vreinterpretq_u64_s64(vmovl_s32(vget_low_s32(x))));
+    vst1q_u64(out + n + 2, vreinterpretq_u64_s64(vmovl_s32(vget_high_s32(x))));
+  }
+#endif
+  for (; n < count; n++) out[n] = static_cast<int32_t>(in[n]);
+}
+
+/* ---------------------------------------------------------------------- */
+void CICKernels::fromFloat(const float * in, int count, double scale, uint64_t * out) {
+  for (int n = 0; n < count; n++) out[n] = static_cast<uint64_t>(static_cast<int64_t>(in[n] * scale));
+}
+
+/* ---------------------------------------------------------------------- */
+void CICKernels::toFloat(const uint64_t * in, int count, double scale, float * out) {
+  for (int n = 0; n < count; n++) out[n] = static_cast<int64_t>(in[n]) * scale;
+}
+
+/* ---------------------------------------------------------------------- */
+void CICKernels::integrate32(uint32_t * data, int pairs, uint32_t * sum) {
+  int n = 0;
+#if defined(CIC_SSE2)
+  __m128i carry = _mm_set_epi32(sum[1], sum[0], sum[1], sum[0]);
+  for (; n + 4 <= pairs; n += 4) {
+    __m128i * source = reinterpret_cast<__m128i *>(data + 2 * n);
+    __m128i a = _mm_loadu_si128(source);  // I0 Q0 I1 Q1
+    __m128i b = _mm_loadu_si128(source + 1);
+    a = _mm_add_epi32(a, _mm_slli_si128(a, 8));  // I0 Q0 I0+I1 Q0+Q1
+    b = _mm_add_epi32(b, _mm_slli_si128(b, 8));
+    a = _mm_add_epi32(a, carry);
+    carry = _mm_shuffle_epi32(a, _MM_SHUFFLE(3, 2, 3, 2));
+    b = _mm_add_epi32(b, carry);
+    carry = _mm_shuffle_epi32(b, _MM_SHUFFLE(3, 2, 3, 2));
+    _mm_storeu_si128(source, a);
+    _mm_storeu_si128(source + 1, b);
+  }
+  sum[0] = _mm_cvtsi128_si32(carry);
+  sum[1] = _mm_cvtsi128_si32(_mm_shuffle_epi32(carry, 1));
+#elif defined(CIC_NEON)
+  const uint32x4_t zero = vdupq_n_u32(0);
+  uint32x2_t last = vld1_u32(sum);
+  uint32x4_t carry = vcombine_u32(last, last);
+  for (; n + 4 <= pairs; n += 4) {
+    uint32x4_t a = vld1q_u32(data + 2 * n);
+    uint32x4_t b = vld1q_u32(data + 2 * n + 4);
+    a = vaddq_u32(a, vextq_u32(zero, a, 2));
+    b = vaddq_u32(b, vextq_u32(zero, b, 2));
+    a = vaddq_u32(a, carry);
+    carry = vcombine_u32(vget_high_u32(a), vget_high_u32(a));
+    b = vaddq_u32(b, carry);
+    carry = vcombine_u32(vget_high_u32(b), vget_high_u32(b));
+    vst1q_u32(data + 2 * n, a);
+    vst1q_u32(data + 2 * n + 4, b);
+  }
+  vst1_u32(sum, vget_low_u32(carry));
+#endif
+  uint32_t sumI = sum[0];
+  uint32_t sumQ = sum[1];
+  for (; n < pairs; n++) {
+    data[2 * n] = sumI += data[2 * n];
+    data[2 * n + 1] = sumQ += data[2 * n + 1];
+  }
+  sum[0] = sumI;
+  sum[1] = sumQ;
+}
+
+/* ---------------------------------------------------------------------- */
+void CICKernels::integrate64(uint64_t * data, int pairs, uint64_t * sum) {
+  int n = 0;
+#if defined(CIC_SSE2)
+  __m128i carry = _mm_loadu_si128(reinterpret_cast<const __m128i *>(sum));
+  for (; n + 2 <= pairs; n += 2) {
+    __m128i * source = reinterpret_cast<__m128i *>(data + 2 * n);
+    __m128i a = _mm_add_epi64(carry, _mm_loadu_si128(source));
+    carry = _mm_add_epi64(a, _mm_loadu_si128(source + 1));
+    _mm_storeu_si128(source, a);
+    _mm_storeu_si128(source + 1, carry);
+  }
+  _mm_storeu_si128(reinterpret_cast<__m128i *>(sum), carry);
+#elif defined(CIC_NEON)
+  uint64x2_t carry = vld1q_u64(sum);
+  for (; n + 2 <= pairs; n += 2) {
+    uint64x2_t a = vaddq_u64(carry, vld1q_u64(data + 2 * n));
+    carry = vaddq_u64(a, vld1q_u64(data + 2 * n + 2));
+    vst1q_u64(data + 2 * n, a);
+    vst1q_u64(data + 2 * n + 2, carry);
+  }
+  vst1q_u64(sum, carry);
+#endif
+  uint64_t sumI = sum[0];
+  uint64_t sumQ = sum[1];
+  for (; n < pairs; n++) {
+    data[2 * n] = sumI += data[2 * n];
+    data[2 * n + 1] = sumQ += data[2 * n + 1];
+  }
+  sum[0] = sumI;
+  sum[1] = sumQ;
+}
+
+/* ---------------------------------------------------------------------- */
+namespace {
+
+//  Each comb's line is delay pairs long, and the lines follow one another.
+template <typename T>
+void combAny(const T * data, int outputs, int decimation, int order, int delay, uint64_t * lines, int & lineIndex,
+             uint64_t * output) {
+  for (int k = 0; k < outputs; k++) {
+    int index = 2 * ((k + 1) * decimation - 1);
+    for (int channel = 0; channel < 2; channel++) {
+      uint64_t value = data[index + channel];
+      uint64_t * line = lines + 2 * lineIndex + channel;
+      for (int stage = 0; stage < order; stage++) {
+        uint64_t previous = *line;
+        *line = value;
+        value -= previous;
+        line += 2 * delay;
+      }
+      output[2 * k + channel] = value;
+    }
+    if (++lineIndex == delay) lineIndex = 0;
+  }
+}
+
+}  // namespace
+
+/* ---------------------------------------------------------------------- */
+void CICKernels::comb(const uint32_t * data, int outputs, int decimation, int order, int delay, uint64_t * lines,
+                      int & lineIndex, uint64_t * output) {
+  combAny(data, outputs, decimation, order, delay, lines, lineIndex, output);
+}
+
+/* ---------------------------------------------------------------------- */
+void CICKernels::comb(const uint64_t * data, int outputs, int decimation, int order, int delay, uint64_t * lines,
+                      int & lineIndex, uint64_t * output) {
+  combAny(data, outputs, decimation, order, delay, lines, lineIndex, output);
+}
@@ -0,0 +1,39 @@
+#ifndef CICKERNELS_H_
+#define CICKERNELS_H_
+/*
+ *      CICKernels.h - integrators and combs of the cascaded integrator comb
+ *                     filters, on I/Q pairs of wrapping integers.  The
+ *                     integrators are vectorized with SSE2 on x86 and
+ *                     NEON on ARM.
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdint.h>
+/* ---------------------------------------------------------------------- */
+namespace CICKernels {
+// bytes to integers, unsigned ones less 128 as convert_uByte_byte would
+void widen(const unsigned char * bytes, int count, bool unsignedInput, uint32_t * out);
+// sign extends 32 bit integers to 64
+void extend(const uint32_t * in, int count, uint64_t * out);
+// floats to 64 bit fixed point, multiplied by scale, and back
+void fromFloat(const float * in, int count, double scale, uint64_t * out);
+void toFloat(const uint64_t * in, int count, double scale, float * out);
+// running sums of pairs I/Q pairs in place, starting from and leaving the
+// sums in sum
+void integrate32(uint32_t * data, int pairs, uint32_t * sum);
+void integrate64(uint64_t * data, int pairs, uint64_t * sum);
+// the last pair of each decimation pairs of integrated data through order
+// combs of differential delay delay, outputs pairs to output (which may be
+// data).  lines holds the last delay inputs of each comb, I/Q pairs, comb
+// by comb, and lineIndex where the next one goes.  The differences are
+// taken at 64 bits; from 32 bit integrators only their low 32 bits count.
+void comb(const uint32_t * data, int outputs, int decimation, int order, int delay, uint64_t * lines,
+          int & lineIndex, uint64_t * output);
+void comb(const uint64_t * data, int outputs, int decimation, int order, int delay, uint64_t * lines,
+          int & lineIndex, uint64_t * output);
+}  // namespace CICKernels
+#endif  // CICKERNELS_H_
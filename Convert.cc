@@ -0,0 +1,234 @@
+/*
+ *      Convert.cc - block sample format conversions
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  A byte has only 256 values, so without vectors bytes become floats by
+ *  table lookup; with them, widening and scaling by 1/128 is exact and
+ *  faster than the lookups.
+ *  Floats become integers with a truncating convert and saturating packs.
+ *  On x86 the 16 bit scalings are done in double, as the scalar code did,
+ *  so a product a float rounding short of an integer truncates the same
+ *  way.
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define CONVERT_SSE
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define CONVERT_NEON
+#endif
+#include "Convert.h"
+/* ---------------------------------------------------------------------- */
+namespace {
+
+struct Tables {
+  float unsignedBytes[256];
+  float signedBytes[256];
+  Tables(void) {
+    for (int i = 0; i < 256; i++) {
+      unsignedBytes[i] = (i - 128) / 128.0;
+      signedBytes[i] = static_cast<int8_t>(i) / 128.0;
+    }
+  }
+};
+
+const Tables & tables(void) {
+  static const Tables built;
+  return built;
+}
+
+const float SCALE_16 = 32767.0;
+
+#if defined(CONVERT_SSE)
+// 16 signed bytes to floats over 128 - exact, so the same as the tables
+inline void signedBytesToFloat(__m128i bytes, float * output) {
+  const __m128 scale = _mm_set1_ps(1.0f / 128.0f);
+  __m128i low = _mm_unpacklo_epi8(bytes, bytes);
+  __m128i high = _mm_unpackhi_epi8(bytes, bytes);
+  _mm_storeu_ps(output, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(low, low), 24)), scale));
+  _mm_storeu_ps(output + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(low, low), 24)), scale));
+  _mm_storeu_ps(output + 8, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(high, high), 24)), scale));
+  _mm_storeu_ps(output + 12, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(high, high), 24)), scale));
+}
+#elif defined(CONVERT_NEON)
+inline void signedBytesToFloat(int8x16_t bytes, float * output) {
+  const float scale = 1.0f / 128.0f;
+  int16x8_t low = vmovl_s8(vget_low_s8(bytes));
+  int16x8_t high = vmovl_s8(vget_high_s8(bytes));
+  vst1q_f32(output, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(low))), scale));
+  vst1q_f32(output + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(low))), scale));
+  vst1q_f32(output + 8, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(high))), scale));
+  vst1q_f32(output + 12, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(high))), scale));
+}
+#endif
+
+}  // namespace
+
+/* ---------------------------------------------------------------------- */
+void Convert::uByteToFloat(const uint8_t * input, float * output, int count) {
+  const float * table = tables().unsignedBytes;
+  int i = 0;
+#if defined(CONVERT_SSE)
+  // flipping the top bit makes the bytes signed, centered on 0
+  for (; i + 16 <= count; i += 16) {
+    __m128i x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i)), _mm_set1_epi8(-128));
+    signedBytesToFloat(x, output + i);
+  }
+#elif defined(CONVERT_NEON)
+  for (; i + 16 <= count; i += 16) {
+    signedBytesToFloat(veorq_s8(vreinterpretq_s8_u8(vld1q_u8(input + i)), vdupq_n_s8(-128)), output + i);
+  }
+#endif
+  for (; i < count; i++) output[i] = table[input[i]];
+}
+
+/* ---------------------------------------------------------------------- */
+void Convert::byteToFloat(const int8_t * input, float * output, int count) {
+  const float * table = tables().signedBytes;
+  int i = 0;
+#if defined(CONVERT_SSE)
+  for (; i + 16 <= count; i += 16) {
+    signedBytesToFloat(_mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i)), output + i);
+  }
+#elif defined(CONVERT_NEON)
+  for (; i + 16 <= count; i += 16) signedBytesToFloat(vld1q_s8(input + i), output + i);
+#endif
+  for (; i < count; i++) output[i] = table[static_cast<uint8_t>(input[i])];
+}
+
+/* ---------------------------------------------------------------------- */
+void Convert::uByteToByte(const uint8_t * input, int8_t * output, int count) {
+  for (int i = 0; i < count; i++) output[i] = input[i] ^ 0x80;
+}
+
+/* ---------------------------------------------------------------------- */
+void Convert::floatToByte(const float * input, int8_t * output, int count) {
+  int i = 0;
+#if defined(CONVERT_SSE)
+  const __m128 low = _mm_set1_ps(-128.0f);
+  const __m128 high = _mm_set1_ps(127.0f);
+  for (; i + 16 <= count; i += 16) {
+    __m128i a = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(input + i), low), high));
+    __m128i b = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(input + i + 4), low), high));
+    __m128i c = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(input + i + 8), low), high));
+    __m128i d = _mm_cvttps_epi32(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(input + i + 12), low), high));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i),
+                     _mm_packs_epi16(_mm_packs_epi32(a, b), _mm_packs_epi32(c, d)));
+  }
+#elif defined(CONVERT_NEON)
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t words = vcombine_s16(vqmovn_s32(vcvtq_s32_f32(vld1q_f32(input + i))),
+                                   vqmovn_s32(vcvtq_s32_f32(vld1q_f32(input + i + 4))));
+    vst1_s8(output + i, vqmovn_s16(words));
+  }
+#endif
+  for (; i < count; i++) {
+    float value = input[i];
+    output[i] = value <= -128.0f ? -128 : value >= 127.0f ? 127 : static_cast<int8_t>(value);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void Convert::floatToSInt16(const float * input, int16_t * output, int count) {
+  int i = 0;
+#if defined(CONVERT_SSE)
+  const __m128d scale = _mm_set1_pd(SCALE_16);
+  const __m128d low = _mm_set1_pd(-32768.0);
+  const __m128d high = _mm_set1_pd(32767.0);
+  for (; i + 8 <= count; i += 8) {
+    __m128i words[4];
+    for (int j = 0; j < 4; j++) {
+      __m128d x = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + i + 2 * j))));
+      words[j] = _mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(_mm_mul_pd(x, scale), low), high));
+    }
+    __m128i a = _mm_unpacklo_epi64(words[0], words[1]);
+    __m128i b = _mm_unpacklo_epi64(words[2], words[3]);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i), _mm_packs_epi32(a, b));
+  }
+#elif defined(CONVERT_NEON)
+  for (; i + 8 <= count; i += 8) {
+    int32x4_t a = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(input + i), SCALE_16));
+    int32x4_t b = vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(input + i + 4), SCALE_16));
+    vst1q_s16(output + i, vcombine_s16(vqmovn_s32(a), vqmovn_s32(b)));
+  }
+#endif
+  for (; i < count; i++) {
+    double value = input[i] * static_cast<double>(SCALE_16);
+    output[i] = value <= -32768.0 ? -32768 : value >= 32767.0 ? 32767 : static_cast<int16_t>(value);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void Convert::floatToUInt16(const float * input, uint16_t * output, int count) {
+  int i = 0;
+#if defined(CONVERT_SSE)
+  const __m128d one = _mm_set1_pd(1.0);
+  const __m128d scale = _mm_set1_pd(SCALE_16);
+  const __m128d low = _mm_set1_pd(0.0);
+  const __m128d high = _mm_set1_pd(65535.0);
+  const __m128i middle = _mm_set1_epi32(32768);
+  for (; i + 8 <= count; i += 8) {
+    __m128i words[4];
+    for (int j = 0; j < 4; j++) {
+      __m128d x = _mm_cvtps_pd(_mm_castsi128_ps(_mm_loadl_epi64(reinterpret_cast<const __m128i *>(input + i + 2 * j))));
+      words[j] = _mm_cvttpd_epi32(_mm_min_pd(_mm_max_pd(_mm_mul_pd(_mm_add_pd(x, one), scale), low), high));
+    }
+    // SSE2 packs signed, so pack around 32768 and flip the top bit back
+    __m128i a = _mm_sub_epi32(_mm_unpacklo_epi64(words[0], words[1]), middle);
+    __m128i b = _mm_sub_epi32(_mm_unpacklo_epi64(words[2], words[3]), middle);
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + i),
+                     _mm_xor_si128(_mm_packs_epi32(a, b), _mm_set1_epi16(static_cast<int16_t>(0x8000))));
+  }
+#elif defined(CONVERT_NEON)
+  for (; i + 8 <= count; i += 8) {
+    float32x4_t one = vdupq_n_f32(1.0f);
+    int32x4_t a = vcvtq_s32_f32(vmulq_n_f32(vaddq_f32(vld1q_f32(input + i), one), SCALE_16));
+    int32x4_t b = vcvtq_s32_f32(vmulq_n_f32(vaddq_f32(vld1q_f32(input + i + 4), one), SCALE_16));
+    vst1q_u16(output + i, vcombine_u16(vqmovun_s32(a), vqmovun_s32(b)));
+  }
+#endif
+  for (; i < count; i++) {
+    double value = (input[i] + 1.0) * SCALE_16;
+    output[i] = value <= 0.0 ? 0 : value >= 65535.0 ? 65535 : static_cast<uint16_t>(value);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void Convert::sInt16ToFloat(const int16_t * input, float * output, int count) {
+  const float scale = 1.0 / 32767.0;
+  int i = 0;
+#if defined(CONVERT_SSE)
+  const __m128 scales = _mm_set1_ps(scale);
+  for (; i + 8 <= count; i += 8) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + i));
+    __m128i low = _mm_srai_epi32(_mm_unpacklo_epi16(x, x), 16);
+    __m128i high = _mm_srai_epi32(_mm_unpackhi_epi16(x, x), 16);
+    _mm_storeu_ps(output + i, _mm_mul_ps(_mm_cvtepi32_ps(low), scales));
+    _mm_storeu_ps(output + i + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scales));
+  }
+#elif defined(CONVERT_NEON)
+  for (; i + 8 <= count; i += 8) {
+    int16x8_t x = vld1q_s16(input + i);
+    vst1q_f32(output + i, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(x))), scale));
+    vst1q_f32(output + i + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(x))), scale));
+  }
+#endif
+  for (; i < count; i++) output[i] = input[i] * scale;
+}
+
+/* ---------------------------------------------------------------------- */
+void Convert::littleEndian16(const uint8_t * input, int16_t * output, int count) {
+#ifdef LE_MACHINE
+  memcpy(output, input, count * sizeof(int16_t));
+#else
+  for (int i = 0; i < count; i++) {
+    output[i] = static_cast<int16_t>(input[2 * i] | (input[2 * i + 1] << 8));
+  }
+#endif
+}
@@ -0,0 +1,36 @@
+#ifndef CONVERT_H_
+#define CONVERT_H_
+/*
+ *      Convert.h - block sample format conversions for the convert_x_y
+ *                  commands: vector widening or 256 entry tables for
+ *                  bytes to float, vector packs that saturate for float
+ *                  to integer, and 16 bit byte order handled a block at
+ *                  a time
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdint.h>
+/* ---------------------------------------------------------------------- */
+namespace Convert {
+// (byte - 128) / 128
+void uByteToFloat(const uint8_t * input, float * output, int count);
+// byte / 128
+void byteToFloat(const int8_t * input, float * output, int count);
+// byte - 128, as a signed byte
+void uByteToByte(const uint8_t * input, int8_t * output, int count);
+// truncated toward 0 and held to -128 to 127
+void floatToByte(const float * input, int8_t * output, int count);
+// input * 32767, truncated toward 0 and held to -32768 to 32767
+void floatToSInt16(const float * input, int16_t * output, int count);
+// (input + 1) * 32767, truncated and held to 0 to 65535
+void floatToUInt16(const float * input, uint16_t * output, int count);
+// input / 32767
+void sInt16ToFloat(const int16_t * input, float * output, int count);
+// little endian 16 bit samples to the host's order
+void littleEndian16(const uint8_t * input, int16_t * output, int count);
+}  // namespace Convert
+#endif  // CONVERT_H_
@@ -0,0 +1,223 @@
+/*
+ *      DCBlock.cc - DC blocker and I/Q imbalance corrector
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  The DC estimate is a one-pole low pass of the signal, but it is stepped
+ *  once a segment, from the segment's vector sum, and subtracted as a
+ *  straight line between those points.  For time constants of thousands of
+ *  samples this is the same high pass as stepping it every sample, without
+ *  a recursion the length of the stream that no vector unit can run.
+ *
+ *  The imbalance correction keeps I and makes Q uncorrelated with it and of
+ *  the same power: with P_I, P_Q and C the averages of I*I, Q*Q and I*Q,
+ *
+ *    Q' = g * (Q - C / P_I * I),  g = sqrt(P_I / (P_Q - C * C / P_I))
+ *
+ *  Those statistics come from blocks after the DC is removed, and are
+ *  averaged over a long time constant, as the imbalance of a tuner drifts
+ *  only slowly.
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define DCBLOCK_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define DCBLOCK_NEON
+#endif
+#include "DCBlock.h"
+#include "Stream.h"
+/* ---------------------------------------------------------------------- */
+namespace {
+
+// sums of the samples at even and odd positions, count even
+void sumEvenOdd(const float * samples, int count, float & even, float & odd) {
+  int i = 0;
+  even = 0.0;
+  odd = 0.0;
+#if defined(DCBLOCK_SSE)
+  __m128 sums = _mm_setzero_ps();
+  for (; i + 4 <= count; i += 4) sums = _mm_add_ps(sums, _mm_loadu_ps(samples + i));
+  float lanes[4];
+  _mm_storeu_ps(lanes, sums);
+  even = lanes[0] + lanes[2];
+  odd = lanes[1] + lanes[3];
+#elif defined(DCBLOCK_NEON)
+  float32x4_t sums = vdupq_n_f32(0.0f);
+  for (; i + 4 <= count; i += 4) sums = vaddq_f32(sums, vld1q_f32(samples + i));
+  float32x2_t pairs = vadd_f32(vget_low_f32(sums), vget_high_f32(sums));
+  even = vget_lane_f32(pairs, 0);
+  odd = vget_lane_f32(pairs, 1);
+#endif
+  for (; i < count; i += 2) {
+    even += samples[i];
+    odd += samples[i + 1];
+  }
+}
+
+}  // namespace
+
+/* ---------------------------------------------------------------------- */
+DCBlock::DCBlock(bool complex, double timeConstant, double imbalanceTimeConstant) {
+  this->complex = complex;
+  channels = complex ? 2 : 1;
+  alpha = timeConstant > 0.0 ? exp(-SEGMENT / timeConstant) : 0.0;
+  imbalanceAlpha = complex && imbalanceTimeConstant > 0.0 ? exp(-BLOCK_SAMPLES / imbalanceTimeConstant) : 0.0;
+  started = false;
+  dc[0] = dc[1] = 0.0;
+  powerI = powerQ = cross = 0.0;
+  crossWeight = 0.0;
+  quadratureWeight = 1.0;
+  buffer = reinterpret_cast<float *>(malloc(BLOCK_SAMPLES * channels * sizeof(float)));
+  fprintf(stderr, "DC block time constant %g samples", timeConstant);
+  if (imbalanceAlpha > 0.0) fprintf(stderr, ", I/Q imbalance time constant %g", imbalanceTimeConstant);
+  fprintf(stderr, "\n");
+}
+
+/* ---------------------------------------------------------------------- */
+//  count samples, or pairs, in place: each segment moves the estimate and
+//  the line subtracted runs from the old estimate to the new one
+void DCBlock::removeDC(float * samples, int count) {
+  const int width = SEGMENT * channels;
+  for (int done = 0; done < count * channels; done += width) {
+    int size = count * channels - done < width ? count * channels - done : width;
+    float * segment = samples + done;
+    float sums[2];
+    if (complex) {
+      sumEvenOdd(segment, size, sums[0], sums[1]);
+    } else if (size % 2) {
+      sumEvenOdd(segment, size - 1, sums[0], sums[1]);
+      sums[0] += sums[1] + segment[size - 1];
+    } else {
+      sumEvenOdd(segment, size, sums[0], sums[1]);
+      sums[0] += sums[1];
+    }
+    int points = size / channels;
+    float start[2];
+    float step[2];
+    for (int channel = 0; channel < channels; channel++) {
+      float mean = sums[channel] / points;
+      start[channel] = started ? dc[channel] : mean;
+      dc[channel] = started ? mean + alpha * (dc[channel] - mean) : mean;
+      step[channel] = (dc[channel] - start[channel]) / points;
+    }
+    started = true;
+    if (complex) {
+      for (int i = 0; i < points; i++) {
+        segment[2 * i] -= start[0] + step[0] * (i + 1);
+        segment[2 * i + 1] -= start[1] + step[1] * (i + 1);
+      }
+    } else {
+      for (int i = 0; i < points; i++) segment[i] -= start[0] + step[0] * (i + 1);
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void DCBlock::measureImbalance(const float * pairs, int count) {
+  float sumI = 0.0;
+  float sumQ = 0.0;
+  float sumCross = 0.0;
+  int i = 0;
+#if defined(DCBLOCK_SSE)
+  __m128 squares = _mm_setzero_ps();
+  __m128 products = _mm_setzero_ps();
+  for (; i + 2 <= count; i += 2) {
+    __m128 x = _mm_loadu_ps(pairs + 2 * i);
+    squares = _mm_add_ps(squares, _mm_mul_ps(x, x));
+    products = _mm_add_ps(products, _mm_mul_ps(x, _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1))));
+  }
+  float lanes[4];
+  _mm_storeu_ps(lanes, squares);
+  sumI = lanes[0] + lanes[2];
+  sumQ = lanes[1] + lanes[3];
+  _mm_storeu_ps(lanes, products);
+  sumCross = lanes[0] + lanes[2];
+#elif defined(DCBLOCK_NEON)
+  float32x4_t squares = vdupq_n_f32(0.0f);
+  float32x4_t products = vdupq_n_f32(0.0f);
+  for (; i + 2 <= count; i += 2) {
+    float32x4_t x = vld1q_f32(pairs + 2 * i);
+    squares = vmlaq_f32(squares, x, x);
+    products = vmlaq_f32(products, x, vrev64q_f32(x));
+  }
+  float32x2_t squareSums = vadd_f32(vget_low_f32(squares), vget_high_f32(squares));
+  sumI = vget_lane_f32(squareSums, 0);
+  sumQ = vget_lane_f32(squareSums, 1);
+  sumCross = vget_lane_f32(vadd_f32(vget_low_f32(products), vget_high_f32(products)), 0);
+#endif
+  for (; i < count; i++) {
+    sumI += pairs[2 * i] * pairs[2 * i];
+    sumQ += pairs[2 * i + 1] * pairs[2 * i + 1];
+    sumCross += pairs[2 * i] * pairs[2 * i + 1];
+  }
+  double weight = powerI > 0.0 ? 1.0 - imbalanceAlpha : 1.0;
+  powerI += weight * (sumI / count - powerI);
+  powerQ += weight * (sumQ / count - powerQ);
+  cross += weight * (sumCross / count - cross);
+  if (powerI <= 0.0) return;
+  double uncorrelated = powerQ - cross * cross / powerI;
+  if (uncorrelated <= 0.0) return;
+  double g = sqrt(powerI / uncorrelated);
+  crossWeight = -g * cross / powerI;
+  quadratureWeight = g;
+}
+
+/* ---------------------------------------------------------------------- */
+void DCBlock::correctImbalance(float * pairs, int count) {
+  int i = 0;
+#if defined(DCBLOCK_SSE)
+  // (I, Q) * (1, qw) + (Q, I) * (0, cw)
+  const __m128 direct = _mm_setr_ps(1.0f, quadratureWeight, 1.0f, quadratureWeight);
+  const __m128 swapped = _mm_setr_ps(0.0f, crossWeight, 0.0f, crossWeight);
+  for (; i + 2 <= count; i += 2) {
+    __m128 x = _mm_loadu_ps(pairs + 2 * i);
+    __m128 y = _mm_add_ps(_mm_mul_ps(x, direct), _mm_mul_ps(_mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1)), swapped));
+    _mm_storeu_ps(pairs + 2 * i, y);
+  }
+#elif defined(DCBLOCK_NEON)
+  const float directWeights[4] = { 1.0f, quadratureWeight, 1.0f, quadratureWeight };
+  const float swappedWeights[4] = { 0.0f, crossWeight, 0.0f, crossWeight };
+  const float32x4_t direct = vld1q_f32(directWeights);
+  const float32x4_t swapped = vld1q_f32(swappedWeights);
+  for (; i + 2 <= count; i += 2) {
+    float32x4_t x = vld1q_f32(pairs + 2 * i);
+    vst1q_f32(pairs + 2 * i, vmlaq_f32(vmulq_f32(x, direct), vrev64q_f32(x), swapped));
+  }
+#endif
+  for (; i < count; i++) {
+    pairs[2 * i + 1] = crossWeight * pairs[2 * i] + quadratureWeight * pairs[2 * i + 1];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void DCBlock::filterSignal(void) {
+  const char * name = complex ? "dc_block_cc" : "dc_block_ff";
+  for (;;) {
+    int count = Stream::input()->read(buffer, channels * sizeof(float), BLOCK_SAMPLES);
+    removeDC(buffer, count);
+    if (imbalanceAlpha > 0.0 && count > 0) {
+      // the statistics are always of the uncorrected signal, so the
+      // weights do not chase their own correction
+      measureImbalance(buffer, count);
+      correctImbalance(buffer, count);
+    }
+    Stream::output()->write(buffer, channels * sizeof(float), count);
+    if (count < BLOCK_SAMPLES) {
+      fprintf(stderr, "Short data stream, %s\n", name);
+      Stream::output()->close();
+      break;
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+DCBlock::~DCBlock(void) {
+  free(buffer);
+}
@@ -0,0 +1,51 @@
+#ifndef DCBLOCK_H_
+#define DCBLOCK_H_
+/*
+ *      DCBlock.h - DC blocker for real and I/Q streams.  A one-pole
+ *                  estimate of the DC, per channel, is subtracted from the
+ *                  signal; for I/Q the gain and phase imbalance between
+ *                  the channels can also be estimated, slowly, and
+ *                  corrected, so an RTL dongle's DC spike and its image
+ *                  are gone before decimation.
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+class DCBlock {
+ private:
+  static const int BLOCK_SAMPLES = 1 << 13;      // samples, or I/Q pairs, read at a time
+  static const int SEGMENT = 32;                 // samples, or pairs, between points of the DC estimate
+
+  bool complex;            // interleaved I/Q, else real
+  int channels;
+  float alpha;             // weight of the old DC estimate, per segment
+  bool started;            // the estimates have their first measurement
+  float dc[2];             // DC estimates, I and Q or the real channel
+  float imbalanceAlpha;    // weight of the old imbalance statistics, per block, 0 for no correction
+  double powerI;           // averaged statistics of the DC free I/Q
+  double powerQ;
+  double cross;
+  float crossWeight;       // corrected Q is crossWeight * I + quadratureWeight * Q
+  float quadratureWeight;
+  float * buffer;
+
+  void removeDC(float * samples, int count);
+  void measureImbalance(const float * pairs, int count);
+  void correctImbalance(float * pairs, int count);
+
+ public:
+  static constexpr double DEFAULT_TIME_CONSTANT = 16384.0;
+  static constexpr double DEFAULT_IMBALANCE_TIME_CONSTANT = 1048576.0;
+
+  // time constants in samples (or I/Q pairs) of the DC estimate and of the
+  // I/Q imbalance statistics, 0 for no imbalance correction
+  DCBlock(bool complex, double timeConstant, double imbalanceTimeConstant);
+
+  void filterSignal(void);
+
+  ~DCBlock(void);
+};
+#endif  // DCBLOCK_H_
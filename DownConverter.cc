@@ -0,0 +1,121 @@
+/*
+ *      DownConverter.cc - digital down converter
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  Shifting x[p] down by w and filtering with h, with the filter taking
+ *  taps samples from p = mD - (taps - 1) for output m, gives
+ *
+ *    y[m] = sum over j of h[j] x[p] e^(-jwp)
+ *         = e^(-jwmD) sum over j of h[j] e^(jw(taps - 1 - j)) x[p]
+ *
+ *  so the same outputs come from filtering the unshifted samples with
+ *  complex coefficients and mixing only the outputs kept, one in
+ *  decimation.  That costs twice the multiplies of the real filter, so it
+ *  is used when those cost less than mixing every sample; otherwise the
+ *  block is mixed first, while it is still in cache, and filtered with
+ *  the real, folded, coefficients.
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "DownConverter.h"
+#include "FIRKernels.h"
+#include "NCO.h"
+#include "Stream.h"
+/* ---------------------------------------------------------------------- */
+DownConverter::DownConverter(double shift, float cutoff, int taps, int decimation) {
+  this->taps = taps;
+  this->decimation = decimation;
+  if (taps < 1 || taps % 2 == 0 || decimation < 1) {
+    fprintf(stderr, "There must be an odd number of coefficients and a decimation of at least 1\n");
+    exit(-1);
+  }
+  outputs = BLOCK_PAIRS / decimation;
+  if (outputs < 1) outputs = 1;
+  blockPairs = outputs * decimation;
+  for (int i = 0; i < 256; i++) lookup[i] = (i - 128) / 128.0;
+
+  // the windowed sinc of FIRFilter, normalized to a gain of 1
+  float design[taps];
+  int midPoint = taps / 2;
+  const float K = 2.0 * M_PI * cutoff;
+  const float K2 = 2.0 * M_PI / (taps - 1.0);
+  design[midPoint] = 1.0;
+  for (int i = 1; i <= midPoint; i++) {
+    float x = K * i;
+    design[midPoint + i] = design[midPoint - i] = sin(x) / x * (0.54 - 0.46 * cos(K2 * (midPoint - i)));
+  }
+  float sum = 0.0;
+  for (int i = 0; i < taps; i++) sum += design[i];
+  for (int i = 0; i < taps; i++) design[i] = design[i] / sum;
+
+  mixOutputs = 2.0 * taps / decimation < MIX_COST;
+  if (mixOutputs) {
+    float real[taps];
+    float imaginary[taps];
+    for (int j = 0; j < taps; j++) {
+      double angle = 2.0 * M_PI * fmod(shift * (taps - 1 - j), 1.0);
+      real[j] = design[j] * cos(angle);
+      imaginary[j] = design[j] * sin(angle);
+    }
+    realPart = FIRKernels::interleave(real, taps);
+    imaginaryPart = FIRKernels::interleave(imaginary, taps);
+    oscillator = new NCO(shift * decimation);
+  } else {
+    realPart = FIRKernels::interleave(design, taps);
+    imaginaryPart = 0;
+    oscillator = new NCO(shift);
+  }
+  inputBuffer = reinterpret_cast<unsigned char *>(malloc(blockPairs * 2));
+  history = reinterpret_cast<float *>(calloc((taps - 1 + blockPairs) * 2, sizeof(float)));  // silence before the stream
+  realSums = reinterpret_cast<float *>(malloc(outputs * 2 * sizeof(float)));
+  imaginarySums = reinterpret_cast<float *>(malloc(outputs * 2 * sizeof(float)));
+  outputBuffer = reinterpret_cast<float *>(malloc(outputs * 2 * sizeof(float)));
+  fprintf(stderr, "down converter: shift %f, %d taps, decimation %d, mixing %s, %s kernels\n", shift, taps, decimation,
+          mixOutputs ? "outputs" : "inputs", FIRKernels::implementation());
+}
+
+/* ---------------------------------------------------------------------- */
+void DownConverter::filterSignal(void) {
+  const int historyFloats = (taps - 1) * 2;
+  float * block = history + historyFloats;
+  for (;;) {
+    if (Stream::input()->read(inputBuffer, sizeof(char), blockPairs * 2) != (size_t) blockPairs * 2) {
+      fprintf(stderr, "Short data stream, ddc_uByte_cc\n");
+      Stream::output()->close();
+      break;
+    }
+    for (int i = 0; i < blockPairs * 2; i++) block[i] = lookup[inputBuffer[i]];
+    if (mixOutputs) {
+      FIRKernels::decimateInterleaved(realPart, taps, history, decimation, realSums, outputs);
+      FIRKernels::decimateInterleaved(imaginaryPart, taps, history, decimation, imaginarySums, outputs);
+      for (int m = 0; m < outputs; m++) {
+        outputBuffer[2 * m] = realSums[2 * m] - imaginarySums[2 * m + 1];
+        outputBuffer[2 * m + 1] = realSums[2 * m + 1] + imaginarySums[2 * m];
+      }
+      oscillator->shift(outputBuffer, outputBuffer, outputs);
+    } else {
+      oscillator->shift(block, block, blockPairs);
+      FIRKernels::decimateSymmetricInterleaved(realPart, taps, history, decimation, outputBuffer, outputs);
+    }
+    Stream::output()->write(outputBuffer, sizeof(float), outputs * 2);
+    memmove(history, history + blockPairs * 2, historyFloats * sizeof(float));
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+DownConverter::~DownConverter(void) {
+  delete oscillator;
+  free(realPart);
+  if (imaginaryPart) free(imaginaryPart);
+  free(inputBuffer);
+  free(history);
+  free(realSums);
+  free(imaginarySums);
+  free(outputBuffer);
+}
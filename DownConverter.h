@@ -0,0 +1,48 @@
+#ifndef DOWNCONVERTER_H_
+#define DOWNCONVERTER_H_
+/*
+ *      DownConverter.h - digital down converter: raw RTL bytes in, shifted
+ *                        in frequency, low pass filtered and decimated I/Q
+ *                        floats out, in one pass over each block - the
+ *                        work of convert_uByte_f | shift_frequency_cc |
+ *                        decimate_cc without the pipes between them
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+class NCO;
+/* ---------------------------------------------------------------------- */
+class DownConverter {
+ private:
+  static const int BLOCK_PAIRS = 1 << 14;        // input samples per block, rounded to a whole output
+  static constexpr double MIX_COST = 8.0;        // operations to mix a sample, against a multiply accumulate
+
+  int taps;
+  int decimation;
+  int outputs;             // outputs per block
+  int blockPairs;
+  bool mixOutputs;         // mix after filtering, else before
+  float lookup[256];       // byte to float
+  float * realPart;        // coefficients, duplicated for I/Q
+  float * imaginaryPart;   // the shifted filter's, when mixing outputs
+  unsigned char * inputBuffer;
+  float * history;         // taps - 1 pairs of history, then the block
+  float * realSums;        // the block filtered by each part
+  float * imaginarySums;
+  float * outputBuffer;
+  NCO * oscillator;
+
+ public:
+  // shift in cycles per sample as for shift_frequency_cc, the filter as
+  // decimate_cc designs it: cutoff relative to the input rate, taps (odd)
+  // Hamming windowed coefficients
+  DownConverter(double shift, float cutoff, int taps, int decimation);
+
+  void filterSignal(void);
+
+  ~DownConverter(void);
+};
+#endif  // DOWNCONVERTER_H_
@@ -8,6 +8,7 @@
 
 /* ---------------------------------------------------------------------- */
 #include "DsppFFT.h"
+#include "Stream.h"
 /* ---------------------------------------------------------------------- */
 DsppFFT::DsppFFT(int size){
   numberOfSamples = size;
@@ -23,7 +24,7 @@ int DsppFFT::processSampleSet() {
   float * floatPtr;
   double * doublePtr;
   for (;;) {
-    count = fread(rawSignal, sizeof(float), numberOfSamples*2, stdin);
+    count = Stream::input()->read(rawSignal, sizeof(float), numberOfSamples*2);
     if (count == numberOfSamples*2) {
       floatPtr = rawSignal;
       doublePtr = (double *) signal;
@@ -42,7 +43,7 @@ int DsppFFT::processSampleSet() {
       fprintf(stderr, "short pipe, fft_cc\n");
       break;
     }
-    fwrite(rawSignalInFreqDomain, sizeof(float), numberOfSamples*2, stdout);
+    Stream::output()->write(rawSignalInFreqDomain, sizeof(float), numberOfSamples*2);
   }
   return 1; // pipe terminated - typically ok
 }
@@ -14,8 +14,12 @@
 #include <stdlib.h>
 #include <unistd.h>
 #include <string.h>
+#include <time.h>
 
 #include "FIRFilter.h"
+#include "FIRKernels.h"
+#include "OverlapSave.h"
+#include "Stream.h"
 
 /* ---------------------------------------------------------------------- */
 FIRFilter::FIRFilter(float cutoffFrequency, int M, int decimation, int N, WindowType windowType) {
@@ -95,6 +99,7 @@ FIRFilter::FIRFilter(float cutoffFrequency, int M, int decimation, int N, Window
   for (int i = 0; i < 2 * M; i++) {
     signalBuffer[i] = 0.0;
   }
+  checkSymmetry();
   fprintf(stderr, "FIR filter initialized\n");
 
   for (int i = 0; i < M; i++) {
@@ -181,6 +186,7 @@ FIRFilter::FIRFilter(float cutoffFrequency, int M, int decimation, int N, Window
   for (int i = 0; i < M; i++) {
     signalBuffer[i] = 0.0;
   }
+  checkSymmetry();
   fprintf(stderr, "FIR filter initialized\n");
 
   for (int i = 0; i < M; i++) {
@@ -215,6 +221,7 @@ FIRFilter::FIRFilter(int decimation) {  // Average real filter decimation
   for (int i = 0; i < M; i++) {
     signalBuffer[i] = 0.0;
   }
+  checkSymmetry();
   fprintf(stderr, "FIR filter initialized\n");
 
   for (int i = 0; i < M; i++) {
@@ -268,6 +275,7 @@ FIRFilter::FIRFilter(const char * filePath, int M, int N, WindowType windowType)
   for (int i = 0; i < 2 * M; i++) {
     signalBuffer[i] = 0.0;
   }
+  checkSymmetry();
   fprintf(stderr, "FIR filter initialized\n");
 
   for (int i = 0; i < M; i++) {
@@ -321,6 +329,7 @@ FIRFilter::FIRFilter(const char * filePath, int M, int N, WindowType windowType,
   for (int i = 0; i < M; i++) {
     signalBuffer[i] = 0.0;
   }
+  checkSymmetry();
   fprintf(stderr, "FIR filter initialized\n");
 
   for (int i = 0; i < M; i++) {
@@ -330,130 +339,163 @@ FIRFilter::FIRFilter(const char * filePath, int M, int N, WindowType windowType,
 };
 
 int FIRFilter::readSignalPipe() {
-  int count = fread(inputBuffer, sizeof(char), INPUT_BUFFER_SIZE, stdin);
+  int count = Stream::input()->read(inputBuffer, sizeof(char), INPUT_BUFFER_SIZE);
   return count;
 }
 
 int FIRFilter::writeSignalPipe() {
-  int count = fwrite(outputBuffer, sizeof(char), OUTPUT_BUFFER_SIZE, stdout);
+  int count = Stream::output()->write(outputBuffer, sizeof(char), OUTPUT_BUFFER_SIZE);
   return count;
 }
 
-void FIRFilter::filterSignal(){
+//
+// Linear phase filters - all of the windowed designs and most coefficient
+// files - have mirror image coefficients, which lets the kernels add the
+// two samples sharing a coefficient before multiplying.  Anything else
+// uses the general kernels.
+//
+void FIRFilter::checkSymmetry() {
+  symmetric = FIRKernels::symmetric(coefficients, M);
+  fprintf(stderr, symmetric ? "coefficients are symmetric\n" : "coefficients are not symmetric, using the general kernel\n");
+}
 
-  float * I;
-  float * Q;
-  float * coefficientPtr;
-  float * output;
-  float sumI;
-  float sumQ;
+//
+// The input is read straight into a long buffer behind the history the
+// filter needs from the previous block.  Only when the buffer is used up is
+// the history moved back to its start, rather than after every block.
+//
+float * FIRFilter::allocateHistory(int historyFloats, int blockFloats, int & capacity) {
+  int blocks = HISTORY_FLOATS / blockFloats;
+  if (blocks < 1) blocks = 1;
+  capacity = historyFloats + blocks * blockFloats;
+  return (float *) calloc(capacity, sizeof(float));  // the first history is silence
+}
+
+//
+// One block of N outputs from the samples starting with the history -
+// pairs holds the coefficients duplicated for I/Q when the signal is
+// complex, and fast is the overlap-save filter when one is used.
+//
+void FIRFilter::convolve(const float * samples, const float * pairs, OverlapSave * fast) {
+  if (fast) {
+    fast->filter(samples, outputBuffer);
+  } else if (pairs) {
+    if (symmetric) {
+      FIRKernels::decimateSymmetricInterleaved(pairs, M, samples, decimation, outputBuffer, N);
+    } else {
+      FIRKernels::decimateInterleaved(pairs, M, samples, decimation, outputBuffer, N);
+    }
+  } else {
+    if (symmetric) {
+      FIRKernels::decimateSymmetric(coefficients, M, samples, decimation, outputBuffer, N);
+    } else {
+      FIRKernels::decimate(coefficients, M, samples, decimation, outputBuffer, N);
+    }
+  }
+}
+
+//
+// The direct kernels cost M multiplies per output, overlap-save about the
+// same per input sample whatever M is, so long filters - unless they are
+// heavily decimated - are cheaper through the FFT.  DSPP_FIR_FFT_TAPS sets
+// the number of coefficients from which the FFT is used (0 for never).
+// Otherwise filters of FFT_MINIMUM_TAPS or more time a few blocks of
+// silence both ways and keep the faster.
+//
+OverlapSave * FIRFilter::chooseConvolution(const float * samples, const float * pairs) {
+  const char * setting = getenv("DSPP_FIR_FFT_TAPS");
+  if (setting) {
+    int threshold = atoi(setting);
+    if (threshold <= 0 || M < threshold) return 0;
+    return new OverlapSave(coefficients, M, N * decimation, decimation, pairs != 0);
+  }
+  if (M < FFT_MINIMUM_TAPS) return 0;
+  OverlapSave * fast = new OverlapSave(coefficients, M, N * decimation, decimation, pairs != 0);
+  double elapsed[2];
+  for (int method = 0; method < 2; method++) {
+    OverlapSave * trial = method ? fast : 0;
+    convolve(samples, pairs, trial);  // the first block warms the caches
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (int block = 0; block < TIMED_BLOCKS; block++) convolve(samples, pairs, trial);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    elapsed[method] = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) * 1e-9;
+  }
+  fprintf(stderr, "%d coefficients: direct %.1f us, overlap-save %.1f us per block, using %s\n", M,
+          elapsed[0] * 1e6 / TIMED_BLOCKS, elapsed[1] * 1e6 / TIMED_BLOCKS,
+          elapsed[1] < elapsed[0] ? "overlap-save" : "direct");
+  if (elapsed[1] < elapsed[0]) return fast;
+  delete fast;
+  return 0;
+}
+
+void FIRFilter::filterSignal(){
 
   //
-  // Filter with this current buffer of input
+  // Each output is the dot product of the coefficients with M complex
+  // samples, computed with vector multiply accumulates over the interleaved
+  // I/Q samples using coefficients duplicated for each pair.  Only the
+  // outputs that are kept are computed.
   //
 
   if (real) {
     fprintf(stderr, "Object is initialized for real filter processing.\n");
     exit(-1);
   }
+  const int historyFloats = (M - 1) * 2;
+  const int blockFloats = INPUT_BUFFER_SIZE / sizeof(float);
+  int capacity;
+  float * history = allocateHistory(historyFloats, blockFloats, capacity);
+  float * pairs = FIRKernels::interleave(coefficients, M);
+  OverlapSave * fast = chooseConvolution(history, pairs);
+  int write = historyFloats;
   for (;;) {
-    if (readSignalPipe() != INPUT_BUFFER_SIZE) {
-      fprintf(stderr, "Short read....\n");
-      exit(-1);
+    if (write + blockFloats > capacity) {
+      memmove(history, history + write - historyFloats, historyFloats * sizeof(float));
+      write = historyFloats;
     }
-    //fprintf(stderr, "last old I is pointing at: %p, value is: %f, last old Q is pointing at: %p, value is: %f\n", inputBuffer-2, *(inputBuffer-2), inputBuffer-1, *(inputBuffer-1));
-    //fprintf(stderr, "first new I is pointing at: %p, value is: %f, first new Q is pointing at: %p, value is: %f\n", inputBuffer, *(inputBuffer), inputBuffer+1, *(inputBuffer+1));
-
-    I = signalBuffer;
-                                                  // set I to the first input
-                                                  // that will be processed by
-                                                  // coefficient[0]
-    Q = I + 1;
-    output = outputBuffer;
-    coefficientPtr = coefficients;
-    //for (int i = 0; i < N + extra - 1; i++) {
-    for (int i = 0; i < N; i++) {
-      //fprintf(stderr, "doing sample %d of %d, output pointer is at: %p\n", i, N + extra, output);
-      //fprintf(stderr, "I is pointing at: %p, value is: %f, Q is pointing at: %p, value is: %f\n", I, *I, Q, *Q);
-      sumI = 0.0;
-      sumQ = 0.0;
-      coefficientPtr = coefficients;
-      for (int j = 0; j < M; j++) {
-        //fprintf(stderr, "j is: %d, I is pointing at: %p, value is: %f, Q is pointing at: %p, value is: %f\n", j, I, *I, Q, *Q);
-        sumI += *coefficientPtr * *I;
-        sumQ += *coefficientPtr * *Q;
-        coefficientPtr++;
-        I += 2;
-        Q += 2;
-      }
-      I += (decimation - M) * 2;
-      Q = I + 1;
-      *output++ = sumI;
-      *output++ = sumQ;
+    if (Stream::input()->read(history + write, sizeof(char), INPUT_BUFFER_SIZE) != (size_t) INPUT_BUFFER_SIZE) {
+      fprintf(stderr, "Short read....\n");
+      Stream::output()->close();
+      break;
     }
-
-    //
-    // Copy the end of the buffer that will be used in the filtering
-    // of the next buffer that arrives
-    //
+    convolve(history + write - historyFloats, pairs, fast);
     writeSignalPipe();
-    memcpy(signalBuffer, inputToDelay, (M-1) * 8);
-    // after copy, the end of the copied data should match up with the beginning of the input buffer, so
-    // look at it after the read
-    //fprintf(stderr, "filtered a buffer\n");
+    write += blockFloats;
   }
+  if (fast) delete fast;
+  free(pairs);
+  free(history);
 };
 
 void FIRFilter::filterReal(){
 
-  float * I;
-  float * coefficientPtr;
-  float * output;
-  float sumI;
-
-  //
-  // Filter with this current buffer of input
-  //
-
   if (!real) {
     fprintf(stderr, "Object is not initialized for real filter processing.\n");
     exit(-1);
   }
+  const int historyFloats = M - 1;
+  const int blockFloats = INPUT_BUFFER_SIZE / sizeof(float);
+  int capacity;
+  float * history = allocateHistory(historyFloats, blockFloats, capacity);
+  OverlapSave * fast = chooseConvolution(history, 0);
+  int write = historyFloats;
   for (;;) {
-    if (readSignalPipe() != INPUT_BUFFER_SIZE) {
-      fprintf(stderr, "Short read....\n");
-      exit(-1);
+    if (write + blockFloats > capacity) {
+      memmove(history, history + write - historyFloats, historyFloats * sizeof(float));
+      write = historyFloats;
     }
-    I = signalBuffer;
-                                                  // set I to the first input
-                                                  // that will be processed by
-                                                  // coefficient[0]
-    output = outputBuffer;
-    coefficientPtr = coefficients;
-    for (int i = 0; i < N; i++) {
-      //fprintf(stderr, "doing sample %d of %d, output pointer is at: %p\n", i, N + extra, output);
-      sumI = 0.0;
-      coefficientPtr = coefficients;
-      for (int j = 0; j < M; j++) {
-        //fprintf(stderr, "j is: %d, I is pointing at: %p, value is: %f\n", j, I, *I);
-        sumI += *coefficientPtr * *I;
-        coefficientPtr++;
-        I += 1;
-      }
-      I += (decimation - M);
-      *output++ = sumI;
+    if (Stream::input()->read(history + write, sizeof(char), INPUT_BUFFER_SIZE) != (size_t) INPUT_BUFFER_SIZE) {
+      fprintf(stderr, "Short read....\n");
+      Stream::output()->close();
+      break;
     }
-
-    //
-    // Copy the end of the buffer that will be used in the filtering
-    // of the next buffer that arrives
-    //
+    convolve(history + write - historyFloats, 0, fast);
     writeSignalPipe();
-    memcpy(signalBuffer, inputToDelay, (M-1) * 4);
-    // after copy, the end of the copied data should match up with the beginning of the input buffer, so
-    // look at it after the read
-    //fprintf(stderr, "filtered a buffer\n");
+    write += blockFloats;
   }
+  if (fast) delete fast;
+  free(history);
 };
 
 void FIRFilter::filterRealWindow(){
@@ -475,7 +517,8 @@ void FIRFilter::filterRealWindow(){
     // read one block of data that will be averaged and sent out as one output
     if (readSignalPipe() != INPUT_BUFFER_SIZE) {
       fprintf(stderr, "Short read....\n");
-      exit(-1);
+      Stream::output()->close();
+      return;
     }
     I = signalBuffer;
     output = outputBuffer;
@@ -513,7 +556,8 @@ void FIRFilter::maxRealWindow(){
     // read one block of data that will be averaged and sent out as one output
     if (readSignalPipe() != INPUT_BUFFER_SIZE) {
       fprintf(stderr, "Short read MAX\n");
-      exit(-1);
+      Stream::output()->close();
+      return;
     }
     I = signalBuffer;
     output = outputBuffer;
@@ -531,7 +575,7 @@ void FIRFilter::maxRealWindow(){
 
 FIRFilter::~FIRFilter(void) {
   free(coefficients);
-  free(inputBuffer);
+  free(signalBuffer);
   free(outputBuffer);
 };
 
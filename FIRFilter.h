@@ -8,6 +8,9 @@
 
 /* ---------------------------------------------------------------------- */
 
+/* ---------------------------------------------------------------------- */
+class OverlapSave;
+
 /* ---------------------------------------------------------------------- */
 class FIRFilter {
 
@@ -31,9 +34,18 @@ class FIRFilter {
   float * outputBuffer;   // filtered I/Q values
   float * inputToDelay;   // input to copy to delayed area
   bool real;              // real processing only
+  bool symmetric;         // coefficients mirror about the midpoint
   
+  static const int HISTORY_FLOATS = 1 << 16;  // input buffered before history is moved back
+  static const int FFT_MINIMUM_TAPS = 64;      // shorter filters always use the direct kernels
+  static const int TIMED_BLOCKS = 4;           // blocks timed each way when choosing
+
   int readSignalPipe();
   int writeSignalPipe();
+  float * allocateHistory(int historyFloats, int blockFloats, int & capacity);
+  void checkSymmetry();
+  void convolve(const float * samples, const float * pairs, OverlapSave * fast);
+  OverlapSave * chooseConvolution(const float * samples, const float * pairs);
   public:
 
   enum WindowType {HAMMING, BLACKMAN, CUSTOM};
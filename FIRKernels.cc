@@ -0,0 +1,611 @@
+/*
+ *      FIRKernels.cc - vectorized multiply accumulate kernels for the FIR
+ *                      filters
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  Each implementation keeps its partial sums in vector lanes and adds the
+ *  lanes at the end.  Lanes are added so that even lanes only meet even
+ *  lanes and odd only odd, which is what lets the interleaved versions keep
+ *  I and Q apart.  DSPP_FIR_KERNEL=scalar (or sse, avx, neon) overrides the
+ *  choice, for comparing them.
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FIR_X86
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FIR_NEON
+#endif
+#include "FIRKernels.h"
+/* ---------------------------------------------------------------------- */
+namespace {
+
+struct Implementation {
+  const char * name;
+  float (*dot)(const float * coefficients, const float * samples, int count);
+  void (*dotInterleaved)(const float * coefficients, const float * samples, int count, float & even, float & odd);
+  // zero where folding does not pay: with fused multiply adds the add
+  // and reversal cost as much as the multiplies they save
+  float (*dotSymmetric)(const float * coefficients, const float * samples, int taps);
+  void (*dotSymmetricInterleaved)(const float * coefficients, const float * samples, int taps, float & even,
+                                  float & odd);
+  void (*halfBand)(const float * coefficients, int count, const float * even, const float * odd, int width,
+                   float * output, int outputs);
+  void (*split)(const float * samples, int width, int pairs, float * even, float * odd);
+};
+
+/* ---------------------------------------------------------------------- */
+float dotScalar(const float * coefficients, const float * samples, int count) {
+  float sum = 0.0;
+  for (int j = 0; j < count; j++) sum += coefficients[j] * samples[j];
+  return sum;
+}
+
+void dotInterleavedScalar(const float * coefficients, const float * samples, int count, float & even, float & odd) {
+  float sumEven = 0.0;
+  float sumOdd = 0.0;
+  for (int j = 0; j < count; j += 2) {
+    sumEven += coefficients[j] * samples[j];
+    sumOdd += coefficients[j + 1] * samples[j + 1];
+  }
+  even = sumEven;
+  odd = sumOdd;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Folded kernels finish the pairs of samples the vector loop left and add
+//  the middle tap of an odd length filter.
+float foldedTail(const float * coefficients, const float * samples, int taps, int j, float sum) {
+  int half = taps / 2;
+  for (; j < half; j++) sum += coefficients[j] * (samples[j] + samples[taps - 1 - j]);
+  if (taps & 1) sum += coefficients[half] * samples[half];
+  return sum;
+}
+
+void foldedTailInterleaved(const float * coefficients, const float * samples, int taps, int j, float & even,
+                           float & odd) {
+  int half = taps / 2;
+  float sumEven = even;  // even and odd may be in the output, which could alias the samples
+  float sumOdd = odd;
+  for (; j < half; j++) {
+    int mirror = 2 * (taps - 1 - j);
+    sumEven += coefficients[2 * j] * (samples[2 * j] + samples[mirror]);
+    sumOdd += coefficients[2 * j + 1] * (samples[2 * j + 1] + samples[mirror + 1]);
+  }
+  if (taps & 1) {
+    sumEven += coefficients[2 * half] * samples[2 * half];
+    sumOdd += coefficients[2 * half + 1] * samples[2 * half + 1];
+  }
+  even = sumEven;
+  odd = sumOdd;
+}
+
+float dotSymmetricScalar(const float * coefficients, const float * samples, int taps) {
+  return foldedTail(coefficients, samples, taps, 0, 0.0);
+}
+
+void dotSymmetricInterleavedScalar(const float * coefficients, const float * samples, int taps, float & even,
+                                   float & odd) {
+  even = odd = 0.0;
+  foldedTailInterleaved(coefficients, samples, taps, 0, even, odd);
+}
+
+/* ---------------------------------------------------------------------- */
+//  The half-band kernels work across outputs rather than along the filter:
+//  a vector of consecutive outputs (floats, so I and Q alike) takes one
+//  coefficient at a time, times the near and far samples sharing it.  These
+//  finish whatever outputs the vector loop left.
+void halfBandTail(const float * coefficients, int count, const float * even, const float * odd, int width,
+                  float * output, int p, int floats) {
+  int last = width * (2 * count - 1);
+  const float * center = odd + width * (count - 1);
+  for (; p < floats; p++) {
+    float sum = 0.5 * center[p];
+    for (int i = 0; i < count; i++) sum += coefficients[i] * (even[p + width * i] + even[p + last - width * i]);
+    output[p] = sum;
+  }
+}
+
+void splitTail(const float * samples, int width, int n, int pairs, float * even, float * odd) {
+  for (; n < pairs; n++) {
+    for (int w = 0; w < width; w++) {
+      even[width * n + w] = samples[2 * width * n + w];
+      odd[width * n + w] = samples[2 * width * n + width + w];
+    }
+  }
+}
+
+void halfBandScalar(const float * coefficients, int count, const float * even, const float * odd, int width,
+                    float * output, int outputs) {
+  halfBandTail(coefficients, count, even, odd, width, output, 0, outputs * width);
+}
+
+void splitScalar(const float * samples, int width, int pairs, float * even, float * odd) {
+  splitTail(samples, width, 0, pairs, even, odd);
+}
+
+#if defined(FIR_X86) && defined(__SSE__)
+/* ---------------------------------------------------------------------- */
+//  [a0, a1, a2, a3] -> a0 + a2 in lane 0 and a1 + a3 in lane 1
+inline __m128 foldPairs(__m128 sum) {
+  return _mm_add_ps(sum, _mm_movehl_ps(sum, sum));
+}
+
+float dotSSE(const float * coefficients, const float * samples, int count) {
+  __m128 sum0 = _mm_setzero_ps();
+  __m128 sum1 = _mm_setzero_ps();
+  int j = 0;
+  for (; j + 8 <= count; j += 8) {
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(coefficients + j), _mm_loadu_ps(samples + j)));
+    sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(coefficients + j + 4), _mm_loadu_ps(samples + j + 4)));
+  }
+  for (; j + 4 <= count; j += 4) {
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(coefficients + j), _mm_loadu_ps(samples + j)));
+  }
+  __m128 pairs = foldPairs(_mm_add_ps(sum0, sum1));
+  float sum = _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+  for (; j < count; j++) sum += coefficients[j] * samples[j];
+  return sum;
+}
+
+void dotInterleavedSSE(const float * coefficients, const float * samples, int count, float & even, float & odd) {
+  __m128 sum0 = _mm_setzero_ps();
+  __m128 sum1 = _mm_setzero_ps();
+  int j = 0;
+  for (; j + 8 <= count; j += 8) {
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(coefficients + j), _mm_loadu_ps(samples + j)));
+    sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(coefficients + j + 4), _mm_loadu_ps(samples + j + 4)));
+  }
+  for (; j + 4 <= count; j += 4) {
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(coefficients + j), _mm_loadu_ps(samples + j)));
+  }
+  __m128 pairs = foldPairs(_mm_add_ps(sum0, sum1));
+  float sumEven = _mm_cvtss_f32(pairs);
+  float sumOdd = _mm_cvtss_f32(_mm_shuffle_ps(pairs, pairs, 1));
+  for (; j < count; j += 2) {
+    sumEven += coefficients[j] * samples[j];
+    sumOdd += coefficients[j + 1] * samples[j + 1];
+  }
+  even = sumEven;
+  odd = sumOdd;
+}
+
+/* ---------------------------------------------------------------------- */
+//  In the folded kernels the samples from the far end of the filter are
+//  loaded in the same order as the near ones and then reversed - by
+//  sample, or for interleaved data by I/Q pair.
+float dotSymmetricSSE(const float * coefficients, const float * samples, int taps) {
+  __m128 sum0 = _mm_setzero_ps();
+  __m128 sum1 = _mm_setzero_ps();
+  int half = taps / 2;
+  int j = 0;
+  for (; j + 8 <= half; j += 8) {
+    __m128 far0 = _mm_loadu_ps(samples + taps - j - 4);
+    __m128 far1 = _mm_loadu_ps(samples + taps - j - 8);
+    far0 = _mm_add_ps(_mm_loadu_ps(samples + j), _mm_shuffle_ps(far0, far0, _MM_SHUFFLE(0, 1, 2, 3)));
+    far1 = _mm_add_ps(_mm_loadu_ps(samples + j + 4), _mm_shuffle_ps(far1, far1, _MM_SHUFFLE(0, 1, 2, 3)));
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(coefficients + j), far0));
+    sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(coefficients + j + 4), far1));
+  }
+  if (j + 4 <= half) {
+    __m128 far = _mm_loadu_ps(samples + taps - j - 4);
+    far = _mm_add_ps(_mm_loadu_ps(samples + j), _mm_shuffle_ps(far, far, _MM_SHUFFLE(0, 1, 2, 3)));
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(coefficients + j), far));
+    j += 4;
+  }
+  __m128 pairs = foldPairs(_mm_add_ps(sum0, sum1));
+  return foldedTail(coefficients, samples, taps, j, _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1))));
+}
+
+void dotSymmetricInterleavedSSE(const float * coefficients, const float * samples, int taps, float & even,
+                                float & odd) {
+  __m128 sum0 = _mm_setzero_ps();
+  __m128 sum1 = _mm_setzero_ps();
+  int half = taps / 2;
+  int j = 0;
+  for (; j + 4 <= half; j += 4) {
+    __m128 far0 = _mm_loadu_ps(samples + 2 * (taps - j - 2));
+    __m128 far1 = _mm_loadu_ps(samples + 2 * (taps - j - 4));
+    far0 = _mm_add_ps(_mm_loadu_ps(samples + 2 * j), _mm_shuffle_ps(far0, far0, _MM_SHUFFLE(1, 0, 3, 2)));
+    far1 = _mm_add_ps(_mm_loadu_ps(samples + 2 * j + 4), _mm_shuffle_ps(far1, far1, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(coefficients + 2 * j), far0));
+    sum1 = _mm_add_ps(sum1, _mm_mul_ps(_mm_loadu_ps(coefficients + 2 * j + 4), far1));
+  }
+  if (j + 2 <= half) {
+    __m128 far = _mm_loadu_ps(samples + 2 * (taps - j - 2));
+    far = _mm_add_ps(_mm_loadu_ps(samples + 2 * j), _mm_shuffle_ps(far, far, _MM_SHUFFLE(1, 0, 3, 2)));
+    sum0 = _mm_add_ps(sum0, _mm_mul_ps(_mm_loadu_ps(coefficients + 2 * j), far));
+    j += 2;
+  }
+  __m128 pairs = foldPairs(_mm_add_ps(sum0, sum1));
+  even = _mm_cvtss_f32(pairs);
+  odd = _mm_cvtss_f32(_mm_shuffle_ps(pairs, pairs, 1));
+  foldedTailInterleaved(coefficients, samples, taps, j, even, odd);
+}
+
+/* ---------------------------------------------------------------------- */
+void halfBandSSE(const float * coefficients, int count, const float * even, const float * odd, int width,
+                 float * output, int outputs) {
+  int floats = outputs * width;
+  int last = width * (2 * count - 1);
+  const float * center = odd + width * (count - 1);
+  const __m128 half = _mm_set1_ps(0.5);
+  int p = 0;
+  for (; p + 8 <= floats; p += 8) {
+    __m128 sum0 = _mm_mul_ps(half, _mm_loadu_ps(center + p));
+    __m128 sum1 = _mm_mul_ps(half, _mm_loadu_ps(center + p + 4));
+    const float * near = even + p;
+    const float * far = even + p + last;
+    for (int i = 0; i < count; i++) {
+      __m128 coefficient = _mm_set1_ps(coefficients[i]);
+      sum0 = _mm_add_ps(sum0, _mm_mul_ps(coefficient, _mm_add_ps(_mm_loadu_ps(near), _mm_loadu_ps(far))));
+      sum1 = _mm_add_ps(sum1, _mm_mul_ps(coefficient, _mm_add_ps(_mm_loadu_ps(near + 4), _mm_loadu_ps(far + 4))));
+      near += width;
+      far -= width;
+    }
+    _mm_storeu_ps(output + p, sum0);
+    _mm_storeu_ps(output + p + 4, sum1);
+  }
+  halfBandTail(coefficients, count, even, odd, width, output, p, floats);
+}
+
+void splitSSE(const float * samples, int width, int pairs, float * even, float * odd) {
+  int n = 0;
+  if (width == 1) {
+    for (; n + 4 <= pairs; n += 4) {
+      __m128 a = _mm_loadu_ps(samples + 2 * n);
+      __m128 b = _mm_loadu_ps(samples + 2 * n + 4);
+      _mm_storeu_ps(even + n, _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0)));
+      _mm_storeu_ps(odd + n, _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1)));
+    }
+  } else {
+    for (; n + 2 <= pairs; n += 2) {
+      __m128 a = _mm_loadu_ps(samples + 4 * n);
+      __m128 b = _mm_loadu_ps(samples + 4 * n + 4);
+      _mm_storeu_ps(even + 2 * n, _mm_movelh_ps(a, b));
+      _mm_storeu_ps(odd + 2 * n, _mm_movehl_ps(b, a));
+    }
+  }
+  splitTail(samples, width, n, pairs, even, odd);
+}
+
+/* ---------------------------------------------------------------------- */
+//  Compiled for AVX and FMA whatever the build flags, and only called when
+//  the processor has them.
+__attribute__((target("avx,fma"))) inline __m128 foldHalves(__m256 sum) {
+  return _mm_add_ps(_mm256_castps256_ps128(sum), _mm256_extractf128_ps(sum, 1));
+}
+
+__attribute__((target("avx,fma"))) float dotAVX(const float * coefficients, const float * samples, int count) {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  int j = 0;
+  for (; j + 16 <= count; j += 16) {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(coefficients + j), _mm256_loadu_ps(samples + j), sum0);
+    sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(coefficients + j + 8), _mm256_loadu_ps(samples + j + 8), sum1);
+  }
+  for (; j + 8 <= count; j += 8) {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(coefficients + j), _mm256_loadu_ps(samples + j), sum0);
+  }
+  __m128 pairs = foldPairs(foldHalves(_mm256_add_ps(sum0, sum1)));
+  float sum = _mm_cvtss_f32(_mm_add_ss(pairs, _mm_shuffle_ps(pairs, pairs, 1)));
+  for (; j < count; j++) sum += coefficients[j] * samples[j];
+  return sum;
+}
+
+__attribute__((target("avx,fma")))
+void dotInterleavedAVX(const float * coefficients, const float * samples, int count, float & even, float & odd) {
+  __m256 sum0 = _mm256_setzero_ps();
+  __m256 sum1 = _mm256_setzero_ps();
+  int j = 0;
+  for (; j + 16 <= count; j += 16) {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(coefficients + j), _mm256_loadu_ps(samples + j), sum0);
+    sum1 = _mm256_fmadd_ps(_mm256_loadu_ps(coefficients + j + 8), _mm256_loadu_ps(samples + j + 8), sum1);
+  }
+  for (; j + 8 <= count; j += 8) {
+    sum0 = _mm256_fmadd_ps(_mm256_loadu_ps(coefficients + j), _mm256_loadu_ps(samples + j), sum0);
+  }
+  __m128 pairs = foldPairs(foldHalves(_mm256_add_ps(sum0, sum1)));
+  float sumEven = _mm_cvtss_f32(pairs);
+  float sumOdd = _mm_cvtss_f32(_mm_shuffle_ps(pairs, pairs, 1));
+  for (; j < count; j += 2) {
+    sumEven += coefficients[j] * samples[j];
+    sumOdd += coefficients[j + 1] * samples[j + 1];
+  }
+  even = sumEven;
+  odd = sumOdd;
+}
+
+__attribute__((target("avx,fma")))
+void halfBandAVX(const float * coefficients, int count, const float * even, const float * odd, int width,
+                 float * output, int outputs) {
+  int floats = outputs * width;
+  int last = width * (2 * count - 1);
+  const float * center = odd + width * (count - 1);
+  const __m256 half = _mm256_set1_ps(0.5);
+  int p = 0;
+  for (; p + 16 <= floats; p += 16) {
+    __m256 sum0 = _mm256_mul_ps(half, _mm256_loadu_ps(center + p));
+    __m256 sum1 = _mm256_mul_ps(half, _mm256_loadu_ps(center + p + 8));
+    const float * near = even + p;
+    const float * far = even + p + last;
+    for (int i = 0; i < count; i++) {
+      __m256 coefficient = _mm256_set1_ps(coefficients[i]);
+      sum0 = _mm256_fmadd_ps(coefficient, _mm256_add_ps(_mm256_loadu_ps(near), _mm256_loadu_ps(far)), sum0);
+      sum1 = _mm256_fmadd_ps(coefficient, _mm256_add_ps(_mm256_loadu_ps(near + 8), _mm256_loadu_ps(far + 8)), sum1);
+      near += width;
+      far -= width;
+    }
+    _mm256_storeu_ps(output + p, sum0);
+    _mm256_storeu_ps(output + p + 8, sum1);
+  }
+  _mm256_zeroupper();  // the tail is SSE code
+  halfBandTail(coefficients, count, even, odd, width, output, p, floats);
+}
+#endif
+
+#ifdef FIR_NEON
+/* ---------------------------------------------------------------------- */
+float dotNEON(const float * coefficients, const float * samples, int count) {
+  float32x4_t sum0 = vdupq_n_f32(0.0);
+  float32x4_t sum1 = vdupq_n_f32(0.0);
+  int j = 0;
+  for (; j + 8 <= count; j += 8) {
+    sum0 = vmlaq_f32(sum0, vld1q_f32(coefficients + j), vld1q_f32(samples + j));
+    sum1 = vmlaq_f32(sum1, vld1q_f32(coefficients + j + 4), vld1q_f32(samples + j + 4));
+  }
+  for (; j + 4 <= count; j += 4) {
+    sum0 = vmlaq_f32(sum0, vld1q_f32(coefficients + j), vld1q_f32(samples + j));
+  }
+  sum0 = vaddq_f32(sum0, sum1);
+  float32x2_t pairs = vadd_f32(vget_low_f32(sum0), vget_high_f32(sum0));
+  float sum = vget_lane_f32(vpadd_f32(pairs, pairs), 0);
+  for (; j < count; j++) sum += coefficients[j] * samples[j];
+  return sum;
+}
+
+void dotInterleavedNEON(const float * coefficients, const float * samples, int count, float & even, float & odd) {
+  float32x4_t sum0 = vdupq_n_f32(0.0);
+  float32x4_t sum1 = vdupq_n_f32(0.0);
+  int j = 0;
+  for (; j + 8 <= count; j += 8) {
+    sum0 = vmlaq_f32(sum0, vld1q_f32(coefficients + j), vld1q_f32(samples + j));
+    sum1 = vmlaq_f32(sum1, vld1q_f32(coefficients + j + 4), vld1q_f32(samples + j + 4));
+  }
+  for (; j + 4 <= count; j += 4) {
+    sum0 = vmlaq_f32(sum0, vld1q_f32(coefficients + j), vld1q_f32(samples + j));
+  }
+  sum0 = vaddq_f32(sum0, sum1);
+  float32x2_t pairs = vadd_f32(vget_low_f32(sum0), vget_high_f32(sum0));
+  float sumEven = vget_lane_f32(pairs, 0);
+  float sumOdd = vget_lane_f32(pairs, 1);
+  for (; j < count; j += 2) {
+    sumEven += coefficients[j] * samples[j];
+    sumOdd += coefficients[j + 1] * samples[j + 1];
+  }
+  even = sumEven;
+  odd = sumOdd;
+}
+
+float dotSymmetricNEON(const float * coefficients, const float * samples, int taps) {
+  float32x4_t sum0 = vdupq_n_f32(0.0);
+  float32x4_t sum1 = vdupq_n_f32(0.0);
+  int half = taps / 2;
+  int j = 0;
+  for (; j + 8 <= half; j += 8) {
+    float32x4_t far0 = vrev64q_f32(vld1q_f32(samples + taps - j - 4));
+    float32x4_t far1 = vrev64q_f32(vld1q_f32(samples + taps - j - 8));
+    far0 = vcombine_f32(vget_high_f32(far0), vget_low_f32(far0));
+    far1 = vcombine_f32(vget_high_f32(far1), vget_low_f32(far1));
+    sum0 = vmlaq_f32(sum0, vld1q_f32(coefficients + j), vaddq_f32(vld1q_f32(samples + j), far0));
+    sum1 = vmlaq_f32(sum1, vld1q_f32(coefficients + j + 4), vaddq_f32(vld1q_f32(samples + j + 4), far1));
+  }
+  if (j + 4 <= half) {
+    float32x4_t far = vrev64q_f32(vld1q_f32(samples + taps - j - 4));
+    far = vcombine_f32(vget_high_f32(far), vget_low_f32(far));
+    sum0 = vmlaq_f32(sum0, vld1q_f32(coefficients + j), vaddq_f32(vld1q_f32(samples + j), far));
+    j += 4;
+  }
+  sum0 = vaddq_f32(sum0, sum1);
+  float32x2_t pairs = vadd_f32(vget_low_f32(sum0), vget_high_f32(sum0));
+  return foldedTail(coefficients, samples, taps, j, vget_lane_f32(vpadd_f32(pairs, pairs), 0));
+}
+
+void dotSymmetricInterleavedNEON(const float * coefficients, const float * samples, int taps, float & even,
+                                 float & odd) {
+  float32x4_t sum0 = vdupq_n_f32(0.0);
+  float32x4_t sum1 = vdupq_n_f32(0.0);
+  int half = taps / 2;
+  int j = 0;
+  for (; j + 4 <= half; j += 4) {
+    float32x4_t far0 = vld1q_f32(samples + 2 * (taps - j - 2));
+    float32x4_t far1 = vld1q_f32(samples + 2 * (taps - j - 4));
+    far0 = vcombine_f32(vget_high_f32(far0), vget_low_f32(far0));
+    far1 = vcombine_f32(vget_high_f32(far1), vget_low_f32(far1));
+    sum0 = vmlaq_f32(sum0, vld1q_f32(coefficients + 2 * j), vaddq_f32(vld1q_f32(samples + 2 * j), far0));
+    sum1 = vmlaq_f32(sum1, vld1q_f32(coefficients + 2 * j + 4), vaddq_f32(vld1q_f32(samples + 2 * j + 4), far1));
+  }
+  if (j + 2 <= half) {
+    float32x4_t far = vld1q_f32(samples + 2 * (taps - j - 2));
+    far = vcombine_f32(vget_high_f32(far), vget_low_f32(far));
+    sum0 = vmlaq_f32(sum0, vld1q_f32(coefficients + 2 * j), vaddq_f32(vld1q_f32(samples + 2 * j), far));
+    j += 2;
+  }
+  sum0 = vaddq_f32(sum0, sum1);
+  float32x2_t pairs = vadd_f32(vget_low_f32(sum0), vget_high_f32(sum0));
+  even = vget_lane_f32(pairs, 0);
+  odd = vget_lane_f32(pairs, 1);
+  foldedTailInterleaved(coefficients, samples, taps, j, even, odd);
+}
+
+void halfBandNEON(const float * coefficients, int count, const float * even, const float * odd, int width,
+                  float * output, int outputs) {
+  int floats = outputs * width;
+  int last = width * (2 * count - 1);
+  const float * center = odd + width * (count - 1);
+  int p = 0;
+  for (; p + 8 <= floats; p += 8) {
+    float32x4_t sum0 = vmulq_n_f32(vld1q_f32(center + p), 0.5);
+    float32x4_t sum1 = vmulq_n_f32(vld1q_f32(center + p + 4), 0.5);
+    const float * near = even + p;
+    const float * far = even + p + last;
+    for (int i = 0; i < count; i++) {
+      sum0 = vmlaq_n_f32(sum0, vaddq_f32(vld1q_f32(near), vld1q_f32(far)), coefficients[i]);
+      sum1 = vmlaq_n_f32(sum1, vaddq_f32(vld1q_f32(near + 4), vld1q_f32(far + 4)), coefficients[i]);
+      near += width;
+      far -= width;
+    }
+    vst1q_f32(output + p, sum0);
+    vst1q_f32(output + p + 4, sum1);
+  }
+  halfBandTail(coefficients, count, even, odd, width, output, p, floats);
+}
+
+void splitNEON(const float * samples, int width, int pairs, float * even, float * odd) {
+  int n = 0;
+  if (width == 1) {
+    for (; n + 4 <= pairs; n += 4) {
+      float32x4x2_t both = vld2q_f32(samples + 2 * n);
+      vst1q_f32(even + n, both.val[0]);
+      vst1q_f32(odd + n, both.val[1]);
+    }
+  } else {
+    for (; n + 4 <= pairs; n += 4) {
+      float32x4x4_t all = vld4q_f32(samples + 4 * n);  // even I, even Q, odd I, odd Q
+      float32x4x2_t evenPairs = { { all.val[0], all.val[1] } };
+      float32x4x2_t oddPairs = { { all.val[2], all.val[3] } };
+      vst2q_f32(even + 2 * n, evenPairs);
+      vst2q_f32(odd + 2 * n, oddPairs);
+    }
+  }
+  splitTail(samples, width, n, pairs, even, odd);
+}
+#endif
+
+/* ---------------------------------------------------------------------- */
+Implementation choose(void) {
+  const Implementation scalar = { "scalar", dotScalar, dotInterleavedScalar, dotSymmetricScalar,
+                                  dotSymmetricInterleavedScalar, halfBandScalar, splitScalar };
+  const char * forced = getenv("DSPP_FIR_KERNEL");
+  if (forced && strcmp(forced, "scalar") == 0) return scalar;
+#if defined(FIR_X86) && defined(__SSE__)
+  const Implementation sse = { "sse", dotSSE, dotInterleavedSSE, dotSymmetricSSE, dotSymmetricInterleavedSSE,
+                               halfBandSSE, splitSSE };
+  if (forced && strcmp(forced, "sse") == 0) return sse;
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx") && __builtin_cpu_supports("fma")) {
+    const Implementation avx = { "avx", dotAVX, dotInterleavedAVX, 0, 0, halfBandAVX, splitSSE };
+    return avx;
+  }
+  return sse;
+#endif
+#ifdef FIR_NEON
+  const Implementation neon = { "neon", dotNEON, dotInterleavedNEON, dotSymmetricNEON, dotSymmetricInterleavedNEON,
+                                halfBandNEON, splitNEON };
+  return neon;
+#endif
+  return scalar;
+}
+
+/* ---------------------------------------------------------------------- */
+const Implementation & chosen(void) {
+  static const Implementation implementation = choose();
+  return implementation;
+}
+
+}  // namespace
+
+/* ---------------------------------------------------------------------- */
+float FIRKernels::dot(const float * coefficients, const float * samples, int count) {
+  return chosen().dot(coefficients, samples, count);
+}
+
+/* ---------------------------------------------------------------------- */
+void FIRKernels::dotInterleaved(const float * coefficients, const float * samples, int count, float & even, float & odd) {
+  chosen().dotInterleaved(coefficients, samples, count, even, odd);
+}
+
+/* ---------------------------------------------------------------------- */
+void FIRKernels::decimate(const float * coefficients, int taps, const float * samples, int step, float * output,
+                          int outputs) {
+  float (*dot)(const float *, const float *, int) = chosen().dot;
+  for (int k = 0; k < outputs; k++) {
+    output[k] = dot(coefficients, samples + k * step, taps);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void FIRKernels::decimateInterleaved(const float * coefficients, int taps, const float * samples, int step,
+                                     float * output, int outputs) {
+  void (*dotInterleaved)(const float *, const float *, int, float &, float &) = chosen().dotInterleaved;
+  for (int k = 0; k < outputs; k++) {
+    dotInterleaved(coefficients, samples + 2 * k * step, 2 * taps, output[2 * k], output[2 * k + 1]);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+bool FIRKernels::symmetric(const float * coefficients, int taps) {
+  for (int j = 0; j < taps / 2; j++) {
+    if (coefficients[j] != coefficients[taps - 1 - j]) return false;
+  }
+  return true;
+}
+
+/* ---------------------------------------------------------------------- */
+void FIRKernels::decimateSymmetric(const float * coefficients, int taps, const float * samples, int step,
+                                   float * output, int outputs) {
+  float (*dot)(const float *, const float *, int) = chosen().dotSymmetric;
+  if (!dot) {
+    decimate(coefficients, taps, samples, step, output, outputs);
+    return;
+  }
+  for (int k = 0; k < outputs; k++) {
+    output[k] = dot(coefficients, samples + k * step, taps);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void FIRKernels::decimateSymmetricInterleaved(const float * coefficients, int taps, const float * samples, int step,
+                                              float * output, int outputs) {
+  void (*dot)(const float *, const float *, int, float &, float &) = chosen().dotSymmetricInterleaved;
+  if (!dot) {
+    decimateInterleaved(coefficients, taps, samples, step, output, outputs);
+    return;
+  }
+  for (int k = 0; k < outputs; k++) {
+    dot(coefficients, samples + 2 * k * step, taps, output[2 * k], output[2 * k + 1]);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void FIRKernels::halfBand(const float * coefficients, int count, const float * even, const float * odd, int width,
+                          float * output, int outputs) {
+  chosen().halfBand(coefficients, count, even, odd, width, output, outputs);
+}
+
+/* ---------------------------------------------------------------------- */
+void FIRKernels::split(const float * samples, int width, int pairs, float * even, float * odd) {
+  chosen().split(samples, width, pairs, even, odd);
+}
+
+/* ---------------------------------------------------------------------- */
+float * FIRKernels::interleave(const float * coefficients, int taps) {
+  float * pairs = (float *) malloc(2 * taps * sizeof(float));
+  for (int j = 0; j < taps; j++) {
+    pairs[2 * j] = pairs[2 * j + 1] = coefficients[j];
+  }
+  return pairs;
+}
+
+/* ---------------------------------------------------------------------- */
+const char * FIRKernels::implementation(void) {
+  return chosen().name;
+}
@@ -0,0 +1,50 @@
+#ifndef FIRKERNELS_H_
+#define FIRKERNELS_H_
+/*
+ *      FIRKernels.h - vectorized multiply accumulate kernels for the FIR
+ *                     filters.  The widest implementation the processor
+ *                     supports is chosen when first used: AVX with FMA or
+ *                     SSE on x86, NEON on ARM, plain C otherwise.
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+namespace FIRKernels {
+// sum of coefficients[j] * samples[j] for j < count
+float dot(const float * coefficients, const float * samples, int count);
+// the same over count interleaved floats, summing the even and odd positions
+// separately - with each coefficient duplicated, one pass filters I and Q
+void dotInterleaved(const float * coefficients, const float * samples, int count, float & even, float & odd);
+// outputs decimated outputs of a taps long filter: output[k] is the dot
+// product of the coefficients with the samples starting at k * step
+void decimate(const float * coefficients, int taps, const float * samples, int step, float * output, int outputs);
+// the same for interleaved I/Q, with coefficients duplicated for each pair,
+// taps and step counted in complex samples and I/Q pairs written to output
+void decimateInterleaved(const float * coefficients, int taps, const float * samples, int step, float * output, int outputs);
+// true when coefficient j equals coefficient taps - 1 - j for every j, as
+// for any linear phase filter
+bool symmetric(const float * coefficients, int taps);
+// decimate and decimateInterleaved for symmetric coefficients: the samples
+// that share a coefficient are added first, halving the multiplies, where
+// that is faster than the general kernel
+void decimateSymmetric(const float * coefficients, int taps, const float * samples, int step, float * output,
+                       int outputs);
+void decimateSymmetricInterleaved(const float * coefficients, int taps, const float * samples, int step,
+                                  float * output, int outputs);
+// decimate by 2 with a half-band filter of 4 * count - 1 coefficients:
+// every other one zero and the center one 0.5.  coefficients holds the
+// count nonzero ones from the end in to the center, even and odd the
+// samples (width 1) or I/Q pairs (width 2) split by split, and output[k]
+// is the filter applied from sample 2k, as decimate would compute it
+void halfBand(const float * coefficients, int count, const float * even, const float * odd, int width,
+              float * output, int outputs);
+// the even and odd samples or I/Q pairs of 2 * pairs of them
+void split(const float * samples, int width, int pairs, float * even, float * odd);
+// coefficients duplicated for decimateInterleaved, allocated with malloc
+float * interleave(const float * coefficients, int taps);
+const char * implementation(void);
+}  // namespace FIRKernels
+#endif  // FIRKERNELS_H_
@@ -0,0 +1,251 @@
+/*
+ *      FMDemod.cc - FM demodulation class
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  The phase step between samples x[n - 1] and x[n] is the angle of
+ *  x[n] * conj(x[n - 1]), whose imaginary part is Q[n]I[n-1] - I[n]Q[n-1]
+ *  and real part I[n]I[n-1] + Q[n]Q[n-1].  The polar approximation divides
+ *  the imaginary part by |x[n]|^2, which is sin of the step for a constant
+ *  amplitude; the atan2 variant is exact to 1e-5 radians however large
+ *  the step.  atan2 is used when full deviation steps more than
+ *  POLAR_LIMIT, where sin falls short by 10%, unless DSPP_FM_DISCRIMINATOR
+ *  is polar or atan.  Both are computed a
+ *  vector at a time with selects instead of branches.
+ *
+ *  The discriminator output is then resampled to the audio rate by a
+ *  polyphase filter for the rational factor up / down, and de-emphasized
+ *  with a one pole low pass at the audio rate.
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define FMDEMOD_SSE
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FMDEMOD_NEON
+#endif
+#include "FIRKernels.h"
+#include "FMDemod.h"
+#include "KaiserWindow.h"
+#include "Stream.h"
+/* ---------------------------------------------------------------------- */
+namespace {
+
+const float FLOOR = 1.0f / (128.0f * 128.0f);  // power below which the output is left near 0
+// atan(a) for a in [0, 1]
+const float A1 = 0.99997726f;
+const float A3 = -0.33262347f;
+const float A5 = 0.19354346f;
+const float A7 = -0.11643287f;
+const float A9 = 0.05265332f;
+const float A11 = -0.01172120f;
+
+long gcd(long a, long b) {
+  while (b) {
+    long r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+float polarScalar(float I, float Q, float lastI, float lastQ) {
+  float power = I * I + Q * Q;
+  return (Q * lastI - I * lastQ) / (power > FLOOR ? power : FLOOR);
+}
+
+float atanScalar(float I, float Q, float lastI, float lastQ) {
+  float y = Q * lastI - I * lastQ;
+  float x = I * lastI + Q * lastQ;
+  float ax = fabsf(x);
+  float ay = fabsf(y);
+  float big = ax > ay ? ax : ay;
+  float a = (ax < ay ? ax : ay) / (big > 1e-30f ? big : 1e-30f);
+  float s = a * a;
+  float r = (((((A11 * s + A9) * s + A7) * s + A5) * s + A3) * s + A1) * a;
+  r = ay > ax ? 1.5707963f - r : r;
+  r = x < 0.0f ? 3.1415927f - r : r;
+  return y < 0.0f ? -r : r;
+}
+
+}  // namespace
+
+/* ---------------------------------------------------------------------- */
+FMDemod::FMDemod(double inputRate, double audioRate, double deviation, double passband, double stopband,
+                 double deemphasis) {
+  gain = inputRate / (2.0 * M_PI * deviation);
+  const char * discriminator = getenv("DSPP_FM_DISCRIMINATOR");
+  if (discriminator) {
+    useAtan = strcmp(discriminator, "atan") == 0;
+  } else {
+    useAtan = 1.0 / gain > POLAR_LIMIT;
+  }
+  long in = lround(inputRate);
+  long out = lround(audioRate);
+  long common = gcd(in, out);
+  up = out / common;
+  down = in / common;
+  if (stopband > audioRate / 2.0) stopband = audioRate / 2.0;
+  if (stopband > inputRate / 2.0) stopband = inputRate / 2.0;
+  if (passband > 0.9 * stopband) passband = 0.9 * stopband;
+  double rate = inputRate * up;  // of the filter, between the up and down sampling
+  int taps = KaiserWindow::taps((stopband - passband) / rate, ATTENUATION);
+  phaseTaps = (taps + up - 1) / up;
+  float * design = KaiserWindow::lowPass((passband + stopband) / 2.0 / rate, phaseTaps * up, ATTENUATION);
+  // branch p holds the coefficients p, p + up, ..., newest sample last
+  phases = reinterpret_cast<float *>(malloc(up * phaseTaps * sizeof(float)));
+  for (int p = 0; p < up; p++) {
+    for (int j = 0; j < phaseTaps; j++) {
+      phases[p * phaseTaps + j] = design[p + (phaseTaps - 1 - j) * up] * up;
+    }
+  }
+  free(design);
+  base = phaseTaps - 1;
+  phase = 0;
+  alpha = deemphasis > 0.0 ? 1.0 - exp(-1.0 / (deemphasis * audioRate)) : 0.0;
+  emphasis = 0.0;
+  inputBuffer = reinterpret_cast<float *>(calloc((BLOCK_PAIRS + 1) * 2, sizeof(float)));
+  history = reinterpret_cast<float *>(calloc(phaseTaps - 1 + BLOCK_PAIRS, sizeof(float)));
+  outputBuffer = reinterpret_cast<float *>(malloc((static_cast<long>(BLOCK_PAIRS) * up / down + 2) * sizeof(float)));
+  fprintf(stderr, "FM demodulation: %s discriminator, resampling by %d/%d with %d taps per output, "
+          "de-emphasis %s\n", useAtan ? "atan2" : "polar", up, down, phaseTaps, alpha > 0.0 ? "on" : "off");
+}
+
+/* ---------------------------------------------------------------------- */
+//  count outputs from pairs, whose previous pair is at pairs - 2
+void FMDemod::discriminate(const float * pairs, float * output, int count) {
+  int n = 0;
+#if defined(FMDEMOD_SSE)
+  const __m128 gains = _mm_set1_ps(gain);
+  const __m128 signs = _mm_set1_ps(-0.0f);
+  for (; n + 4 <= count; n += 4) {
+    __m128 a = _mm_loadu_ps(pairs + 2 * n);
+    __m128 b = _mm_loadu_ps(pairs + 2 * n + 4);
+    __m128 c = _mm_loadu_ps(pairs + 2 * n - 2);
+    __m128 d = _mm_loadu_ps(pairs + 2 * n + 2);
+    __m128 I = _mm_shuffle_ps(a, b, _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 Q = _mm_shuffle_ps(a, b, _MM_SHUFFLE(3, 1, 3, 1));
+    __m128 lastI = _mm_shuffle_ps(c, d, _MM_SHUFFLE(2, 0, 2, 0));
+    __m128 lastQ = _mm_shuffle_ps(c, d, _MM_SHUFFLE(3, 1, 3, 1));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(Q, lastI), _mm_mul_ps(I, lastQ));
+    __m128 r;
+    if (useAtan) {
+      __m128 x = _mm_add_ps(_mm_mul_ps(I, lastI), _mm_mul_ps(Q, lastQ));
+      __m128 ax = _mm_andnot_ps(signs, x);
+      __m128 ay = _mm_andnot_ps(signs, y);
+      __m128 a = _mm_div_ps(_mm_min_ps(ax, ay), _mm_max_ps(_mm_max_ps(ax, ay), _mm_set1_ps(1e-30f)));
+      __m128 s = _mm_mul_ps(a, a);
+      r = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(A11), s), _mm_set1_ps(A9));
+      r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(A7));
+      r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(A5));
+      r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(A3));
+      r = _mm_add_ps(_mm_mul_ps(r, s), _mm_set1_ps(A1));
+      r = _mm_mul_ps(r, a);
+      __m128 steep = _mm_cmpgt_ps(ay, ax);
+      r = _mm_or_ps(_mm_and_ps(steep, _mm_sub_ps(_mm_set1_ps(1.5707963f), r)), _mm_andnot_ps(steep, r));
+      __m128 behind = _mm_cmplt_ps(x, _mm_setzero_ps());
+      r = _mm_or_ps(_mm_and_ps(behind, _mm_sub_ps(_mm_set1_ps(3.1415927f), r)), _mm_andnot_ps(behind, r));
+      r = _mm_xor_ps(r, _mm_and_ps(signs, y));
+    } else {
+      __m128 power = _mm_add_ps(_mm_mul_ps(I, I), _mm_mul_ps(Q, Q));
+      r = _mm_div_ps(y, _mm_max_ps(power, _mm_set1_ps(FLOOR)));
+    }
+    _mm_storeu_ps(output + n, _mm_mul_ps(r, gains));
+  }
+#elif defined(FMDEMOD_NEON)
+  for (; n + 4 <= count; n += 4) {
+    float32x4x2_t now = vld2q_f32(pairs + 2 * n);
+    float32x4x2_t last = vld2q_f32(pairs + 2 * n - 2);
+    float32x4_t y = vmlsq_f32(vmulq_f32(now.val[1], last.val[0]), now.val[0], last.val[1]);
+    float32x4_t r;
+    if (useAtan) {
+      float32x4_t x = vmlaq_f32(vmulq_f32(now.val[0], last.val[0]), now.val[1], last.val[1]);
+      float32x4_t ax = vabsq_f32(x);
+      float32x4_t ay = vabsq_f32(y);
+      float32x4_t big = vmaxq_f32(vmaxq_f32(ax, ay), vdupq_n_f32(1e-30f));
+      float32x4_t reciprocal = vrecpeq_f32(big);
+      reciprocal = vmulq_f32(reciprocal, vrecpsq_f32(big, reciprocal));
+      reciprocal = vmulq_f32(reciprocal, vrecpsq_f32(big, reciprocal));
+      float32x4_t a = vmulq_f32(vminq_f32(ax, ay), reciprocal);
+      float32x4_t s = vmulq_f32(a, a);
+      r = vmlaq_f32(vdupq_n_f32(A9), vdupq_n_f32(A11), s);
+      r = vmlaq_f32(vdupq_n_f32(A7), r, s);
+      r = vmlaq_f32(vdupq_n_f32(A5), r, s);
+      r = vmlaq_f32(vdupq_n_f32(A3), r, s);
+      r = vmlaq_f32(vdupq_n_f32(A1), r, s);
+      r = vmulq_f32(r, a);
+      r = vbslq_f32(vcgtq_f32(ay, ax), vsubq_f32(vdupq_n_f32(1.5707963f), r), r);
+      r = vbslq_f32(vcltq_f32(x, vdupq_n_f32(0.0f)), vsubq_f32(vdupq_n_f32(3.1415927f), r), r);
+      r = vbslq_f32(vcltq_f32(y, vdupq_n_f32(0.0f)), vnegq_f32(r), r);
+    } else {
+      float32x4_t power = vmlaq_f32(vmulq_f32(now.val[0], now.val[0]), now.val[1], now.val[1]);
+      float32x4_t denominator = vmaxq_f32(power, vdupq_n_f32(FLOOR));
+      float32x4_t reciprocal = vrecpeq_f32(denominator);
+      reciprocal = vmulq_f32(reciprocal, vrecpsq_f32(denominator, reciprocal));
+      reciprocal = vmulq_f32(reciprocal, vrecpsq_f32(denominator, reciprocal));
+      r = vmulq_f32(y, reciprocal);
+    }
+    vst1q_f32(output + n, vmulq_n_f32(r, gain));
+  }
+#endif
+  for (const float * now = pairs + 2 * n; n < count; n++, now += 2) {
+    output[n] = gain * (useAtan ? atanScalar(now[0], now[1], now[-2], now[-1])
+                                : polarScalar(now[0], now[1], now[-2], now[-1]));
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void FMDemod::demodulate(void) {
+  const int size = BLOCK_PAIRS * 2 * sizeof(float);
+  const int historySamples = phaseTaps - 1;
+  for (;;) {
+    if (Stream::input()->read(inputBuffer + 2, sizeof(char), size) != (size_t) size) {
+      fprintf(stderr, "Short data stream, FM demodulation\n");
+      Stream::output()->close();
+      return;
+    }
+    discriminate(inputBuffer + 2, history + historySamples, BLOCK_PAIRS);
+    inputBuffer[0] = inputBuffer[2 * BLOCK_PAIRS];
+    inputBuffer[1] = inputBuffer[2 * BLOCK_PAIRS + 1];
+    int outputs = 0;
+    if (up == 1) {
+      // a plain decimation, by the symmetric prototype, folded
+      outputs = (historySamples + BLOCK_PAIRS - base + down - 1) / down;
+      FIRKernels::decimateSymmetric(phases, phaseTaps, history + base - historySamples, down, outputBuffer, outputs);
+      base += outputs * down;
+    } else {
+      while (base < historySamples + BLOCK_PAIRS) {
+        outputBuffer[outputs++] = FIRKernels::dot(phases + phase * phaseTaps, history + base - historySamples,
+                                                  phaseTaps);
+        phase += down;
+        base += phase / up;
+        phase %= up;
+      }
+    }
+    if (alpha > 0.0f) {
+      for (int n = 0; n < outputs; n++) {
+        emphasis += alpha * (outputBuffer[n] - emphasis);
+        outputBuffer[n] = emphasis;
+      }
+    }
+    Stream::output()->write(outputBuffer, sizeof(float), outputs);
+    base -= BLOCK_PAIRS;
+    memmove(history, history + BLOCK_PAIRS, historySamples * sizeof(float));
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+FMDemod::~FMDemod(void) {
+  free(phases);
+  free(inputBuffer);
+  free(history);
+  free(outputBuffer);
+}
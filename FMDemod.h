@@ -0,0 +1,46 @@
+#ifndef FMDEMOD_H_
+#define FMDEMOD_H_
+/*
+ *      FMDemod.h - FM demodulation class: discriminator, resampling to the
+ *                  audio rate and de-emphasis in one stage
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <math.h>
+/* ---------------------------------------------------------------------- */
+class FMDemod {
+ private:
+  static const int BLOCK_PAIRS = 8192;           // I/Q pairs read at a time
+  static constexpr double ATTENUATION = 60.0;    // dB, of the resampling filter's stopband
+  static constexpr double POLAR_LIMIT = M_PI / 4.0;  // radians per sample, for the polar discriminator
+
+  bool useAtan;            // atan2 of the phase step, else the polar approximation
+  float gain;              // radians per sample to +/-1.0 at full deviation
+  int up;                  // the audio rate is the input rate * up / down
+  int down;
+  int phaseTaps;           // coefficients of each polyphase branch
+  float * phases;          // up branches of phaseTaps, each reversed
+  int base;                // newest input of the next output, in the history buffer
+  int phase;               // its branch
+  float alpha;             // de-emphasis, 0 for none
+  float emphasis;          // de-emphasis state
+  float * inputBuffer;     // the last pair of the previous block, then the block
+  float * history;         // phaseTaps - 1 discriminator outputs, then the block
+  float * outputBuffer;
+
+  void discriminate(const float * pairs, float * output, int count);
+
+ public:
+  // rates in samples per second, deviation and the audio passband and
+  // stopband in Hz, de-emphasis time constant in seconds (0 for none)
+  FMDemod(double inputRate, double audioRate, double deviation, double passband, double stopband, double deemphasis);
+
+  void demodulate(void);
+
+  ~FMDemod(void);
+};
+#endif  // FMDEMOD_H_
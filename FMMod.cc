@@ -16,30 +16,23 @@
 #include <string.h>
 
 #include "FMMod.h"
+#include "NCO.h"
+#include "Stream.h"
 
 
 /* ---------------------------------------------------------------------- */
-FMMod::FMMod(float sampleRate) {
-  this->sampleRate = sampleRate;
-  this->fd = 5000.0;
-  TWO_PI = 2.0 * M_PI;
-  deltaT = 1.0 / sampleRate;
-  inputBuffer  = (float *) malloc(sizeof(float));
-  outputBuffer = (float *) malloc(sizeof(float)*2);
+FMMod::FMMod(float sampleRate) : FMMod(sampleRate, 5000.0) {
 };
 
-
 /* ---------------------------------------------------------------------- */
-int FMMod::readSignalPipe() {
-  int count = fread(inputBuffer, sizeof(float), 1, stdin);
-  return count;
-}
+FMMod::FMMod(float sampleRate, float deviation) {
+  this->sampleRate = sampleRate;
+  this->fd = deviation;
+  inputBuffer  = (float *) malloc(sizeof(float) * BLOCK_SAMPLES);
+  outputBuffer = (float *) malloc(sizeof(float) * 2 * BLOCK_SAMPLES);
+  fprintf(stderr, "FM modulation: deviation %f Hz at %f samples per second\n", fd, sampleRate);
+};
 
-/* ---------------------------------------------------------------------- */
-int FMMod::writeSignalPipe() {
-  int count = fwrite(outputBuffer, sizeof(float), 2, stdout);
-  return count;
-}
 
 /* ---------------------------------------------------------------------- */
 int FMMod::modulate(){
@@ -58,19 +51,19 @@ int FMMod::modulate(){
  *  Q = Ac*sin(s(t))
  */
 
-  float integralSum = 0.0;
-  float K = 2.0 * M_PI * fd * deltaT;
+  // s(t) is kept by a 0 Hz NCO in cycles, fd / sampleRate of them per unit
+  // of x, so it never loses precision however long it runs
+  NCO integral(0.0);
+  double K = static_cast<double>(fd) / sampleRate;
 
   for (;;) {
-    if (readSignalPipe() != 1) {
+    int count = Stream::input()->read(inputBuffer, sizeof(float), BLOCK_SAMPLES);
+    if (count <= 0) {
+      Stream::output()->close();
       return 0;
     }
-    integralSum += K * *inputBuffer;
-    //while(integralSum > TWO_PI) integralSum -= TWO_PI;
-    //while(integralSum < -TWO_PI) integralSum += TWO_PI;
-    *outputBuffer     = cos(integralSum);
-    *(outputBuffer+1) = sin(integralSum);
-    writeSignalPipe();
+    integral.modulate(inputBuffer, K, outputBuffer, count);
+    Stream::output()->write(outputBuffer, sizeof(float), 2 * count);
   }
 };
 
@@ -12,20 +12,16 @@
 class FMMod {
 
   private:
-  float centerFrequency;  // center frequency
+  static const int BLOCK_SAMPLES = 4096;  // samples modulated per read
   float fd;               // frequency deviation
   float sampleRate;       // samples per second
   float * inputBuffer;    // raw input
   float * outputBuffer;   // output buffer 
-  float deltaT;           // time delta of each sample
-  float TWO_PI;
 
-  int readSignalPipe();
-  int writeSignalPipe();
-  
   public:
 
   FMMod(float sampleRate);
+  FMMod(float sampleRate, float deviation);
 
   int modulate();
 
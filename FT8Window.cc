@@ -23,6 +23,7 @@
 #include "FT8SpotCandidate.h"
 #include "FT8Window.h"
 #include "FT8Utilities.h"
+#include "Stream.h"
 // #define SELFTEST 1
 
 /* ---------------------------------------------------------------------- */
@@ -540,14 +541,14 @@ void FT8Window::doWork() {
         // Before reading another sample set, disard the remaining samples associated with the previous 2 minute block
         fprintf(stderr, "Discarding %d unused samples of last window\n",
                 (PERIOD - PROCESSING_SIZE) * BASE_BAND * 2);
-        fread(remainsOf2Win, sizeof(float), (PERIOD - PROCESSING_SIZE) * BASE_BAND * 2, stdin);
+        Stream::input()->read(remainsOf2Win, sizeof(float), (PERIOD - PROCESSING_SIZE) * BASE_BAND * 2);
       }
       fprintf(stderr, "allocating window IQ memory - %ld bytes\n", static_cast<int>(freq)  * sizeof(float) * 2 *
               PROCESSING_SIZE);
       now = time(0);
       entry = {now, reinterpret_cast<float *> (malloc(static_cast<int>(freq) * sizeof(float) * 2 * PROCESSING_SIZE))};
       fprintf(stderr, "\nCollecting %d samples at %ld - %s", sampleBufferSize, now - baseTime, ctime(&now));
-      if ((count = fread(entry.data, sizeof(float), PROCESSING_SIZE * BASE_BAND * 2, stdin)) == 0) {
+      if ((count = Stream::input()->read(entry.data, sizeof(float), PROCESSING_SIZE * BASE_BAND * 2)) == 0) {
         fprintf(stderr, "Input read was empty, sleeping for a while at %s", ctime(&now));
         sleep(1.0);
         done = true;
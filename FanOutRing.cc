@@ -0,0 +1,230 @@
+/*
+ *      FanOutRing.cc - single producer / multiple consumer byte ring in
+ *                      shared memory
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <new>
+#include "Futex.h"
+#include "FanOutRing.h"
+/* ---------------------------------------------------------------------- */
+//  The ring is mapped shared and anonymous, so it must be made before the
+//  consumer processes are forked.
+FanOutRing::FanOutRing(int numberOfConsumers, Policy policy, size_t capacity) {
+  const size_t PAGE = 4096;
+  this->numberOfConsumers = numberOfConsumers;
+  this->policy = policy;
+  this->capacity = 16 * DROP_UNIT;
+  while (this->capacity < capacity) this->capacity <<= 1;
+  mask = this->capacity - 1;
+  chunk = this->capacity / 4;
+  size_t controlSize = sizeof(Producer) + numberOfConsumers * sizeof(Consumer);
+  size_t dataOffset = (controlSize + PAGE - 1) / PAGE * PAGE;
+  mappedSize = dataOffset + this->capacity;
+  memory = mmap(0, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    perror("could not map split_stream ring");
+    memory = 0;
+    return;
+  }
+  unsigned char * base = reinterpret_cast<unsigned char *>(memory);
+  producer = new (base) Producer();
+  consumers = reinterpret_cast<Consumer *>(base + sizeof(Producer));
+  for (int index = 0; index < numberOfConsumers; index++) {
+    new (&consumers[index]) Consumer();
+    consumers[index].pid = 0;
+  }
+  data = base + dataOffset;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Tail of the consumer furthest behind, or SIZE_MAX when every consumer has
+//  closed.
+size_t FanOutRing::slowestTail(size_t head) {
+  size_t slowest = SIZE_MAX;
+  size_t mostBehind = 0;
+  for (int index = 0; index < numberOfConsumers; index++) {
+    if (consumers[index].closed.load()) continue;
+    size_t tail = consumers[index].tail.load();
+    if (slowest == SIZE_MAX || head - tail > mostBehind) {
+      slowest = tail;
+      mostBehind = head - tail;
+    }
+  }
+  return slowest;
+}
+
+/* ---------------------------------------------------------------------- */
+//  A consumer process that died without closing its cursor would hold the
+//  producer back forever, so one that has exited is closed for it.
+void FanOutRing::reapConsumers(void) {
+  for (int index = 0; index < numberOfConsumers; index++) {
+    Consumer * consumer = &consumers[index];
+    int status;
+    if (consumer->pid > 0 && !consumer->closed.load() && waitpid(consumer->pid, &status, WNOHANG) == consumer->pid) {
+      fprintf(stderr, "split_stream consumer %d exited without closing\n", index + 1);
+      consumer->closed.store(1);
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+//  Return where the next bytes of the stream go, with bytes reduced to how
+//  much may be written there.  Zero means every consumer has closed.
+unsigned char * FanOutRing::claim(size_t & bytes) {
+  size_t head = producer->head.load(std::memory_order_relaxed);
+  size_t wanted = (bytes < chunk) ? bytes : chunk;
+  if (policy == BLOCK) {
+    for (;;) {
+      size_t tail = slowestTail(head);
+      if (tail == SIZE_MAX) return 0;
+      size_t space = capacity - (head - tail);
+      if (space >= wanted || space >= chunk / 4) {
+        if (wanted > space) wanted = space;
+        break;
+      }
+      producer->waiting.store(1);
+      uint32_t signal = producer->spaceSignal.load();
+      if (slowestTail(head) == tail) {
+        Futex::wait(producer->spaceSignal, signal, true, 100);
+        reapConsumers();
+      }
+      producer->waiting.store(0);
+    }
+  } else if (slowestTail(head) == SIZE_MAX) {
+    return 0;
+  }
+  size_t offset = head & mask;
+  if (wanted > capacity - offset) wanted = capacity - offset;
+  // consumers check this after copying, so it must be visible before any
+  // byte of the region changes
+  producer->reserved.store(head + wanted);
+  std::atomic_thread_fence(std::memory_order_release);
+  bytes = wanted;
+  return data + offset;
+}
+
+/* ---------------------------------------------------------------------- */
+void FanOutRing::publish(size_t bytes) {
+  size_t head = producer->head.load(std::memory_order_relaxed) + bytes;
+  producer->head.store(head);
+  bool waiting = false;
+  for (int index = 0; index < numberOfConsumers; index++) {
+    Consumer * consumer = &consumers[index];
+    if (consumer->closed.load(std::memory_order_relaxed)) continue;
+    size_t lag = head - consumer->tail.load(std::memory_order_relaxed);
+    if (lag > consumer->maxLag.load(std::memory_order_relaxed)) {
+      consumer->maxLag.store(lag, std::memory_order_relaxed);
+    }
+    waiting |= consumer->waiting.load();
+  }
+  if (waiting) Futex::wake(producer->dataSignal, true, true);
+}
+
+/* ---------------------------------------------------------------------- */
+void FanOutRing::close(void) {
+  producer->closed.store(1);
+  Futex::wake(producer->dataSignal, true, true);
+}
+
+/* ---------------------------------------------------------------------- */
+//  Move a lapped consumer to about half a ring behind the producer.  Its
+//  tail is on a drop unit boundary of the stream (see peek) and it resumes
+//  on the next one, counted from the start of the stream, so the units it
+//  passes on are whole - the samples that follow are still aligned and a
+//  framed stream still starts each frame on a boundary.
+void FanOutRing::skipAhead(Consumer * consumer) {
+  size_t tail = consumer->tail.load(std::memory_order_relaxed);
+  size_t head = producer->head.load();
+  size_t target = (head - capacity / 2 + DROP_UNIT - 1) / DROP_UNIT * DROP_UNIT;
+  if (target <= tail) return;
+  consumer->dropped.fetch_add(target - tail, std::memory_order_relaxed);
+  consumer->gaps.fetch_add(1, std::memory_order_relaxed);
+  consumer->tail.store(target);
+}
+
+/* ---------------------------------------------------------------------- */
+//  Return the next unread bytes for consumer index, in place, waiting until
+//  there are some.  bytes is reduced to the contiguous amount available.
+//  Zero means the producer has closed and this consumer has read everything.
+//  When dropping, only whole drop units are returned until the producer
+//  closes, so a consumer never passes on part of a unit it may then have
+//  to skip the rest of.
+const unsigned char * FanOutRing::peek(int index, size_t & bytes) {
+  Consumer * consumer = &consumers[index];
+  for (;;) {
+    size_t tail = consumer->tail.load(std::memory_order_relaxed);
+    size_t wanted = (policy == DROP) ? (tail / DROP_UNIT + 1) * DROP_UNIT : tail + 1;
+    // closed is read before head, so the producer's last block is seen
+    bool closed = producer->closed.load();
+    size_t head = producer->head.load(std::memory_order_acquire);
+    if (head >= wanted || (closed && head != tail)) {
+      if (policy == DROP && producer->reserved.load() - tail > capacity) {
+        skipAhead(consumer);
+        continue;
+      }
+      size_t offset = tail & mask;
+      size_t available = head - tail;
+      if (available > capacity - offset) available = capacity - offset;
+      if (bytes > available) bytes = available;
+      if (policy == DROP && !closed) bytes = (tail + bytes) / DROP_UNIT * DROP_UNIT - tail;
+      return data + offset;
+    }
+    if (closed) {
+      bytes = 0;
+      return 0;
+    }
+    consumer->waiting.store(1);
+    uint32_t signal = producer->dataSignal.load();
+    if (!producer->closed.load() && producer->head.load() < wanted) {
+      Futex::wait(producer->dataSignal, signal, true);
+    }
+    consumer->waiting.store(0);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+//  Finish with bytes returned by peek.  When dropping, the producer may have
+//  written over them while they were being copied; in that case the
+//  consumer is moved ahead and false is returned, so the copy must be
+//  discarded.
+bool FanOutRing::release(int index, size_t bytes) {
+  Consumer * consumer = &consumers[index];
+  size_t tail = consumer->tail.load(std::memory_order_relaxed);
+  if (policy == DROP) {
+    std::atomic_thread_fence(std::memory_order_acquire);  // the copy is complete before this check
+    if (producer->reserved.load() - tail > capacity) {
+      skipAhead(consumer);
+      return false;
+    }
+  }
+  consumer->tail.store(tail + bytes);
+  if (producer->waiting.load()) Futex::wake(producer->spaceSignal, true);
+  return true;
+}
+
+/* ---------------------------------------------------------------------- */
+void FanOutRing::closeConsumer(int index) {
+  consumers[index].closed.store(1);
+  Futex::wake(producer->spaceSignal, true);
+}
+
+/* ---------------------------------------------------------------------- */
+void FanOutRing::report(int index, const char * label) {
+  Consumer * consumer = &consumers[index];
+  fprintf(stderr, "split_stream consumer %d, %s: most behind %zu bytes (%zu%% of ring), dropped %zu bytes in %zu gaps\n",
+          index + 1, label, consumer->maxLag.load(), consumer->maxLag.load() * 100 / capacity,
+          consumer->dropped.load(), consumer->gaps.load());
+}
+
+/* ---------------------------------------------------------------------- */
+FanOutRing::~FanOutRing(void) {
+  if (memory) munmap(memory, mappedSize);
+}
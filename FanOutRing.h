@@ -0,0 +1,79 @@
+#ifndef FANOUTRING_H_
+#define FANOUTRING_H_
+/*
+ *      FanOutRing.h - single producer / multiple consumer byte ring in
+ *                     shared memory.  The producer writes each byte once and
+ *                     every consumer process reads it in place at its own
+ *                     cursor.
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdint.h>
+#include <sys/types.h>
+#include <atomic>
+/* ---------------------------------------------------------------------- */
+class FanOutRing {
+ public:
+  static const size_t CACHE_LINE = 64;
+  static const size_t DEFAULT_SIZE = 1 << 22;
+  static const size_t DROP_UNIT = 4096;  // skips keep the stream aligned to any sample size
+  // What the producer does when the ring is full because of a slow consumer:
+  // BLOCK waits for the slowest consumer; DROP overwrites, and a consumer
+  // that has been lapped skips ahead.
+  enum Policy { BLOCK, DROP };
+
+ private:
+  struct alignas(CACHE_LINE) Producer {
+    std::atomic<size_t> head;          // total bytes ever published
+    std::atomic<size_t> reserved;      // end of the region the producer may be writing
+    std::atomic<uint32_t> waiting;
+    std::atomic<uint32_t> closed;
+    std::atomic<uint32_t> spaceSignal; // futex word the producer sleeps on
+    std::atomic<uint32_t> dataSignal;  // futex word the consumers sleep on
+  };
+  struct alignas(CACHE_LINE) Consumer {
+    std::atomic<size_t> tail;          // total bytes this consumer has read or skipped
+    std::atomic<uint32_t> waiting;
+    std::atomic<uint32_t> closed;
+    std::atomic<size_t> maxLag;        // most bytes this consumer has been behind
+    std::atomic<size_t> dropped;       // bytes skipped because the producer lapped it
+    std::atomic<size_t> gaps;          // number of skips
+    pid_t pid;
+  };
+
+  Policy policy;
+  int numberOfConsumers;
+  size_t capacity;                     // a power of two
+  size_t mask;
+  size_t chunk;                        // most the producer claims at once
+  size_t mappedSize;
+  void * memory;
+  Producer * producer;
+  Consumer * consumers;
+  unsigned char * data;
+
+  size_t slowestTail(size_t head);
+  void reapConsumers(void);
+  void skipAhead(Consumer * consumer);
+
+ public:
+  bool isOpen(void) { return memory != 0; }
+  int size(void) { return numberOfConsumers; }
+  // producer side
+  unsigned char * claim(size_t & bytes);
+  void publish(size_t bytes);
+  void close(void);
+  void setConsumerProcess(int index, pid_t pid) { consumers[index].pid = pid; }
+  void report(int index, const char * label);
+  // consumer side
+  const unsigned char * peek(int index, size_t & bytes);
+  bool release(int index, size_t bytes);
+  void closeConsumer(int index);
+  FanOutRing(int numberOfConsumers, Policy policy, size_t capacity = DEFAULT_SIZE);
+  ~FanOutRing(void);
+};
+#endif  // FANOUTRING_H_
@@ -0,0 +1,189 @@
+/*
+ *      FrameFormat.cc - optional self describing stream format
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <string.h>
+#include <cinttypes>
+#include "FrameFormat.h"
+/* ---------------------------------------------------------------------- */
+static const char STREAM_MAGIC[4] = { 'D', 'S', 'P', 'F' };
+static const char BLOCK_MAGIC[4] = { 'D', 'S', 'P', 'B' };
+static const uint32_t VERSION = 1;
+
+static const struct {
+  const char * name;
+  int type;
+  size_t size;
+} sampleTypes[] = {
+  { "uByte",  FrameFormat::UBYTE,  1 },
+  { "byte",   FrameFormat::BYTE,   1 },
+  { "sInt16", FrameFormat::SINT16, 2 },
+  { "uInt16", FrameFormat::UINT16, 2 },
+  { "f",      FrameFormat::FLOAT,  4 },
+  { 0, 0, 0 }
+};
+
+/* ---------------------------------------------------------------------- */
+//  Sample type for the name used in the command names, such as "uByte" in
+//  convert_uByte_f, or zero if there is none.
+int FrameFormat::typeFromName(const char * name) {
+  for (int index = 0; sampleTypes[index].name; index++) {
+    if (strcmp(name, sampleTypes[index].name) == 0) return sampleTypes[index].type;
+  }
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+const char * FrameFormat::typeName(int type) {
+  for (int index = 0; sampleTypes[index].name; index++) {
+    if (sampleTypes[index].type == type) return sampleTypes[index].name;
+  }
+  return "unknown";
+}
+
+/* ---------------------------------------------------------------------- */
+size_t FrameFormat::sampleSize(int type) {
+  for (int index = 0; sampleTypes[index].name; index++) {
+    if (sampleTypes[index].type == type) return sampleTypes[index].size;
+  }
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+FrameWriter::FrameWriter(Stream * stream, int sampleType, int channels, double sampleRate, double centerFrequency) {
+  this->stream = stream;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, STREAM_MAGIC, sizeof(header.magic));
+  header.version = VERSION;
+  header.sampleType = sampleType;
+  header.channels = channels;
+  header.sampleRate = sampleRate;
+  header.centerFrequency = centerFrequency;
+  size_t sampleBytes = FrameFormat::sampleSize(sampleType) * channels;
+  frameSamples = sampleBytes ? FrameFormat::PAYLOAD_SIZE / sampleBytes : 0;
+  sampleIndex = 0;
+  used = 0;
+  memset(frame, 0, sizeof(frame));
+}
+
+/* ---------------------------------------------------------------------- */
+//  The header takes a whole frame so that data frames start on frame
+//  boundaries of the stream.
+bool FrameWriter::writeHeader(void) {
+  if (frameSamples == 0) {
+    fprintf(stderr, "frame format: unsupported sample type or channel count\n");
+    return false;
+  }
+  unsigned char first[FrameFormat::FRAME_SIZE];
+  memset(first, 0, sizeof(first));
+  memcpy(first, &header, sizeof(header));
+  return stream->write(first, FrameFormat::FRAME_SIZE, 1) == 1;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Every frame but the last is padded to FRAME_SIZE.
+bool FrameWriter::flushFrame(void) {
+  if (used == 0) return true;
+  FrameFormat::BlockHeader * block = reinterpret_cast<FrameFormat::BlockHeader *>(frame);
+  memcpy(block->magic, BLOCK_MAGIC, sizeof(block->magic));
+  block->payloadBytes = used;
+  block->sampleIndex = sampleIndex;
+  size_t sampleBytes = FrameFormat::sampleSize(header.sampleType) * header.channels;
+  bool full = (used == frameSamples * sampleBytes);
+  size_t bytes = full ? FrameFormat::FRAME_SIZE : sizeof(FrameFormat::BlockHeader) + used;
+  if (full) memset(frame + sizeof(FrameFormat::BlockHeader) + used, 0, FrameFormat::PAYLOAD_SIZE - used);
+  sampleIndex += used / sampleBytes;
+  used = 0;
+  return stream->write(frame, bytes, 1) == 1;
+}
+
+/* ---------------------------------------------------------------------- */
+bool FrameWriter::write(const void * samples, size_t bytes) {
+  const unsigned char * data = reinterpret_cast<const unsigned char *>(samples);
+  size_t frameBytes = frameSamples * FrameFormat::sampleSize(header.sampleType) * header.channels;
+  while (bytes > 0) {
+    size_t piece = frameBytes - used;
+    if (piece > bytes) piece = bytes;
+    memcpy(frame + sizeof(FrameFormat::BlockHeader) + used, data, piece);
+    used += piece;
+    data += piece;
+    bytes -= piece;
+    if (used == frameBytes && !flushFrame()) return false;
+  }
+  return true;
+}
+
+/* ---------------------------------------------------------------------- */
+bool FrameWriter::close(void) {
+  return flushFrame();
+}
+
+/* ---------------------------------------------------------------------- */
+FrameReader::FrameReader(Stream * stream) {
+  this->stream = stream;
+  memset(&header, 0, sizeof(header));
+  sampleBytes = 0;
+  expectedIndex = 0;
+  missingSamples = 0;
+  gaps = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+bool FrameReader::readHeader(void) {
+  if (stream->read(frame, FrameFormat::FRAME_SIZE, 1) != 1) {
+    fprintf(stderr, "frame format: stream ended before its header\n");
+    return false;
+  }
+  memcpy(&header, frame, sizeof(header));
+  if (memcmp(header.magic, STREAM_MAGIC, sizeof(header.magic)) != 0) {
+    fprintf(stderr, "frame format: stream is not framed\n");
+    return false;
+  }
+  if (header.version != VERSION) {
+    fprintf(stderr, "frame format: unsupported version %d\n", header.version);
+    return false;
+  }
+  sampleBytes = FrameFormat::sampleSize(header.sampleType) * header.channels;
+  if (sampleBytes == 0) {
+    fprintf(stderr, "frame format: unsupported sample type or channel count\n");
+    return false;
+  }
+  return true;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Frames are read whole, so a stream that had frames skipped on the way,
+//  such as by tee -n, is still read on frame boundaries and the skip is seen
+//  as a jump in the sample index.
+const unsigned char * FrameReader::next(size_t & bytes, uint64_t & missing) {
+  const size_t BLOCK_HEADER = sizeof(FrameFormat::BlockHeader);
+  bytes = 0;
+  missing = 0;
+  if (stream->read(frame, BLOCK_HEADER, 1) != 1) return 0;
+  FrameFormat::BlockHeader * block = reinterpret_cast<FrameFormat::BlockHeader *>(frame);
+  if (memcmp(block->magic, BLOCK_MAGIC, sizeof(block->magic)) != 0 || block->payloadBytes > FrameFormat::PAYLOAD_SIZE) {
+    fprintf(stderr, "frame format: lost frame alignment after sample %" PRIu64 "\n", expectedIndex);
+    return 0;
+  }
+  size_t payload = block->payloadBytes;
+  size_t got = stream->read(frame + BLOCK_HEADER, 1, FrameFormat::PAYLOAD_SIZE);
+  if (got < payload) {
+    fprintf(stderr, "frame format: stream ended inside a frame\n");
+    payload = got / sampleBytes * sampleBytes;
+  }
+  if (block->sampleIndex > expectedIndex) {
+    missing = block->sampleIndex - expectedIndex;
+    missingSamples += missing;
+    gaps++;
+  } else if (block->sampleIndex < expectedIndex) {
+    fprintf(stderr, "frame format: sample index went back from %" PRIu64 " to %" PRIu64 "\n", expectedIndex, block->sampleIndex);
+  }
+  expectedIndex = block->sampleIndex + payload / sampleBytes;
+  bytes = payload;
+  return frame + BLOCK_HEADER;
+}
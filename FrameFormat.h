@@ -0,0 +1,91 @@
+#ifndef FRAMEFORMAT_H_
+#define FRAMEFORMAT_H_
+/*
+ *      FrameFormat.h - optional self describing stream format.  A framed
+ *                      stream starts with a header frame giving the sample
+ *                      type, channel count, sample rate and center frequency,
+ *                      followed by data frames that carry a running sample
+ *                      index.
+ *
+ *                      Every frame is FRAME_SIZE bytes (only the last may be
+ *                      shorter), the same size as the blocks tee -n and
+ *                      split_stream -d skip, so a skip removes whole frames
+ *                      and shows up as a jump in the sample index.  All
+ *                      fields are in the byte order of the machine.
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdint.h>
+#include "Stream.h"
+/* ---------------------------------------------------------------------- */
+class FrameFormat {
+ public:
+  static const size_t FRAME_SIZE = 4096;
+  enum SampleType { UBYTE = 1, BYTE, SINT16, UINT16, FLOAT };
+
+  struct StreamHeader {
+    char magic[4];                 // "DSPF"
+    uint32_t version;
+    uint32_t sampleType;
+    uint32_t channels;             // 1 real, 2 complex (I/Q)
+    double sampleRate;             // samples per second
+    double centerFrequency;        // Hz, 0 if not known
+  };
+  struct BlockHeader {
+    char magic[4];                 // "DSPB"
+    uint32_t payloadBytes;
+    uint64_t sampleIndex;          // index of the first sample in the frame
+  };
+  static const size_t PAYLOAD_SIZE = FRAME_SIZE - sizeof(BlockHeader);
+
+  static int typeFromName(const char * name);
+  static const char * typeName(int type);
+  static size_t sampleSize(int type);  // bytes per sample of one channel
+};
+
+/* ---------------------------------------------------------------------- */
+class FrameWriter {
+ private:
+  Stream * stream;
+  FrameFormat::StreamHeader header;
+  size_t frameSamples;             // samples (all channels) per full frame
+  uint64_t sampleIndex;
+  unsigned char frame[FrameFormat::FRAME_SIZE];
+  size_t used;                     // payload bytes in frame
+
+  bool flushFrame(void);
+
+ public:
+  bool writeHeader(void);
+  bool write(const void * samples, size_t bytes);
+  bool close(void);
+  FrameWriter(Stream * stream, int sampleType, int channels, double sampleRate, double centerFrequency);
+};
+
+/* ---------------------------------------------------------------------- */
+class FrameReader {
+ private:
+  Stream * stream;
+  FrameFormat::StreamHeader header;
+  size_t sampleBytes;              // bytes per sample, all channels
+  uint64_t expectedIndex;
+  uint64_t missingSamples;
+  uint64_t gaps;
+  unsigned char frame[FrameFormat::FRAME_SIZE];
+
+ public:
+  bool readHeader(void);
+  const FrameFormat::StreamHeader & format(void) { return header; }
+  // Next frame's payload, or zero at the end of the stream.  missing is set
+  // to the number of samples lost in front of this frame.
+  const unsigned char * next(size_t & bytes, uint64_t & missing);
+  uint64_t missing(void) { return missingSamples; }
+  uint64_t numberOfGaps(void) { return gaps; }
+  size_t bytesPerSample(void) { return sampleBytes; }
+  explicit FrameReader(Stream * stream);
+};
+#endif  // FRAMEFORMAT_H_
@@ -0,0 +1,178 @@
+/*
+ *      FsSlash4.cc - fs/4 frequency shift of signed byte I/Q samples
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  Over one cycle the pairs become (I0, Q0), (-Q1, I1), (-I2, -Q2) and
+ *  (Q3, -I3).  A shuffle puts each output byte in place and a multiply by
+ *  +/-1 sets its sign, with -128 staying -128 as the scalar code leaves it.
+ *  For split the shuffle also gathers the even pairs into the low half of
+ *  the vector and the odd pairs into the high half.
+ */
+
+/* ---------------------------------------------------------------------- */
+#include "FsSlash4.h"
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define FS4_X86
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FS4_NEON
+#endif
+/* ---------------------------------------------------------------------- */
+namespace {
+
+struct Implementation {
+  const char * name;
+  void (*rotate)(const signed char * input, signed char * output, int cycles);
+  void (*split)(const signed char * input, int cycles, float * even, float * odd);
+};
+
+// two cycles, as 16 bytes: where each output byte comes from and its sign
+const signed char ROTATE_ORDER[16] = { 0, 1, 3, 2, 4, 5, 7, 6, 8, 9, 11, 10, 12, 13, 15, 14 };
+const signed char ROTATE_SIGNS[16] = { 1, 1, -1, 1, -1, -1, 1, -1, 1, 1, -1, 1, -1, -1, 1, -1 };
+const signed char SPLIT_ORDER[16] = { 0, 1, 4, 5, 8, 9, 12, 13, 3, 2, 7, 6, 11, 10, 15, 14 };
+const signed char SPLIT_SIGNS[16] = { 1, 1, -1, -1, 1, 1, -1, -1, -1, 1, 1, -1, -1, 1, 1, -1 };
+const float SCALE = 1.0f / 128.0f;
+
+/* ---------------------------------------------------------------------- */
+void rotateScalar(const signed char * input, signed char * output, int cycles) {
+  for (int n = 0; n < cycles * 8; n += 8) {
+    output[n + 0] = input[n + 0];
+    output[n + 1] = input[n + 1];
+    output[n + 2] = -input[n + 3];
+    output[n + 3] = input[n + 2];
+    output[n + 4] = -input[n + 4];
+    output[n + 5] = -input[n + 5];
+    output[n + 6] = input[n + 7];
+    output[n + 7] = -input[n + 6];
+  }
+}
+
+//  rotated first, so a -128 negated stays -128 as in the vector code
+void splitScalar(const signed char * input, int cycles, float * even, float * odd) {
+  signed char rotated[8];
+  for (int n = 0; n < cycles; n++, input += 8, even += 4, odd += 4) {
+    rotateScalar(input, rotated, 1);
+    even[0] = rotated[0] * SCALE;
+    even[1] = rotated[1] * SCALE;
+    even[2] = rotated[4] * SCALE;
+    even[3] = rotated[5] * SCALE;
+    odd[0] = rotated[2] * SCALE;
+    odd[1] = rotated[3] * SCALE;
+    odd[2] = rotated[6] * SCALE;
+    odd[3] = rotated[7] * SCALE;
+  }
+}
+
+#if defined(FS4_X86) && defined(__SSE2__)
+/* ---------------------------------------------------------------------- */
+__attribute__((target("ssse3"))) void rotateSSSE3(const signed char * input, signed char * output, int cycles) {
+  const __m128i order = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ROTATE_ORDER));
+  const __m128i signs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(ROTATE_SIGNS));
+  int n = 0;
+  for (; n + 2 <= cycles; n += 2) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + 8 * n));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(output + 8 * n), _mm_sign_epi8(_mm_shuffle_epi8(x, order), signs));
+  }
+  rotateScalar(input + 8 * n, output + 8 * n, cycles - n);
+}
+
+// the low or high 8 bytes of x, sign extended, as two vectors of floats
+inline void widen(__m128i bytes, float * output) {
+  __m128i words = _mm_srai_epi16(_mm_unpacklo_epi8(bytes, bytes), 8);
+  __m128 scale = _mm_set1_ps(SCALE);
+  _mm_storeu_ps(output, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpacklo_epi16(words, words), 16)), scale));
+  _mm_storeu_ps(output + 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_srai_epi32(_mm_unpackhi_epi16(words, words), 16)), scale));
+}
+
+__attribute__((target("ssse3"))) void splitSSSE3(const signed char * input, int cycles, float * even, float * odd) {
+  const __m128i order = _mm_loadu_si128(reinterpret_cast<const __m128i *>(SPLIT_ORDER));
+  const __m128i signs = _mm_loadu_si128(reinterpret_cast<const __m128i *>(SPLIT_SIGNS));
+  int n = 0;
+  for (; n + 2 <= cycles; n += 2) {
+    __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(input + 8 * n));
+    __m128i y = _mm_sign_epi8(_mm_shuffle_epi8(x, order), signs);
+    widen(y, even + 4 * n);
+    widen(_mm_unpackhi_epi64(y, y), odd + 4 * n);
+  }
+  splitScalar(input + 8 * n, cycles - n, even + 4 * n, odd + 4 * n);
+}
+#endif
+
+#ifdef FS4_NEON
+/* ---------------------------------------------------------------------- */
+//  vtbl2 looks up 8 bytes at a time in a 16 byte table, so it serves both
+//  32 and 64 bit ARM.
+inline int8x16_t shuffle(int8x16_t x, const signed char * order, const signed char * signs) {
+  int8x8x2_t table = { { vget_low_s8(x), vget_high_s8(x) } };
+  int8x16_t y = vcombine_s8(vtbl2_s8(table, vld1_s8(order)), vtbl2_s8(table, vld1_s8(order + 8)));
+  return vmulq_s8(y, vld1q_s8(signs));
+}
+
+void rotateNEON(const signed char * input, signed char * output, int cycles) {
+  int n = 0;
+  for (; n + 2 <= cycles; n += 2) {
+    vst1q_s8(output + 8 * n, shuffle(vld1q_s8(input + 8 * n), ROTATE_ORDER, ROTATE_SIGNS));
+  }
+  rotateScalar(input + 8 * n, output + 8 * n, cycles - n);
+}
+
+inline void widen(int8x8_t bytes, float * output) {
+  int16x8_t words = vmovl_s8(bytes);
+  vst1q_f32(output, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(words))), SCALE));
+  vst1q_f32(output + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(words))), SCALE));
+}
+
+void splitNEON(const signed char * input, int cycles, float * even, float * odd) {
+  int n = 0;
+  for (; n + 2 <= cycles; n += 2) {
+    int8x16_t y = shuffle(vld1q_s8(input + 8 * n), SPLIT_ORDER, SPLIT_SIGNS);
+    widen(vget_low_s8(y), even + 4 * n);
+    widen(vget_high_s8(y), odd + 4 * n);
+  }
+  splitScalar(input + 8 * n, cycles - n, even + 4 * n, odd + 4 * n);
+}
+#endif
+
+/* ---------------------------------------------------------------------- */
+Implementation choose(void) {
+  const Implementation scalar = { "scalar", rotateScalar, splitScalar };
+#if defined(FS4_X86) && defined(__SSE2__)
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("ssse3")) {
+    const Implementation ssse3 = { "ssse3", rotateSSSE3, splitSSSE3 };
+    return ssse3;
+  }
+#endif
+#ifdef FS4_NEON
+  const Implementation neon = { "neon", rotateNEON, splitNEON };
+  return neon;
+#endif
+  return scalar;
+}
+
+/* ---------------------------------------------------------------------- */
+const Implementation & chosen(void) {
+  static const Implementation implementation = choose();
+  return implementation;
+}
+
+}  // namespace
+
+/* ---------------------------------------------------------------------- */
+void FsSlash4::rotate(const signed char * input, signed char * output, int cycles) {
+  chosen().rotate(input, output, cycles);
+}
+
+/* ---------------------------------------------------------------------- */
+void FsSlash4::split(const signed char * input, int cycles, float * even, float * odd) {
+  chosen().split(input, cycles, even, odd);
+}
+
+/* ---------------------------------------------------------------------- */
+const char * FsSlash4::implementation(void) {
+  return chosen().name;
+}
@@ -0,0 +1,24 @@
+#ifndef FSSLASH4_H_
+#define FSSLASH4_H_
+/*
+ *      FsSlash4.h - shift signed byte I/Q samples up by a quarter of the
+ *                   sample rate.  Sample n is multiplied by j^n, a cycle of
+ *                   four that only swaps I and Q and changes signs, so it
+ *                   is done with byte shuffles: SSSE3 pshufb and psignb on
+ *                   x86, vtbl on ARM, plain C otherwise.
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+namespace FsSlash4 {
+// cycles of 4 I/Q pairs (8 bytes) from input, shifted, to output
+void rotate(const signed char * input, signed char * output, int cycles);
+// the same, converted to float (full scale at +/-1.0) and split into the
+// even and odd pairs, 2 * cycles of each, as the half-band kernel wants them
+void split(const signed char * input, int cycles, float * even, float * odd);
+const char * implementation(void);
+}  // namespace FsSlash4
+#endif  // FSSLASH4_H_
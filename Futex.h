@@ -0,0 +1,61 @@
+#ifndef FUTEX_H_
+#define FUTEX_H_
+/*
+ *      Futex.h - sleep and wake on a 32 bit word shared between threads or
+ *                processes, used by the lock free rings
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdint.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#ifdef __linux__
+#include <limits.h>
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+/* ---------------------------------------------------------------------- */
+namespace Futex {
+
+/* ---------------------------------------------------------------------- */
+inline void cpuRelax(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+  asm volatile("yield");
+#endif
+}
+
+/* ---------------------------------------------------------------------- */
+//  Sleep while word still holds value, for at most milliseconds if that is
+//  not zero.  Spurious returns are fine - every caller rechecks its
+//  condition.  The private operations are cheaper but only work when every
+//  thread using the word is in the same process.
+inline void wait(std::atomic<uint32_t> & word, uint32_t value, bool shared, int milliseconds = 0) {
+#ifdef __linux__
+  struct timespec timeout = { milliseconds / 1000, (milliseconds % 1000) * 1000000L };
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), shared ? FUTEX_WAIT : FUTEX_WAIT_PRIVATE,
+          value, milliseconds ? &timeout : NULL, NULL, 0);
+#else
+  if (word.load() == value) std::this_thread::sleep_for(std::chrono::microseconds(100));
+#endif
+}
+
+/* ---------------------------------------------------------------------- */
+//  Change word and wake one (or every) thread sleeping on it.
+inline void wake(std::atomic<uint32_t> & word, bool shared, bool all = false) {
+  word.fetch_add(1);
+#ifdef __linux__
+  syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), shared ? FUTEX_WAKE : FUTEX_WAKE_PRIVATE,
+          all ? INT_MAX : 1, NULL, NULL, 0);
+#endif
+}
+}  // namespace Futex
+#endif  // FUTEX_H_
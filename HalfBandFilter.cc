@@ -0,0 +1,139 @@
+/*
+ *      HalfBandFilter.cc - decimate by 2 with a half-band filter
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  With 4m + 3 coefficients h, centered on h[2m + 1] = 0.5 and zero at
+ *  every other even offset from it, output k is
+ *
+ *    0.5 * x[2k + 2m + 1] + sum of h[2i] * (x[2k + 2i] + x[2k + 4m + 2 - 2i])
+ *
+ *  for i from 0 to m: one multiply for the odd sample and m + 1 for the
+ *  even ones, with the even samples added in pairs first.  The block is
+ *  split into its even and odd samples so the kernel reads both
+ *  contiguously.
+ *
+ *  Shifting by fs/4 first multiplies sample n by j^n: the even samples by
+ *  +/-1 and the odd ones by +/-j.  Neither needs a multiply, so the shift
+ *  is made by the byte shuffles that split the block.
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "FIRKernels.h"
+#include "FsSlash4.h"
+#include "HalfBandFilter.h"
+#include "KaiserWindow.h"
+#include "Stream.h"
+/* ---------------------------------------------------------------------- */
+HalfBandFilter::HalfBandFilter(double passband, double attenuation, bool complexFilter) {
+  doWork(tapsFor(passband, attenuation), attenuation, complexFilter, 2 * N);
+}
+
+/* ---------------------------------------------------------------------- */
+HalfBandFilter::HalfBandFilter(int taps, double attenuation, bool complexFilter, int inputs) {
+  doWork(taps, attenuation, complexFilter, inputs);
+}
+
+/* ---------------------------------------------------------------------- */
+int HalfBandFilter::tapsFor(double passband, double attenuation) {
+  double transition = 0.5 - 2.0 * passband;
+  if (transition <= 0.0) transition = 0.01;  // a passband to 0.25 can not be had, get close
+  return KaiserWindow::taps(transition, attenuation) / 4 * 4 + 3;
+}
+
+/* ---------------------------------------------------------------------- */
+void HalfBandFilter::doWork(int taps, double attenuation, bool complexFilter, int inputs) {
+  this->complexFilter = complexFilter;
+  width = complexFilter ? 2 : 1;
+  this->taps = taps;
+  this->inputs = inputs;
+  count = (taps + 1) / 4;
+  // the window design is already zero at the even offsets, bar rounding;
+  // the center is set to 0.5 and the rest scaled to a gain of 1
+  float * design = KaiserWindow::lowPass(0.25, taps, attenuation);
+  coefficients = reinterpret_cast<float *>(malloc(count * sizeof(float)));
+  double sum = 0.0;
+  for (int i = 0; i < count; i++) sum += design[2 * i];
+  for (int i = 0; i < count; i++) coefficients[i] = design[2 * i] * 0.25 / sum;
+  free(design);
+  int used = taps - 1 + inputs;
+  signalBuffer = reinterpret_cast<float *>(calloc(used * width, sizeof(float)));  // the first history is silence
+  even = reinterpret_cast<float *>(malloc(used / 2 * width * sizeof(float)));
+  odd = reinterpret_cast<float *>(malloc(used / 2 * width * sizeof(float)));
+  outputBuffer = reinterpret_cast<float *>(malloc(inputs / 2 * width * sizeof(float)));
+}
+
+/* ---------------------------------------------------------------------- */
+//  Filters the block in signalBuffer and keeps its end as the next history.
+void HalfBandFilter::run(float * output) {
+  int history = (taps - 1) * width;
+  FIRKernels::split(signalBuffer, width, (taps - 1 + inputs) / 2, even, odd);
+  FIRKernels::halfBand(coefficients, count, even, odd, width, output, inputs / 2);
+  memmove(signalBuffer, signalBuffer + inputs * width, history * sizeof(float));
+}
+
+/* ---------------------------------------------------------------------- */
+void HalfBandFilter::filter(const float * input, float * output) {
+  memcpy(signalBuffer + (taps - 1) * width, input, inputs * width * sizeof(float));
+  run(output);
+}
+
+/* ---------------------------------------------------------------------- */
+//  Only a filter used on its own describes itself; as a stage of a cascade
+//  the cascade's plan says what it is.
+void HalfBandFilter::filterSignal(void) {
+  int size = inputs * width * sizeof(float);
+  fprintf(stderr, "half-band filter of %d coefficients, %d multiplies per output\n", taps, count + 1);
+  for (;;) {
+    if (Stream::input()->read(signalBuffer + (taps - 1) * width, sizeof(char), size) != (size_t) size) {
+      fprintf(stderr, "Short read....\n");
+      Stream::output()->close();
+      break;
+    }
+    run(outputBuffer);
+    Stream::output()->write(outputBuffer, sizeof(char), size / 2);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+//  The history is kept already split, so only the new block is shifted.
+void HalfBandFilter::filterQuarterShifted(void) {
+  if (!complexFilter || inputs % 4) {
+    fprintf(stderr, "fs/4 shift needs a complex filter and a multiple of 4 inputs\n");
+    return;
+  }
+  int history = (taps - 1) / 2 * width;
+  int block = inputs / 2 * width;
+  int size = inputs * 2;
+  signed char * bytes = reinterpret_cast<signed char *>(malloc(size));
+  memset(even, 0, history * sizeof(float));
+  memset(odd, 0, history * sizeof(float));
+  fprintf(stderr, "half-band filter of %d coefficients, %d multiplies per output\n", taps, count + 1);
+  fprintf(stderr, "fs/4 shift with %s shuffles\n", FsSlash4::implementation());
+  for (;;) {
+    if (Stream::input()->read(bytes, sizeof(char), size) != (size_t) size) {
+      fprintf(stderr, "Short read....\n");
+      Stream::output()->close();
+      break;
+    }
+    FsSlash4::split(bytes, inputs / 4, even + history, odd + history);
+    FIRKernels::halfBand(coefficients, count, even, odd, width, outputBuffer, inputs / 2);
+    memmove(even, even + block, history * sizeof(float));
+    memmove(odd, odd + block, history * sizeof(float));
+    Stream::output()->write(outputBuffer, sizeof(float), block);
+  }
+  free(bytes);
+}
+
+/* ---------------------------------------------------------------------- */
+HalfBandFilter::~HalfBandFilter(void) {
+  free(coefficients);
+  free(signalBuffer);
+  free(even);
+  free(odd);
+  free(outputBuffer);
+}
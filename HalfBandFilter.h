@@ -0,0 +1,50 @@
+#ifndef HALFBANDFILTER_H_
+#define HALFBANDFILTER_H_
+/*
+ *      HalfBandFilter.h - decimate by 2 with a half-band filter.  Every
+ *                         other coefficient is zero and the center one is
+ *                         0.5, and the rest are symmetric, so each output
+ *                         takes about a quarter of the multiplies of a
+ *                         general FIR filter of the same length.
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+
+/* ---------------------------------------------------------------------- */
+class HalfBandFilter {
+ private:
+  static const int N = 4096;   // default outputs per block
+  bool complexFilter;          // defines if the object is a complex or real filter
+  int width;                   // floats per sample
+  int taps;                    // 4 * count - 1
+  int count;                   // nonzero coefficients on each side of the center
+  float * coefficients;        // those from the end in to the center
+  int inputs;                  // samples per block
+  float * signalBuffer;        // taps - 1 samples of history, then the block
+  float * even;                // signalBuffer split for the kernel
+  float * odd;
+  float * outputBuffer;
+
+  void doWork(int taps, double attenuation, bool complexFilter, int inputs);
+  void run(float * output);
+
+ public:
+  // taps, rounded up to 4m + 3, to keep passband (a fraction of the input
+  // rate, below 0.25) and attenuate the band that would alias onto it
+  static int tapsFor(double passband, double attenuation);
+  int length(void) { return taps; }
+  // inputs samples, I/Q interleaved for a complex filter, to inputs / 2
+  void filter(const float * input, float * output);
+  void filterSignal(void);
+  // complex filter only: signed byte I/Q in, shifted up by fs/4 on the way
+  void filterQuarterShifted(void);
+
+  HalfBandFilter(double passband, double attenuation, bool complexFilter);
+  HalfBandFilter(int taps, double attenuation, bool complexFilter, int inputs);
+  ~HalfBandFilter(void);
+};
+#endif  // HALFBANDFILTER_H_
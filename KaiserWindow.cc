@@ -0,0 +1,66 @@
+/*
+ *      KaiserWindow.cc - low pass filters designed from a transition width
+ *                        and an attenuation
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <math.h>
+#include <stdlib.h>
+#include "KaiserWindow.h"
+/* ---------------------------------------------------------------------- */
+namespace {
+
+double besselI0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  for (int k = 1; term > sum * 1e-12; k++) {
+    term *= (x / (2.0 * k)) * (x / (2.0 * k));
+    sum += term;
+  }
+  return sum;
+}
+
+}  // namespace
+
+/* ---------------------------------------------------------------------- */
+int KaiserWindow::taps(double transition, double attenuation) {
+  int taps = ceil((attenuation - 7.95) / (14.36 * transition)) + 1;
+  return taps < 3 ? 3 : taps;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Computed for one half and mirrored, so it is exactly symmetric.
+float * KaiserWindow::window(int taps, double attenuation) {
+  double beta = 0.0;
+  if (attenuation > 50.0) {
+    beta = 0.1102 * (attenuation - 8.7);
+  } else if (attenuation > 21.0) {
+    beta = 0.5842 * pow(attenuation - 21.0, 0.4) + 0.07886 * (attenuation - 21.0);
+  }
+  float * window = reinterpret_cast<float *>(malloc(taps * sizeof(float)));
+  double middle = (taps - 1) / 2.0;
+  for (int n = 0; n <= (taps - 1) / 2; n++) {
+    double ratio = (n - middle) / middle;
+    window[n] = window[taps - 1 - n] = besselI0(beta * sqrt(1.0 - ratio * ratio)) / besselI0(beta);
+  }
+  return window;
+}
+
+/* ---------------------------------------------------------------------- */
+float * KaiserWindow::lowPass(double cutoff, int taps, double attenuation) {
+  float * coefficients = window(taps, attenuation);
+  double middle = (taps - 1) / 2.0;
+  double sum = 0.0;
+  for (int n = 0; n <= (taps - 1) / 2; n++) {
+    double x = n - middle;
+    double sinc = x == 0.0 ? 2.0 * cutoff : sin(2.0 * M_PI * cutoff * x) / (M_PI * x);
+    coefficients[n] = coefficients[taps - 1 - n] = sinc * coefficients[n];
+  }
+  for (int n = 0; n < taps; n++) sum += coefficients[n];
+  for (int n = 0; n < taps; n++) coefficients[n] /= sum;
+  return coefficients;
+}
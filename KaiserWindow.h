@@ -0,0 +1,24 @@
+#ifndef KAISERWINDOW_H_
+#define KAISERWINDOW_H_
+/*
+ *      KaiserWindow.h - low pass filters designed from a transition width
+ *                       and an attenuation, with Kaiser's estimates of the
+ *                       length and window shape needed
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+namespace KaiserWindow {
+// coefficients needed for a transition band, as a fraction of the sample
+// rate, and an attenuation in dB - at least 3
+int taps(double transition, double attenuation);
+// the window itself, taps long, allocated with malloc
+float * window(int taps, double attenuation);
+// windowed sinc with a gain of 1 and cutoff as a fraction of the sample
+// rate, exactly symmetric, allocated with malloc
+float * lowPass(double cutoff, int taps, double attenuation);
+}  // namespace KaiserWindow
+#endif  // KAISERWINDOW_H_
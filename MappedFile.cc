@@ -0,0 +1,115 @@
+/*
+ *      MappedFile.cc - recording read or written through a memory map
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "MappedFile.h"
+
+// windows are placed by 64 bit offsets even where long is 32 bits
+static_assert(sizeof(off_t) == 8, "build with -D_FILE_OFFSET_BITS=64");
+/* ---------------------------------------------------------------------- */
+MappedFile::MappedFile(const char * path, Mode mode) {
+  this->mode = mode;
+  window = 0;
+  windowStart = 0;
+  windowLength = 0;
+  fileSize = 0;
+  if (mode == READ) {
+    fd = open(path, O_RDONLY);
+  } else {
+    fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+  }
+  if (fd < 0) {
+    fprintf(stderr, "could not open %s: ", path);
+    perror(0);
+    return;
+  }
+  if (mode == READ) {
+    struct stat status;
+    if (fstat(fd, &status) == 0) fileSize = status.st_size;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+//  Windows start on WINDOW_SIZE boundaries.  The kernel is told the window
+//  will be read or written in order, so it reads ahead aggressively and
+//  drops pages behind, and that huge pages may back it where the file
+//  system supports them.
+bool MappedFile::mapWindow(off_t position) {
+  unmapWindow();
+  windowStart = position / WINDOW_SIZE * WINDOW_SIZE;
+  windowLength = WINDOW_SIZE;
+  if (mode == READ) {
+    if (windowStart + (off_t) windowLength > fileSize) windowLength = fileSize - windowStart;
+  } else if (ftruncate(fd, windowStart + windowLength) != 0) {  // the file must cover the window
+    perror("could not extend recording");
+    return false;
+  }
+  int protection = (mode == READ) ? PROT_READ : PROT_READ | PROT_WRITE;
+  void * memory = mmap(0, windowLength, protection, MAP_SHARED, fd, windowStart);
+  if (memory == MAP_FAILED) {
+    perror("could not map recording");
+    windowLength = 0;
+    return false;
+  }
+  window = reinterpret_cast<unsigned char *>(memory);
+  madvise(window, windowLength, MADV_SEQUENTIAL);
+#ifdef MADV_HUGEPAGE
+  madvise(window, windowLength, MADV_HUGEPAGE);
+#endif
+  if (mode == READ) madvise(window, windowLength, MADV_WILLNEED);
+  return true;
+}
+
+/* ---------------------------------------------------------------------- */
+void MappedFile::unmapWindow(void) {
+  if (window) munmap(window, windowLength);
+  window = 0;
+  windowLength = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+const unsigned char * MappedFile::view(off_t position, size_t & bytes) {
+  if (fd < 0 || position >= fileSize) return 0;
+  if (!window || position < windowStart || position >= windowStart + (off_t) windowLength) {
+    if (!mapWindow(position)) return 0;
+  }
+  size_t available = windowStart + windowLength - position;
+  if (bytes > available) bytes = available;
+  return window + (position - windowStart);
+}
+
+/* ---------------------------------------------------------------------- */
+unsigned char * MappedFile::reserve(size_t & bytes) {
+  if (fd < 0) return 0;
+  if (!window || fileSize >= windowStart + (off_t) windowLength) {
+    if (!mapWindow(fileSize)) return 0;
+  }
+  size_t room = windowStart + windowLength - fileSize;
+  if (bytes > room) bytes = room;
+  return window + (fileSize - windowStart);
+}
+
+/* ---------------------------------------------------------------------- */
+void MappedFile::commit(size_t bytes) {
+  fileSize += bytes;
+}
+
+/* ---------------------------------------------------------------------- */
+//  A written file was extended a window at a time, so it is cut back to
+//  what was actually written.
+MappedFile::~MappedFile(void) {
+  unmapWindow();
+  if (fd < 0) return;
+  if (mode == WRITE && ftruncate(fd, fileSize) != 0) perror("could not trim recording");
+  close(fd);
+}
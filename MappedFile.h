@@ -0,0 +1,45 @@
+#ifndef MAPPEDFILE_H_
+#define MAPPEDFILE_H_
+/*
+ *      MappedFile.h - recording read or written through a memory map, a
+ *                     window at a time so that files larger than the
+ *                     address space of a 32 bit system can be used
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stddef.h>
+#include <sys/types.h>
+/* ---------------------------------------------------------------------- */
+class MappedFile {
+ public:
+  enum Mode { READ, WRITE };
+  static const size_t WINDOW_SIZE = 1 << 26;  // a multiple of every page size
+
+ private:
+  int fd;
+  Mode mode;
+  off_t fileSize;                      // bytes in the file, or written so far
+  unsigned char * window;
+  off_t windowStart;
+  size_t windowLength;
+
+  bool mapWindow(off_t position);
+  void unmapWindow(void);
+
+ public:
+  bool isOpen(void) { return fd >= 0; }
+  off_t size(void) { return fileSize; }
+  // READ: the bytes at position, with bytes reduced to what is mapped there
+  const unsigned char * view(off_t position, size_t & bytes);
+  // WRITE: where the next bytes of the file go, with bytes reduced to the
+  // room mapped there; commit adds bytes written there to the file
+  unsigned char * reserve(size_t & bytes);
+  void commit(size_t bytes);
+  MappedFile(const char * path, Mode mode);
+  ~MappedFile(void);
+};
+#endif  // MAPPEDFILE_H_
@@ -0,0 +1,339 @@
+/*
+ *      MultiStageDecimator.cc - decimate a complex stream by a large factor
+ *                               through a cascade of cheaper stages
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  Only the final stage has to meet the passband and stopband edges asked
+ *  for.  The stages before it just have to keep anything from aliasing into
+ *  the passband, so while the rate is still high their transition bands
+ *  are wide and their filters short:
+ *
+ *    CIC - integrators and combs, no multiplies, for one large first
+ *          factor while the passband is a small part of its output rate
+ *    half-band - decimate by 2 with every other coefficient zero
+ *    FIR - any other factor, the coefficients from a Kaiser window
+ *
+ *  Every way of splitting the decimation into a CIC factor and a sequence
+ *  of filter factors is costed, in operations per input sample, and the
+ *  cheapest kept.
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "CICKernels.h"
+#include "FIRKernels.h"
+#include "HalfBandFilter.h"
+#include "KaiserWindow.h"
+#include "MultiStageDecimator.h"
+#include "Stream.h"
+/* ---------------------------------------------------------------------- */
+//  Integrators and combs on 64 bit fixed point samples, with CFilter's
+//  kernels.  The arithmetic wraps, which leaves the combs' differences
+//  exact however far the integrators run, as long as the stage's gain of
+//  factor^order fits.
+class MultiStageDecimator::CICStage : public Stage {
+ private:
+  int order;
+  double droop;
+  uint64_t integrators[MAX_CIC_ORDER][2];
+  uint64_t combs[MAX_CIC_ORDER][2];    // differential delay 1
+  int combIndex;
+  uint64_t * work;                     // the block in fixed point, I/Q interleaved
+  double inputScale;                   // float to fixed point
+  double outputScale;                  // back to float, less the stage's gain
+
+ public:
+  // each integrator runs over the whole block in turn, then the combs run
+  // on the samples kept, leaving them at the start of work
+  void filter(const float * input, int samples, float * output) {
+    CICKernels::fromFloat(input, samples * 2, inputScale, work);
+    for (int k = 0; k < order; k++) CICKernels::integrate64(work, samples, integrators[k]);
+    int outputs = samples / decimation;
+    CICKernels::comb(work, outputs, decimation, order, 1, &combs[0][0], combIndex, work);
+    CICKernels::toFloat(work, outputs * 2, outputScale, output);
+  }
+  void describe(void) {
+    fprintf(stderr, "  CIC by %d, order %d: %.0f to %.0f S/s, %.2f dB droop at the passband edge\n", decimation,
+            order, rate, rate / decimation, droop);
+  }
+  CICStage(double rate, int factor, int order, double droop, int samples) {
+    this->rate = rate;
+    this->decimation = factor;
+    this->order = order;
+    this->droop = droop;
+    memset(integrators, 0, sizeof(integrators));
+    memset(combs, 0, sizeof(combs));
+    combIndex = 0;
+    work = reinterpret_cast<uint64_t *>(malloc(samples * 2 * sizeof(uint64_t)));
+    int growth = ceil(order * log2(factor));
+    int fraction = 62 - growth;        // leaves room for inputs up to 2.0
+    if (fraction > 24) fraction = 24;
+    inputScale = ldexp(1.0, fraction);
+    outputScale = 1.0 / (inputScale * pow(factor, order));
+  }
+  ~CICStage(void) {
+    free(work);
+  }
+};
+
+/* ---------------------------------------------------------------------- */
+class MultiStageDecimator::HalfBandStage : public Stage {
+ private:
+  HalfBandFilter * halfBand;
+
+ public:
+  void filter(const float * input, int samples, float * output) {
+    halfBand->filter(input, output);
+  }
+  void describe(void) {
+    fprintf(stderr, "  half-band, %d coefficients: %.0f to %.0f S/s\n", halfBand->length(), rate, rate / 2);
+  }
+  HalfBandStage(double rate, int taps, double attenuation, int samples) {
+    this->rate = rate;
+    this->decimation = 2;
+    halfBand = new HalfBandFilter(taps, attenuation, true, samples);
+  }
+  ~HalfBandStage(void) {
+    delete halfBand;
+  }
+};
+
+/* ---------------------------------------------------------------------- */
+//  Any factor: only the outputs kept are computed.
+class MultiStageDecimator::FIRStage : public Stage {
+ private:
+  int taps;
+  int historyFloats;
+  float * pairs;
+  float * work;
+
+ public:
+  void filter(const float * input, int samples, float * output) {
+    memcpy(work + historyFloats, input, samples * 2 * sizeof(float));
+    FIRKernels::decimateSymmetricInterleaved(pairs, taps, work, decimation, output, samples / decimation);
+    memmove(work, work + samples * 2, historyFloats * sizeof(float));
+  }
+  void describe(void) {
+    fprintf(stderr, "  FIR by %d, %d coefficients: %.0f to %.0f S/s\n", decimation, taps, rate, rate / decimation);
+  }
+  FIRStage(double rate, int factor, double cutoff, int taps, double attenuation, int samples) {
+    this->rate = rate;
+    this->decimation = factor;
+    this->taps = taps;
+    float * coefficients = KaiserWindow::lowPass(cutoff, taps, attenuation);
+    pairs = FIRKernels::interleave(coefficients, taps);
+    free(coefficients);
+    historyFloats = (taps - 1) * 2;
+    work = reinterpret_cast<float *>(calloc(historyFloats + samples * 2, sizeof(float)));
+  }
+  ~FIRStage(void) {
+    free(pairs);
+    free(work);
+  }
+};
+
+/* ---------------------------------------------------------------------- */
+MultiStageDecimator::MultiStageDecimator(double inputRate, double outputRate, double passband, double stopband,
+                                         double attenuation) {
+  this->inputRate = inputRate;
+  this->outputRate = outputRate;
+  this->passband = passband;
+  this->stopband = stopband;
+  this->attenuation = attenuation;
+  macs = 0.0;
+  adds = 0.0;
+  planned = plan();
+}
+
+/* ---------------------------------------------------------------------- */
+//  Lowest CIC order whose attenuation where aliases fold into the passband
+//  meets the attenuation asked for, or 0 when none will do.
+int MultiStageDecimator::cicOrder(int factor, double & droop) {
+  double output = inputRate / factor;
+  if (passband >= output / 2.0) return 0;
+  auto gain = [&](double frequency) {
+    double x = M_PI * frequency / inputRate;
+    return fabs(sin(factor * x) / (factor * sin(x)));
+  };
+  double perOrder = -20.0 * log10(gain(output - passband));
+  if (perOrder <= 0.0) return 0;
+  int order = ceil(attenuation / perOrder);
+  if (order > MAX_CIC_ORDER) return 0;
+  if (order * log2(factor) > MAX_CIC_GROWTH) return 0;
+  droop = -20.0 * order * log10(gain(passband));
+  if (droop > MAX_CIC_DROOP) return 0;
+  return order;
+}
+
+/* ---------------------------------------------------------------------- */
+//  A stage before the last only has to stop what would alias into the
+//  passband.  Half-band lengths are rounded up to 4m + 3 so that the end
+//  coefficients are not zero.
+int MultiStageDecimator::intermediateTaps(double rate, int factor) {
+  double transition = (rate / factor - 2.0 * passband) / rate;
+  if (transition <= 0.0) return 0;
+  int taps = KaiserWindow::taps(transition, attenuation);
+  if (factor == 2) return taps / 4 * 4 + 3;
+  return taps | 1;
+}
+
+/* ---------------------------------------------------------------------- */
+int MultiStageDecimator::finalTaps(double rate) {
+  return KaiserWindow::taps((stopband - passband) / rate, attenuation) | 1;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Cheapest way to decimate by the rest of remaining once done of it has
+//  been done, after a CIC stage decimating by before.  Costs are per input
+//  sample of the whole cascade, so a stage's multiplies per output are
+//  divided by the decimation up to its output.
+MultiStageDecimator::Choice MultiStageDecimator::cheapest(int done, int remaining, int before,
+                                                          std::map<int, Choice> & known) {
+  std::map<int, Choice>::iterator found = known.find(done);
+  if (found != known.end()) return found->second;
+  double rate = inputRate / before / done;
+  int left = remaining / done;
+  Choice best;
+  best.cost = HUGE_VAL;
+  int taps = finalTaps(rate);
+  if (taps <= MAX_TAPS) {
+    best.cost = taps / (double) (before * remaining);
+    best.factors.push_back(left);
+  }
+  for (int factor = 2; factor < left; factor++) {
+    if (left % factor) continue;
+    int taps = intermediateTaps(rate, factor);
+    if (taps == 0 || taps > MAX_TAPS) continue;
+    double perOutput = factor == 2 ? (taps + 1) / 4 + 1 : taps;
+    double cost = perOutput / (before * done * factor);
+    Choice rest = cheapest(done * factor, remaining, before, known);
+    if (rest.factors.empty() || cost + rest.cost >= best.cost) continue;
+    best.cost = cost + rest.cost;
+    best.factors.assign(1, factor);
+    best.factors.insert(best.factors.end(), rest.factors.begin(), rest.factors.end());
+  }
+  known[done] = best;
+  return best;
+}
+
+/* ---------------------------------------------------------------------- */
+bool MultiStageDecimator::plan(void) {
+  decimation = lround(inputRate / outputRate);
+  if (decimation < 1 || fabs(decimation * outputRate - inputRate) > 1e-6 * inputRate) {
+    fprintf(stderr, "The input rate must be a whole multiple of the output rate\n");
+    return false;
+  }
+  if (passband <= 0.0 || stopband <= passband || stopband > outputRate - passband) {
+    fprintf(stderr, "The passband edge must be above 0 and below the stopband edge, and the stopband edge at most "
+            "the output rate less the passband edge (%.1f Hz)\n", outputRate - passband);
+    return false;
+  }
+
+  // every CIC factor that will do, then the best filters after it
+  double bestCost = HUGE_VAL;
+  int bestFactor = 0;
+  int bestOrder = 0;
+  double bestDroop = 0.0;
+  Choice bestChoice;
+  for (int factor = 1; factor <= decimation; factor++) {
+    if (decimation % factor) continue;
+    int order = 0;
+    double droop = 0.0;
+    if (factor > 1) {
+      order = cicOrder(factor, droop);
+      if (order == 0) continue;
+    }
+    std::map<int, Choice> known;
+    Choice choice = cheapest(1, decimation / factor, factor, known);
+    if (choice.factors.empty()) continue;
+    double cost = choice.cost;
+    if (factor > 1) cost += CIC_ADD_COST * (order + (double) order / factor) + CIC_CONVERSION_COST;
+    if (cost < bestCost) {
+      bestCost = cost;
+      bestFactor = factor;
+      bestOrder = order;
+      bestDroop = droop;
+      bestChoice = choice;
+    }
+  }
+  if (bestFactor == 0) {
+    fprintf(stderr, "No cascade of filters of up to %d coefficients meets the specification\n", MAX_TAPS);
+    return false;
+  }
+
+  // build it for blocks that decimate to a whole number of outputs
+  int outputs = BLOCK_SAMPLES / decimation;
+  if (outputs < 1) outputs = 1;
+  int samples = outputs * decimation;
+  double rate = inputRate;
+  if (bestFactor > 1) {
+    stages.push_back(new CICStage(rate, bestFactor, bestOrder, bestDroop, samples));
+    adds = bestOrder + (double) bestOrder / bestFactor;
+    rate /= bestFactor;
+    samples /= bestFactor;
+  }
+  int done = bestFactor;
+  for (size_t index = 0; index < bestChoice.factors.size(); index++) {
+    int factor = bestChoice.factors[index];
+    if (index + 1 == bestChoice.factors.size()) {
+      int taps = finalTaps(rate);
+      stages.push_back(new FIRStage(rate, factor, (passband + stopband) / 2.0 / rate, taps, attenuation, samples));
+      macs += taps / (double) (done * factor);
+    } else if (factor == 2) {
+      int taps = intermediateTaps(rate, factor);
+      stages.push_back(new HalfBandStage(rate, taps, attenuation, samples));
+      macs += ((taps + 1) / 4 + 1) / (double) (done * factor);
+    } else {
+      int taps = intermediateTaps(rate, factor);
+      stages.push_back(new FIRStage(rate, factor, 0.5 / factor, taps, attenuation, samples));
+      macs += taps / (double) (done * factor);
+    }
+    rate /= factor;
+    samples /= factor;
+    done *= factor;
+  }
+  fprintf(stderr, "decimating %.0f to %.0f S/s (by %d), passband %.1f Hz, stopband %.1f Hz at %.0f dB:\n",
+          inputRate, outputRate, decimation, passband, stopband, attenuation);
+  for (Stage * stage : stages) stage->describe();
+  fprintf(stderr, "  %.3f multiply accumulates and %.3f adds per input sample\n", macs, adds);
+  return true;
+}
+
+/* ---------------------------------------------------------------------- */
+void MultiStageDecimator::filterSignal(void) {
+  if (!planned) return;
+  int outputs = BLOCK_SAMPLES / decimation;
+  if (outputs < 1) outputs = 1;
+  int samples = outputs * decimation;
+  std::vector<float *> buffers;
+  buffers.push_back(reinterpret_cast<float *>(malloc(samples * 2 * sizeof(float))));
+  int size = samples;
+  for (Stage * stage : stages) {
+    size /= stage->decimation;
+    buffers.push_back(reinterpret_cast<float *>(malloc(size * 2 * sizeof(float))));
+  }
+  for (;;) {
+    if (Stream::input()->read(buffers[0], sizeof(float), samples * 2) != (size_t) samples * 2) {
+      fprintf(stderr, "Short read....\n");
+      Stream::output()->close();
+      break;
+    }
+    int size = samples;
+    for (size_t index = 0; index < stages.size(); index++) {
+      stages[index]->filter(buffers[index], size, buffers[index + 1]);
+      size /= stages[index]->decimation;
+    }
+    Stream::output()->write(buffers.back(), sizeof(float), outputs * 2);
+  }
+  for (float * buffer : buffers) free(buffer);
+}
+
+/* ---------------------------------------------------------------------- */
+MultiStageDecimator::~MultiStageDecimator(void) {
+  for (Stage * stage : stages) delete stage;
+}
@@ -0,0 +1,81 @@
+#ifndef MULTISTAGEDECIMATOR_H_
+#define MULTISTAGEDECIMATOR_H_
+/*
+ *      MultiStageDecimator.h - decimate a complex stream by a large factor
+ *                              through a cascade of cheaper stages.  From
+ *                              the input and output rates, the passband
+ *                              and stopband edges and the attenuation
+ *                              wanted, a CIC stage, half-band stages and
+ *                              FIR stages are chosen for the fewest
+ *                              operations per input sample.
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdint.h>
+#include <map>
+#include <vector>
+/* ---------------------------------------------------------------------- */
+class MultiStageDecimator {
+ private:
+  // One stage of the cascade: filters and decimates blocks of interleaved
+  // I/Q samples, keeping whatever history it needs between blocks
+  class Stage {
+   public:
+    int decimation;
+    double rate;                       // input samples per second
+    virtual void filter(const float * input, int samples, float * output) = 0;
+    virtual void describe(void) = 0;
+    virtual ~Stage(void) {}
+  };
+  class CICStage;
+  class HalfBandStage;
+  class FIRStage;
+
+  // Cheapest way found to finish the decimation from some point on
+  struct Choice {
+    double cost;                       // operations per cascade input sample
+    std::vector<int> factors;          // stage decimations, the last one the final FIR
+  };
+
+  static const int MAX_CIC_ORDER = 6;
+  static const int MAX_CIC_GROWTH = 40;          // bits of gain the integrators may need
+  static constexpr double MAX_CIC_DROOP = 0.5;   // dB at the passband edge
+  // CIC costs in vectorized multiply accumulates, as timed with CICKernels on
+  // x86: each integrator pass over an I/Q pair, and taking the pair into
+  // fixed point and back, which has no vector conversion to 64 bits
+  static constexpr double CIC_ADD_COST = 3.3;
+  static constexpr double CIC_CONVERSION_COST = 12.0;
+  static const int MAX_TAPS = 1 << 14;            // longest filter considered for a stage
+  static const int BLOCK_SAMPLES = 1 << 16;      // input samples per block, rounded to a whole output
+
+  double inputRate;
+  double outputRate;
+  double passband;                     // edges in Hz from the center
+  double stopband;
+  double attenuation;                  // dB in the stopband and for aliases into the passband
+  int decimation;
+  bool planned;
+  std::vector<Stage *> stages;
+  double macs;                         // multiply accumulates per input sample
+  double adds;                         // CIC additions per input sample
+
+  int cicOrder(int factor, double & droop);
+  int intermediateTaps(double rate, int factor);
+  int finalTaps(double rate);
+  Choice cheapest(int done, int remaining, int before, std::map<int, Choice> & known);
+  bool plan(void);
+
+ public:
+  bool valid(void) { return planned; }
+  void filterSignal(void);
+
+  // rates in samples per second, passband and stopband edges in Hz,
+  // attenuation in dB
+  MultiStageDecimator(double inputRate, double outputRate, double passband, double stopband, double attenuation);
+  ~MultiStageDecimator(void);
+};
+#endif  // MULTISTAGEDECIMATOR_H_
@@ -0,0 +1,303 @@
+/*
+ *      NCO.cc - numerically controlled oscillator
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  Stepping one rotator sample by sample is a chain of dependent complex
+ *  multiplies.  Instead LANES rotators start one step apart and each
+ *  advances LANES steps at a time, so a group of LANES samples is mixed
+ *  with independent multiplies.  Rounding makes rotators drift in
+ *  amplitude and phase, so they are set again from the phase accumulator,
+ *  exactly, at the start of every call and every RENORMALIZE samples -
+ *  the accumulator itself is exact, so there is nothing to jump at a
+ *  block boundary.
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(__SSE__)
+#include <emmintrin.h>
+#define NCO_SSE
+#endif
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define NCO_NEON
+#endif
+#include "NCO.h"
+/* ---------------------------------------------------------------------- */
+namespace {
+
+const double TWO_TO_64 = 18446744073709551616.0;
+
+double radians(uint64_t phase) {
+  return 2.0 * M_PI * (phase / TWO_TO_64);
+}
+
+//  cos, sin pairs for 2^bits + 1 phases, built once for all stages
+const float * cosSinTable(int bits) {
+  static const float * table = [bits] {
+    int size = 1 << bits;
+    float * entries = reinterpret_cast<float *>(malloc((size + 1) * 2 * sizeof(float)));
+    for (int i = 0; i <= size; i++) {
+      entries[2 * i] = cos(2.0 * M_PI * i / size);
+      entries[2 * i + 1] = sin(2.0 * M_PI * i / size);
+    }
+    return entries;
+  }();
+  return table;
+}
+
+//  A phase step of any size or sign, in 2^-40 cycles: finer than any
+//  deviation needs, and a truncation instead of a floor per sample.
+inline uint64_t deviationStep(double cycles) {
+  return static_cast<uint64_t>(static_cast<int64_t>(cycles * 1099511627776.0)) << 24;
+}
+
+//  cos and sin of turns * 2^-32 cycles, as I/Q pairs.  The nearest
+//  quarter turn q is taken off, the polynomials cover the remaining
+//  +/-1/8 turn to 3e-7, and q swaps and negates them.
+const float S3 = -1.0f / 6.0f;
+const float S5 = 1.0f / 120.0f;
+const float S7 = -1.0f / 5040.0f;
+const float C2 = -1.0f / 2.0f;
+const float C4 = 1.0f / 24.0f;
+const float C6 = -1.0f / 720.0f;
+const float C8 = 1.0f / 40320.0f;
+const float RADIANS = 2.0 * M_PI / 4294967296.0;  // per 2^-32 cycle
+
+void cosSinTurns(const int32_t * turns, float * output, int count) {
+  int n = 0;
+#if defined(NCO_SSE) && defined(__SSE2__)
+  for (; n + 4 <= count; n += 4) {
+    __m128i t = _mm_loadu_si128(reinterpret_cast<const __m128i *>(turns + n));
+    __m128i q = _mm_srai_epi32(_mm_add_epi32(t, _mm_set1_epi32(1 << 29)), 30);
+    __m128 x = _mm_mul_ps(_mm_cvtepi32_ps(_mm_sub_epi32(t, _mm_slli_epi32(q, 30))), _mm_set1_ps(RADIANS));
+    __m128 x2 = _mm_mul_ps(x, x);
+    __m128 sine = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(S7), x2), _mm_set1_ps(S5));
+    sine = _mm_add_ps(_mm_mul_ps(sine, x2), _mm_set1_ps(S3));
+    sine = _mm_add_ps(_mm_mul_ps(_mm_mul_ps(sine, x2), x), x);
+    __m128 cosine = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(C8), x2), _mm_set1_ps(C6));
+    cosine = _mm_add_ps(_mm_mul_ps(cosine, x2), _mm_set1_ps(C4));
+    cosine = _mm_add_ps(_mm_mul_ps(cosine, x2), _mm_set1_ps(C2));
+    cosine = _mm_add_ps(_mm_mul_ps(cosine, x2), _mm_set1_ps(1.0f));
+    __m128 swap = _mm_castsi128_ps(_mm_cmpeq_epi32(_mm_and_si128(q, _mm_set1_epi32(1)), _mm_set1_epi32(1)));
+    __m128 c = _mm_or_ps(_mm_and_ps(swap, sine), _mm_andnot_ps(swap, cosine));
+    __m128 s = _mm_or_ps(_mm_and_ps(swap, cosine), _mm_andnot_ps(swap, sine));
+    __m128i two = _mm_set1_epi32(2);
+    c = _mm_xor_ps(c, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(_mm_add_epi32(q, _mm_set1_epi32(1)), two), 30)));
+    s = _mm_xor_ps(s, _mm_castsi128_ps(_mm_slli_epi32(_mm_and_si128(q, two), 30)));
+    _mm_storeu_ps(output + 2 * n, _mm_unpacklo_ps(c, s));
+    _mm_storeu_ps(output + 2 * n + 4, _mm_unpackhi_ps(c, s));
+  }
+#elif defined(NCO_NEON)
+  for (; n + 4 <= count; n += 4) {
+    int32x4_t t = vld1q_s32(turns + n);
+    int32x4_t q = vshrq_n_s32(vaddq_s32(t, vdupq_n_s32(1 << 29)), 30);
+    float32x4_t x = vmulq_n_f32(vcvtq_f32_s32(vsubq_s32(t, vshlq_n_s32(q, 30))), RADIANS);
+    float32x4_t x2 = vmulq_f32(x, x);
+    float32x4_t sine = vmlaq_f32(vdupq_n_f32(S5), vdupq_n_f32(S7), x2);
+    sine = vmlaq_f32(vdupq_n_f32(S3), sine, x2);
+    sine = vmlaq_f32(x, vmulq_f32(sine, x2), x);
+    float32x4_t cosine = vmlaq_f32(vdupq_n_f32(C6), vdupq_n_f32(C8), x2);
+    cosine = vmlaq_f32(vdupq_n_f32(C4), cosine, x2);
+    cosine = vmlaq_f32(vdupq_n_f32(C2), cosine, x2);
+    cosine = vmlaq_f32(vdupq_n_f32(1.0f), cosine, x2);
+    uint32x4_t swap = vtstq_s32(q, vdupq_n_s32(1));
+    uint32x4_t cosSign = vshlq_n_u32(vandq_u32(vreinterpretq_u32_s32(vaddq_s32(q, vdupq_n_s32(1))), vdupq_n_u32(2)), 30);
+    uint32x4_t sinSign = vshlq_n_u32(vandq_u32(vreinterpretq_u32_s32(q), vdupq_n_u32(2)), 30);
+    float32x4x2_t pairs;
+    pairs.val[0] = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, sine, cosine)), cosSign));
+    pairs.val[1] = vreinterpretq_f32_u32(veorq_u32(vreinterpretq_u32_f32(vbslq_f32(swap, cosine, sine)), sinSign));
+    vst2q_f32(output + 2 * n, pairs);
+  }
+#endif
+  for (; n < count; n++) {
+    uint32_t t = turns[n];
+    int32_t q = static_cast<int32_t>(t + (1u << 29)) >> 30;
+    float x = static_cast<int32_t>(t - (static_cast<uint32_t>(q) << 30)) * RADIANS;
+    float x2 = x * x;
+    float sine = ((S7 * x2 + S5) * x2 + S3) * x2 * x + x;
+    float cosine = (((C8 * x2 + C6) * x2 + C4) * x2 + C2) * x2 + 1.0f;
+    float c = q & 1 ? sine : cosine;
+    float s = q & 1 ? cosine : sine;
+    output[2 * n] = (q + 1) & 2 ? -c : c;
+    output[2 * n + 1] = q & 2 ? -s : s;
+  }
+}
+
+}  // namespace
+
+/* ---------------------------------------------------------------------- */
+NCO::NCO(double cyclesPerSample) {
+  phase = 0;
+  step = cycles(cyclesPerSample);
+  const char * mode = getenv("DSPP_NCO");
+  table = mode && strcmp(mode, "table") == 0;
+  cosLanes = cos(radians(step * LANES));
+  sinLanes = sin(radians(step * LANES));
+  if (table) cosSinTable(TABLE_BITS);
+}
+
+/* ---------------------------------------------------------------------- */
+//  Cycles, of any size or sign, to a phase increment.
+uint64_t NCO::cycles(double cyclesPerSample) {
+  double fraction = cyclesPerSample - floor(cyclesPerSample);
+  double scaled = fraction * TWO_TO_64;
+  return scaled >= TWO_TO_64 ? 0 : static_cast<uint64_t>(scaled);
+}
+
+/* ---------------------------------------------------------------------- */
+void NCO::cosSin(uint64_t phase, float & cosine, float & sine) {
+  const float * entry = cosSinTable(TABLE_BITS) + 2 * (phase >> (64 - TABLE_BITS));
+  float fraction = ((phase << TABLE_BITS) >> 40) * (1.0f / (1 << 24));
+  cosine = entry[0] + fraction * (entry[2] - entry[0]);
+  sine = entry[1] + fraction * (entry[3] - entry[1]);
+}
+
+/* ---------------------------------------------------------------------- */
+void NCO::reset(void) {
+  for (int k = 0; k < LANES; k++) {
+    double angle = radians(phase + k * step);
+    cosines[k] = cos(angle);
+    sines[k] = sin(angle);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void NCO::shift(const float * input, float * output, int pairs) {
+  if (table) {
+    mixTable(input, output, pairs);
+    return;
+  }
+  while (pairs > 0) {
+    int chunk = pairs < RENORMALIZE ? pairs : RENORMALIZE;
+    reset();
+    mixRotators(input, output, chunk);
+    phase += chunk * step;
+    input += 2 * chunk;
+    output += 2 * chunk;
+    pairs -= chunk;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+//  I' = I cos + Q sin and Q' = Q cos - I sin.  The vector versions keep
+//  each rotator's cosine twice, for I and Q, and its sine as +sin, -sin,
+//  so a pair is mixed with two multiplies, a swap and an add.
+void NCO::mixRotators(const float * input, float * output, int pairs) {
+  int n = 0;
+#if defined(NCO_SSE)
+  __m128 cosineVectors[LANES / 2];
+  __m128 sineVectors[LANES / 2];
+  for (int r = 0; r < LANES / 2; r++) {
+    cosineVectors[r] = _mm_setr_ps(cosines[2 * r], cosines[2 * r], cosines[2 * r + 1], cosines[2 * r + 1]);
+    sineVectors[r] = _mm_setr_ps(sines[2 * r], -sines[2 * r], sines[2 * r + 1], -sines[2 * r + 1]);
+  }
+  const __m128 cosTurn = _mm_set1_ps(cosLanes);
+  const __m128 sinTurn = _mm_setr_ps(sinLanes, -sinLanes, sinLanes, -sinLanes);
+  for (; n + LANES <= pairs; n += LANES) {
+    for (int r = 0; r < LANES / 2; r++) {
+      __m128 x = _mm_loadu_ps(input + 2 * n + 4 * r);
+      __m128 swapped = _mm_shuffle_ps(x, x, _MM_SHUFFLE(2, 3, 0, 1));
+      _mm_storeu_ps(output + 2 * n + 4 * r,
+                    _mm_add_ps(_mm_mul_ps(x, cosineVectors[r]), _mm_mul_ps(swapped, sineVectors[r])));
+      __m128 cosine = _mm_sub_ps(_mm_mul_ps(cosineVectors[r], cosTurn), _mm_mul_ps(sineVectors[r], sinTurn));
+      sineVectors[r] = _mm_add_ps(_mm_mul_ps(sineVectors[r], cosTurn), _mm_mul_ps(cosineVectors[r], sinTurn));
+      cosineVectors[r] = cosine;
+    }
+  }
+  for (int r = 0; r < LANES / 2; r++) {
+    float c[4];
+    float s[4];
+    _mm_storeu_ps(c, cosineVectors[r]);
+    _mm_storeu_ps(s, sineVectors[r]);
+    cosines[2 * r] = c[0];
+    cosines[2 * r + 1] = c[2];
+    sines[2 * r] = s[0];
+    sines[2 * r + 1] = s[2];
+  }
+#elif defined(NCO_NEON)
+  float32x4_t cosineVectors[LANES / 2];
+  float32x4_t sineVectors[LANES / 2];
+  for (int r = 0; r < LANES / 2; r++) {
+    float c[4] = { cosines[2 * r], cosines[2 * r], cosines[2 * r + 1], cosines[2 * r + 1] };
+    float s[4] = { sines[2 * r], -sines[2 * r], sines[2 * r + 1], -sines[2 * r + 1] };
+    cosineVectors[r] = vld1q_f32(c);
+    sineVectors[r] = vld1q_f32(s);
+  }
+  const float turn[4] = { sinLanes, -sinLanes, sinLanes, -sinLanes };
+  const float32x4_t sinTurn = vld1q_f32(turn);
+  for (; n + LANES <= pairs; n += LANES) {
+    for (int r = 0; r < LANES / 2; r++) {
+      float32x4_t x = vld1q_f32(input + 2 * n + 4 * r);
+      vst1q_f32(output + 2 * n + 4 * r, vmlaq_f32(vmulq_f32(x, cosineVectors[r]), vrev64q_f32(x), sineVectors[r]));
+      float32x4_t cosine = vmlsq_f32(vmulq_n_f32(cosineVectors[r], cosLanes), sineVectors[r], sinTurn);
+      sineVectors[r] = vmlaq_f32(vmulq_n_f32(sineVectors[r], cosLanes), cosineVectors[r], sinTurn);
+      cosineVectors[r] = cosine;
+    }
+  }
+  for (int r = 0; r < LANES / 2; r++) {
+    cosines[2 * r] = vgetq_lane_f32(cosineVectors[r], 0);
+    cosines[2 * r + 1] = vgetq_lane_f32(cosineVectors[r], 2);
+    sines[2 * r] = vgetq_lane_f32(sineVectors[r], 0);
+    sines[2 * r + 1] = vgetq_lane_f32(sineVectors[r], 2);
+  }
+#else
+  for (; n + LANES <= pairs; n += LANES) {
+    for (int k = 0; k < LANES; k++) {
+      float I = input[2 * (n + k)];
+      float Q = input[2 * (n + k) + 1];
+      output[2 * (n + k)] = I * cosines[k] + Q * sines[k];
+      output[2 * (n + k) + 1] = Q * cosines[k] - I * sines[k];
+      float cosine = cosines[k] * cosLanes - sines[k] * sinLanes;
+      sines[k] = sines[k] * cosLanes + cosines[k] * sinLanes;
+      cosines[k] = cosine;
+    }
+  }
+#endif
+  // the last few pairs take the rotators as they are; the next call resets them
+  for (int k = 0; n < pairs; n++, k++) {
+    float I = input[2 * n];
+    float Q = input[2 * n + 1];
+    output[2 * n] = I * cosines[k] + Q * sines[k];
+    output[2 * n + 1] = Q * cosines[k] - I * sines[k];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void NCO::mixTable(const float * input, float * output, int pairs) {
+  for (int n = 0; n < pairs; n++) {
+    float cosine;
+    float sine;
+    cosSin(phase, cosine, sine);
+    float I = input[2 * n];
+    float Q = input[2 * n + 1];
+    output[2 * n] = I * cosine + Q * sine;
+    output[2 * n + 1] = Q * cosine - I * sine;
+    phase += step;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void NCO::modulate(const float * deviation, double scale, float * output, int count) {
+  int32_t turns[CHUNK];
+  for (int start = 0; start < count; start += CHUNK) {
+    int n = count - start < CHUNK ? count - start : CHUNK;
+    float * pairs = output + 2 * start;
+    if (table) {
+      for (int k = 0; k < n; k++) {
+        phase += step + deviationStep(scale * deviation[start + k]);
+        cosSin(phase, pairs[2 * k], pairs[2 * k + 1]);
+      }
+    } else {
+      for (int k = 0; k < n; k++) {
+        phase += step + deviationStep(scale * deviation[start + k]);
+        turns[k] = static_cast<int32_t>(phase >> 32);
+      }
+      cosSinTurns(turns, pairs, n);
+    }
+  }
+}
@@ -0,0 +1,52 @@
+#ifndef NCO_H_
+#define NCO_H_
+/*
+ *      NCO.h - numerically controlled oscillator.  The phase is a 64 bit
+ *              accumulator in units of 2^-64 cycles, so it never drifts;
+ *              the cosines and sines come either from rotators, one per
+ *              vector lane, reset from the accumulator every few thousand
+ *              samples, or from a table (DSPP_NCO=table).
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdint.h>
+/* ---------------------------------------------------------------------- */
+class NCO {
+ private:
+  static const int LANES = 8;                // rotators stepped together
+  static const int RENORMALIZE = 2048;       // most samples between resets of the rotators
+  static const int TABLE_BITS = 12;          // table entries, as a power of 2
+  static const int CHUNK = 256;              // samples modulated between phase and cos/sin passes
+  uint64_t phase;                            // of the next sample
+  uint64_t step;                             // per sample
+  bool table;
+  float cosines[LANES];                      // rotator k at phase + k * step
+  float sines[LANES];
+  float cosLanes;                            // one turn of all the rotators, LANES * step
+  float sinLanes;
+
+  void reset(void);
+  void mixRotators(const float * input, float * output, int pairs);
+  void mixTable(const float * input, float * output, int pairs);
+
+ public:
+  static uint64_t cycles(double cyclesPerSample);
+  // cos and sin of phase, from a table of 2^TABLE_BITS entries with
+  // linear interpolation - within 3e-7
+  static void cosSin(uint64_t phase, float & cosine, float & sine);
+  bool tableDriven(void) { return table; }
+  // shift pairs I/Q pairs down by the NCO frequency: each is multiplied by
+  // e^(-j phase), and the phase advanced; input and output may be the same
+  void shift(const float * input, float * output, int pairs);
+  // frequency modulation: before each output the phase advances by the
+  // NCO frequency plus scale * deviation[n] cycles, and output n is
+  // e^(j phase), from polynomials a vector at a time, or the table
+  void modulate(const float * deviation, double scale, float * output, int count);
+
+  NCO(double cyclesPerSample);
+};
+#endif  // NCO_H_
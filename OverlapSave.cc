@@ -0,0 +1,110 @@
+/*
+ *      OverlapSave.cc - FIR filtering by fast convolution
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  The FIR filters compute output k as the sum of coefficient j times
+ *  sample k + j, which is a convolution with the coefficients reversed.
+ *  With the reversed coefficients zero padded to the transform size, point
+ *  taps - 1 + k of the circular convolution is output k, and none of the
+ *  points from taps - 1 on wrap around, so one transform serves a block of
+ *  up to fftSize - taps + 1 outputs.
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "OverlapSave.h"
+/* ---------------------------------------------------------------------- */
+OverlapSave::OverlapSave(const float * coefficients, int taps, int inputs, int decimation, bool complexSignal) {
+  this->taps = taps;
+  this->inputs = inputs;
+  this->decimation = decimation;
+  this->complexSignal = complexSignal;
+  fftSize = goodSize(inputs + taps - 1);
+  bins = complexSignal ? fftSize : fftSize / 2 + 1;
+  response = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * bins);
+  spectrum = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * bins);
+  signal = 0;
+  realSignal = 0;
+  if (complexSignal) {
+    signal = (fftw_complex *) fftw_malloc(sizeof(fftw_complex) * fftSize);
+    forward = fftw_plan_dft_1d(fftSize, signal, spectrum, FFTW_FORWARD, FFTW_ESTIMATE);
+    inverse = fftw_plan_dft_1d(fftSize, spectrum, signal, FFTW_BACKWARD, FFTW_ESTIMATE);
+    memset(signal, 0, sizeof(fftw_complex) * fftSize);
+    for (int n = 0; n < taps; n++) signal[n][0] = coefficients[taps - 1 - n] / fftSize;
+  } else {
+    realSignal = (double *) fftw_malloc(sizeof(double) * fftSize);
+    forward = fftw_plan_dft_r2c_1d(fftSize, realSignal, spectrum, FFTW_ESTIMATE);
+    inverse = fftw_plan_dft_c2r_1d(fftSize, spectrum, realSignal, FFTW_ESTIMATE);
+    memset(realSignal, 0, sizeof(double) * fftSize);
+    for (int n = 0; n < taps; n++) realSignal[n] = coefficients[taps - 1 - n] / fftSize;
+  }
+  fftw_execute(forward);
+  memcpy(response, spectrum, sizeof(fftw_complex) * bins);
+  fprintf(stderr, "overlap-save filter of %d coefficients, transform size %d for %d samples per block\n",
+          taps, fftSize, inputs);
+}
+
+/* ---------------------------------------------------------------------- */
+//  FFTW is fastest for sizes with only small prime factors.
+int OverlapSave::goodSize(int minimum) {
+  for (int size = minimum; ; size++) {
+    int rest = size;
+    while (rest % 2 == 0) rest /= 2;
+    while (rest % 3 == 0) rest /= 3;
+    while (rest % 5 == 0) rest /= 5;
+    if (rest == 1) return size;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void OverlapSave::filter(const float * samples, float * output) {
+  int used = inputs + taps - 1;
+  int outputs = inputs / decimation;
+  if (complexSignal) {
+    for (int n = 0; n < used; n++) {
+      signal[n][0] = samples[2 * n];
+      signal[n][1] = samples[2 * n + 1];
+    }
+  } else {
+    for (int n = 0; n < used; n++) realSignal[n] = samples[n];
+  }
+  // the inverse leaves unused results past the samples, so the zero
+  // padding is put back every block
+  if (complexSignal) {
+    memset(signal + used, 0, sizeof(fftw_complex) * (fftSize - used));
+  } else {
+    memset(realSignal + used, 0, sizeof(double) * (fftSize - used));
+  }
+  fftw_execute(forward);
+  for (int k = 0; k < bins; k++) {
+    double re = spectrum[k][0] * response[k][0] - spectrum[k][1] * response[k][1];
+    double im = spectrum[k][0] * response[k][1] + spectrum[k][1] * response[k][0];
+    spectrum[k][0] = re;
+    spectrum[k][1] = im;
+  }
+  fftw_execute(inverse);
+  if (complexSignal) {
+    const fftw_complex * result = signal + taps - 1;
+    for (int k = 0; k < outputs; k++) {
+      *output++ = result[k * decimation][0];
+      *output++ = result[k * decimation][1];
+    }
+  } else {
+    const double * result = realSignal + taps - 1;
+    for (int k = 0; k < outputs; k++) *output++ = result[k * decimation];
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+OverlapSave::~OverlapSave(void) {
+  fftw_destroy_plan(forward);
+  fftw_destroy_plan(inverse);
+  fftw_free(response);
+  fftw_free(spectrum);
+  if (signal) fftw_free(signal);
+  if (realSignal) fftw_free(realSignal);
+}
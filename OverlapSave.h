@@ -0,0 +1,46 @@
+#ifndef OVERLAPSAVE_H_
+#define OVERLAPSAVE_H_
+/*
+ *      OverlapSave.h - FIR filtering by fast convolution.  Each block of
+ *                      input, with the history the filter needs in front
+ *                      of it, is transformed, multiplied by the transform
+ *                      of the coefficients and transformed back, which costs
+ *                      about the same per sample whatever the number of
+ *                      coefficients.
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <fftw3.h>
+/* ---------------------------------------------------------------------- */
+class OverlapSave {
+ private:
+  int taps;                    // number of filter coefficients
+  int inputs;                  // new samples per block
+  int decimation;              // keep 1 out of decimation outputs
+  bool complexSignal;          // interleaved I/Q, else real
+  int fftSize;
+  int bins;                    // frequency domain points
+  fftw_complex * response;     // transform of the coefficients, scaled for the inverse
+  fftw_complex * spectrum;
+  fftw_complex * signal;       // complex time domain work area
+  double * realSignal;         // real time domain work area
+  fftw_plan forward;
+  fftw_plan inverse;
+
+  static int goodSize(int minimum);
+
+ public:
+  int size(void) { return fftSize; }
+  // samples holds the taps - 1 samples of history followed by the inputs
+  // new ones, and inputs / decimation outputs are written - exactly what
+  // FIRKernels::decimate or decimateInterleaved would compute
+  void filter(const float * samples, float * output);
+
+  OverlapSave(const float * coefficients, int taps, int inputs, int decimation, bool complexSignal);
+  ~OverlapSave(void);
+};
+#endif  // OVERLAPSAVE_H_
@@ -0,0 +1,168 @@
+/*
+ *      Pipeline.cc - run a chain of dspp commands inside one process
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdio.h>
+#include <chrono>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+#include "Pipeline.h"
+/* ---------------------------------------------------------------------- */
+Pipeline::Pipeline(const char * programName, const char * description) {
+  pinStages = false;
+  reportInterval = 0;
+  finished = false;
+  parse(description);
+  // argv vectors point into the token strings, so build them only after
+  // every stage is in place
+  for (auto & stage : stages) {
+    stage.tokens.insert(stage.tokens.begin(), programName);
+    for (auto & token : stage.tokens) {
+      stage.argv.push_back(const_cast<char *>(token.c_str()));
+    }
+    stage.argv.push_back(0);
+  }
+  for (size_t index = 1; index < stages.size(); index++) {
+    links.push_back(new RingBuffer(LINK_SIZE));
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+//  Split the description into stages at '|' and each stage into words at
+//  white space.  Single or double quotes group words so that a stage such as
+//  tee can be handed a complete shell command.
+void Pipeline::parse(const char * description) {
+  Stage stage;
+  std::string token;
+  bool inToken = false;
+  char quote = 0;
+  for (const char * c = description; ; c++) {
+    if (*c && quote) {
+      if (*c == quote) {
+        quote = 0;
+      } else {
+        token += *c;
+      }
+    } else if (*c == '"' || *c == '\'') {
+      quote = *c;
+      inToken = true;
+    } else if (*c == 0 || *c == ' ' || *c == '\t' || *c == '\n' || *c == '|') {
+      if (inToken) {
+        stage.tokens.push_back(token);
+        token.clear();
+        inToken = false;
+      }
+      if (*c == 0 || *c == '|') {
+        if (stage.tokens.size() > 0) {
+          stages.push_back(stage);
+          stage.tokens.clear();
+        } else {
+          fprintf(stderr, "empty stage in pipeline description\n");
+        }
+      }
+      if (*c == 0) break;
+    } else {
+      token += *c;
+      inToken = true;
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void Pipeline::runStage(int index, StageRunner runner) {
+  int last = stages.size() - 1;
+  Stream * input = (index == 0) ? Stream::standardInput() : links[index - 1]->reader();
+  Stream * output = (index == last) ? Stream::standardOutput() : links[index]->writer();
+  Stream::bind(input, output);
+  runner(stages[index].argv.size() - 1, stages[index].argv.data());
+  // stages that simply return still need to signal end of stream downstream
+  // and release anything waiting to hand them more data
+  output->close();
+  input->close();
+}
+
+/* ---------------------------------------------------------------------- */
+//  Report how full each link has ever been.  A link that reaches its capacity
+//  has a writer that is faster than its reader, so the stage after the first
+//  full link in the chain is the one holding the pipeline back.
+void Pipeline::report(void) {
+  for (size_t index = 0; index < links.size(); index++) {
+    RingBuffer * link = links[index];
+    fprintf(stderr, "link %zu, %s -> %s: high water %zu of %zu bytes (%zu%%), writer waited %zu times, reader waited %zu times\n",
+            index + 1, stageName(index), stageName(index + 1), link->highWater(), link->size(),
+            link->highWater() * 100 / link->size(), link->writerWaits(), link->readerWaits());
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void Pipeline::monitor(void) {
+  const int tick = 100;  // milliseconds between checks for the end of the chain
+  int elapsed = 0;
+  while (!finished) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(tick));
+    elapsed += tick;
+    if (elapsed >= reportInterval * 1000) {
+      report();
+      elapsed = 0;
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+int Pipeline::run(StageRunner runner) {
+  std::vector<std::thread> threads;
+  fprintf(stderr, "starting %zu stage pipeline\n", stages.size());
+  unsigned int cores = std::thread::hardware_concurrency();
+  for (size_t index = 0; index < stages.size(); index++) {
+    threads.push_back(std::thread(&Pipeline::runStage, this, index, runner));
+    if (pinStages && cores > 1) {
+#ifdef __linux__
+      // round robin, so a chain longer than the core count shares cores
+      cpu_set_t cpus;
+      CPU_ZERO(&cpus);
+      CPU_SET(index % cores, &cpus);
+      if (pthread_setaffinity_np(threads.back().native_handle(), sizeof(cpus), &cpus)) {
+        fprintf(stderr, "could not pin stage %zu, %s, to core %zu\n", index + 1, stageName(index), index % cores);
+      }
+#else
+      if (index == 0) fprintf(stderr, "pinning stages to cores is not supported on this system\n");
+#endif
+    }
+  }
+  std::thread monitorThread;
+  if (reportInterval > 0 && links.size() > 0) {
+    monitorThread = std::thread(&Pipeline::monitor, this);
+  }
+  // The pipeline is finished when its last stage is.  Earlier stages may be
+  // blocked on a live source that never ends, which is the case a shell
+  // pipeline handles with SIGPIPE, so they are left to process exit.  A
+  // stage that has closed its output is only returning, so it is waited for
+  // to let it finish what it reports.
+  threads.back().join();
+  threads.pop_back();
+  for (size_t index = 0; index < threads.size(); index++) {
+    if (links[index]->writerClosed()) {
+      threads[index].join();
+    } else {
+      threads[index].detach();
+    }
+  }
+  finished = true;
+  if (monitorThread.joinable()) monitorThread.join();
+  report();
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+Pipeline::~Pipeline(void) {
+  // links are intentionally not released - detached stages may still be
+  // using them until the process exits
+}
@@ -0,0 +1,46 @@
+#ifndef PIPELINE_H_
+#define PIPELINE_H_
+/*
+ *      Pipeline.h - run a chain of dspp commands inside one process.  Each
+ *                   stage runs on its own thread, optionally pinned to its
+ *                   own core, and is linked to the next stage by a lock free
+ *                   ring instead of a kernel pipe.
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <atomic>
+#include <string>
+#include <vector>
+#include "RingBuffer.h"
+/* ---------------------------------------------------------------------- */
+class Pipeline {
+ public:
+  typedef int (*StageRunner)(int argc, char * argv[]);
+
+ private:
+  static const size_t LINK_SIZE = 1 << 20;  // bytes buffered between two stages
+  struct Stage { std::vector<std::string> tokens; std::vector<char *> argv; };
+  std::vector<Stage> stages;
+  std::vector<RingBuffer *> links;
+  bool pinStages;
+  int reportInterval;
+  std::atomic<bool> finished;
+  void parse(const char * description);
+  void runStage(int index, StageRunner runner);
+  void monitor(void);
+
+ public:
+  int numberOfStages(void) { return stages.size(); }
+  const char * stageName(int index) { return stages[index].argv[1]; }
+  void pinToCores(bool pin) { pinStages = pin; }
+  void reportEvery(int seconds) { reportInterval = seconds; }
+  void report(void);
+  int run(StageRunner runner);
+  Pipeline(const char * programName, const char * description);
+  ~Pipeline(void);
+};
+#endif  // PIPELINE_H_
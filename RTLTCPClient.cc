@@ -17,6 +17,7 @@
 #include <string.h>
 #include <arpa/inet.h>
 #include "RTLTCPClient.h"
+#include "Stream.h"
 
 /* ---------------------------------------------------------------------- */
 RTLTCPClient::RTLTCPClient(const char * address, int port) {
@@ -127,7 +128,7 @@ void RTLTCPClient::doWork(const char * address, int port, int frequency, int sam
     }
     fprintf(stderr, "\n");
     */
-    fwrite(buffer, sizeof(char), count, stdout);
+    Stream::output()->write(buffer, sizeof(char), count);
   }  
 }
 
@@ -17,6 +17,7 @@
 #include <string.h>
 #include <arpa/inet.h>
 #include "RTLTCPServer.h"
+#include "Stream.h"
 
 /* ---------------------------------------------------------------------- */
 RTLTCPServer::RTLTCPServer(const char * address, int port) {
@@ -54,7 +55,7 @@ void RTLTCPServer::doWork(const char * address, int port) {
   bool done = false;
   int count = 0;
   while (!done) {
-    count = fread(&buffer, sizeof(float), BUFFER_SIZE, stdin);
+    count = Stream::input()->read(&buffer, sizeof(float), BUFFER_SIZE);
     if (count < BUFFER_SIZE) {
       fprintf(stderr, "Short data stream, RTLTCPServer\n");
       done = true;
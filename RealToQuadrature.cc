@@ -8,73 +8,103 @@
 
 /* ---------------------------------------------------------------------- */
 #include <cstring>
+#include <math.h>
+#include "KaiserWindow.h"
 #include "RealToQuadrature.h"
+#include "Stream.h"
 /* ---------------------------------------------------------------------- */
 RealToQuadrature::RealToQuadrature(int size){
   numberOfSamples = size;
   rawSignal = (float *) malloc(sizeof(float)*numberOfSamples);
   outSignal = (float *) malloc(sizeof(float)*numberOfSamples*8);
-  signal = (fftw_complex *) fftw_malloc(sizeof(fftw_complex)*numberOfSamples);
-  signalInFreqDomain = (fftw_complex *) fftw_malloc(sizeof(fftw_complex)*numberOfSamples);
-  hilbertOfRaw = (fftw_complex *) fftw_malloc(sizeof(fftw_complex)*numberOfSamples);
-  signalInQuadrature = (fftw_complex *) fftw_malloc(sizeof(fftw_complex)*numberOfSamples);
-  plan = fftw_plan_dft_1d(numberOfSamples, signal, signalInFreqDomain, FFTW_FORWARD, FFTW_ESTIMATE);
-  iplan = fftw_plan_dft_1d(numberOfSamples, signalInFreqDomain, hilbertOfRaw, FFTW_BACKWARD,
-                           FFTW_ESTIMATE);
+  // the Hilbert filter: 2 / (pi m) at odd offsets m from the center, Kaiser
+  // windowed; the taps are rounded up so a block is a multiple of 4, which
+  // keeps the quarter rate shift in step from block to block
+  hilbertTaps = KaiserWindow::taps(TRANSITION, ATTENUATION) | 1;
+  while (hilbertTaps % 4 != 1) hilbertTaps += 2;
+  blockSize = FFT_SIZE - (hilbertTaps - 1);
+  float * window = KaiserWindow::window(hilbertTaps, ATTENUATION);
+  history = (float *) fftwf_malloc(sizeof(float)*FFT_SIZE);
+  hilbertOfRaw = (float *) fftwf_malloc(sizeof(float)*FFT_SIZE);
+  response = (fftwf_complex *) fftwf_malloc(sizeof(fftwf_complex)*(FFT_SIZE/2 + 1));
+  signalInFreqDomain = (fftwf_complex *) fftwf_malloc(sizeof(fftwf_complex)*(FFT_SIZE/2 + 1));
+  plan = fftwf_plan_dft_r2c_1d(FFT_SIZE, history, signalInFreqDomain, FFTW_ESTIMATE);
+  iplan = fftwf_plan_dft_c2r_1d(FFT_SIZE, signalInFreqDomain, hilbertOfRaw, FFTW_ESTIMATE);
+  memset(history, 0, sizeof(float)*FFT_SIZE);
+  const int center = (hilbertTaps - 1) / 2;
+  for (int index = 0; index < hilbertTaps; index++) {
+    int offset = index - center;
+    if (offset % 2) history[index] = 2.0 / (M_PI * offset) * window[index];
+  }
+  free(window);
+  fftwf_execute(plan);
+  for (int index = 0; index <= FFT_SIZE/2; index++) {
+    response[index][0] = signalInFreqDomain[index][0] / FFT_SIZE;
+    response[index][1] = signalInFreqDomain[index][1] / FFT_SIZE;
+  }
+  memset(history, 0, sizeof(float)*FFT_SIZE);
 };
 
-int RealToQuadrature::processSampleSetHilbert() {
-  int count = 0;
-  float * rawPtr;
-  float * floatPtr;
-  double * doublePtr;
-  fprintf(stderr, "signalInFreqDomain addr: %p, offset by size: %p, %p\n", signalInFreqDomain, signalInFreqDomain[numberOfSamples], signalInFreqDomain+numberOfSamples);
+int RealToQuadrature::processSampleSetHilbert(bool decimate) {
+  const int historySize = hilbertTaps - 1;
+  const int center = historySize / 2;
+  float * output = (float *) malloc(sizeof(float)*blockSize*2);
+  fprintf(stderr, "Hilbert filter of %d coefficients, transform size %d for %d samples per block\n",
+          hilbertTaps, FFT_SIZE, blockSize);
+  // the outputs lag the inputs by the filter's center, so when the input
+  // ends that many more are run out of it on zeros
+  int flush = center;
+  bool ending = false;
+  bool started = false;
   for (;;) {
-    count = fread(rawSignal, sizeof(float), numberOfSamples, stdin);
-    if (count == numberOfSamples) {
-      floatPtr = rawSignal;
-      doublePtr = (double *) signal;
-      for (int index = 0; index < numberOfSamples; index++) {
-        *doublePtr++ = *floatPtr++;
-        *doublePtr++ = 0.0; // set imaginary part to zero
-      }
-      // take FFT
-      fftw_execute(plan);
-      // clear negative frequencies
-      doublePtr = (double *) signalInFreqDomain;  // set pointer to negative frequencies
-      for (int index = 0; index < numberOfSamples; index++) {
-        if (index == 0) {
-          doublePtr++;  // skip
-          doublePtr++;  // skip (ie leave DC alone
-        } else {
-          if (index < numberOfSamples/2) {
-            *doublePtr++ *= 2.0;  // double positive frequencies
-            *doublePtr++ *= 2.0;
-          } else {
-            *doublePtr++ = 0.0;  // zero real part
-            *doublePtr++ = 0.0;  // zero imaginary part
-          }
-        }
-      }
-      // take the inverse - this will be the Hilbert Transform
-      fftw_execute(iplan);
-      floatPtr = outSignal;
-      rawPtr = rawSignal;
-      doublePtr = (double *) hilbertOfRaw;
-      // combine the raw input with the signal modified by the Hilbert transform
-      // IQ = raw + j*H(raw)
-      for (int index = 0; index < numberOfSamples; index++) {
-        *floatPtr++ = *rawPtr++ - doublePtr[1];
-        *floatPtr++ = doublePtr[0];
-        doublePtr++;
-        doublePtr++;
+    int count = ending ? 0 : Stream::input()->read(history + historySize, sizeof(float), blockSize);
+    if (count > 0) started = true;
+    if (count < blockSize) {
+      memset(history + historySize + count, 0, sizeof(float)*(blockSize - count));
+      if (!started) flush = 0;
+      int extra = (flush < blockSize - count) ? flush : blockSize - count;
+      count += extra;
+      flush -= extra;
+      ending = true;
+    }
+    // the transform of the real block needs only the positive half, and
+    // the product with the filter's comes back real - H(raw)
+    fftwf_execute(plan);
+    for (int index = 0; index <= FFT_SIZE/2; index++) {
+      float re = signalInFreqDomain[index][0];
+      float im = signalInFreqDomain[index][1];
+      signalInFreqDomain[index][0] = re * response[index][0] - im * response[index][1];
+      signalInFreqDomain[index][1] = re * response[index][1] + im * response[index][0];
+    }
+    fftwf_execute(iplan);
+    // raw, delayed to the center of the filter, + j*H(raw)
+    const float * raw = history + center;
+    const float * hilbert = hilbertOfRaw + historySize;
+    int outputs;
+    if (decimate) {
+      // e^(-j pi n / 2) at the even samples kept is 1, -1, 1, ...; the
+      // block is a multiple of 4, so each block starts at 1
+      outputs = (count + 1) / 2;
+      for (int index = 0; index < outputs; index++) {
+        float sign = index % 2 ? -1.0 : 1.0;
+        output[2*index] = sign * raw[2*index];
+        output[2*index + 1] = sign * hilbert[2*index];
       }
     } else {
+      outputs = count;
+      for (int index = 0; index < outputs; index++) {
+        output[2*index] = raw[index];
+        output[2*index + 1] = hilbert[index];
+      }
+    }
+    Stream::output()->write(output, sizeof(float), outputs*2);
+    if (ending && flush == 0) {
       fprintf(stderr, "short pipe, processSampleSet\n");
       break;
     }
-    fwrite(outSignal, sizeof(float), numberOfSamples*2, stdout);
+    memmove(history, history + blockSize, sizeof(float)*historySize);
   }
+  free(output);
   return 1; // pipe terminated - typically ok
 }
 
@@ -83,7 +113,7 @@ int RealToQuadrature::processSampleSetDownconversion() {
   float * inFloatPtr;
   float * outFloatPtr;
   for (;;) {
-    count = fread(rawSignal, sizeof(float), numberOfSamples, stdin);
+    count = Stream::input()->read(rawSignal, sizeof(float), numberOfSamples);
     if (count == numberOfSamples) {
       inFloatPtr = rawSignal;
       outFloatPtr = outSignal;
@@ -122,18 +152,18 @@ int RealToQuadrature::processSampleSetDownconversion() {
       fprintf(stderr, "short pipe, processSampleSet\n");
       break;
     }
-    fwrite(outSignal, sizeof(float), numberOfSamples*2, stdout);
+    Stream::output()->write(outSignal, sizeof(float), numberOfSamples*2);
   }
   return 1; // pipe terminated - typically ok
 }
 
 RealToQuadrature::~RealToQuadrature(void){
-  if (plan) fftw_destroy_plan(plan);
-  if (iplan) fftw_destroy_plan(iplan);
-  if (signal) fftw_free(signal);
-  if (signalInFreqDomain) fftw_free(signalInFreqDomain);
-  if (hilbertOfRaw) fftw_free(hilbertOfRaw);
-  if (signalInQuadrature) fftw_free(signalInQuadrature);
+  if (plan) fftwf_destroy_plan(plan);
+  if (iplan) fftwf_destroy_plan(iplan);
+  if (history) fftwf_free(history);
+  if (hilbertOfRaw) fftwf_free(hilbertOfRaw);
+  if (response) fftwf_free(response);
+  if (signalInFreqDomain) fftwf_free(signalInFreqDomain);
   if (rawSignal) free(rawSignal);
   if (outSignal) free(outSignal);
 };
@@ -17,25 +17,33 @@
 class RealToQuadrature {
 
   protected:
+  static const int FFT_SIZE = 4096;                    // of the overlap-save Hilbert transform
+  static constexpr double TRANSITION = 0.01;           // of the Hilbert filter at DC and Nyquist, of the sample rate
+  static constexpr double ATTENUATION = 80.0;          // dB, of the negative frequencies
   float * rawSignal;
   float * outSignal;
-  fftw_complex * signal;
-  fftw_complex * signalInFreqDomain;
-  fftw_complex * hilbertOfRaw;
-  fftw_complex * signalInQuadrature;
   int numberOfSamples; // number of samples in delay signal buffer
-  fftw_plan plan;
-  fftw_plan iplan;
+  int hilbertTaps;     // coefficients of the Hilbert filter, 1 more than a multiple of 4
+  int blockSize;       // new samples per transform
+  float * history;     // hilbertTaps - 1 samples of history, then the block
+  float * hilbertOfRaw;
+  fftwf_complex * response;  // transform of the Hilbert filter, scaled for the inverse
+  fftwf_complex * signalInFreqDomain;
+  fftwf_plan plan;
+  fftwf_plan iplan;
 
   public:
 
   RealToQuadrature(int fftSize);
 
-  int processSampleSetHilbert(void);
+  // the analytic signal, raw + j*H(raw), by overlap-save; with decimate,
+  // shifted down by a quarter of the sample rate and decimated by 2.  It
+  // lags the input by (hilbertTaps - 1) / 2 samples, which are run out on
+  // zeros when the input ends
+  int processSampleSetHilbert(bool decimate);
   int processSampleSetDownconversion(void);
 
   ~RealToQuadrature(void);
     
 };
 #endif  // REAL_TO_QUADRATURE_H_
-
@@ -0,0 +1,287 @@
+/*
+ *      RingBuffer.cc - lock free single producer / single consumer byte ring
+ *                      that links two pipeline stages or two processes
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <thread>
+#include "Futex.h"
+#include "RingBuffer.h"
+/* ---------------------------------------------------------------------- */
+//  A stage that finds its neighbour's side of the ring empty or full spins
+//  briefly before sleeping, since on a multicore machine the neighbour is
+//  usually only a block away.  On a single core spinning only delays the
+//  neighbour, so the thread sleeps right away.
+static const int SPIN_LIMIT = (std::thread::hardware_concurrency() > 1) ? 1000 : 0;
+
+/* ---------------------------------------------------------------------- */
+RingBuffer::RingBuffer(size_t capacity) : readEnd(this), writeEnd(this) {
+  this->capacity = CACHE_LINE;
+  while (this->capacity < capacity) this->capacity <<= 1;
+  mask = this->capacity - 1;
+  void * memory = 0;
+  if (posix_memalign(&memory, CACHE_LINE, this->capacity)) memory = 0;
+  data = reinterpret_cast<unsigned char *>(memory);
+  control = new Control;
+  ownsMemory = true;
+  shared = false;
+  reset();
+}
+
+/* ---------------------------------------------------------------------- */
+//  Ring over memory supplied by the caller, normally a shared mapping.  The
+//  capacity must be a power of two.  Only the end that creates the memory
+//  initializes it; the other end attaches to the ring as it finds it.
+RingBuffer::RingBuffer(Control * control, unsigned char * data, size_t capacity, bool initialize) :
+  readEnd(this), writeEnd(this) {
+  this->control = control;
+  this->data = data;
+  this->capacity = capacity;
+  mask = capacity - 1;
+  ownsMemory = false;
+  shared = true;
+  if (initialize) reset();
+}
+
+/* ---------------------------------------------------------------------- */
+void RingBuffer::reset(void) {
+  control->writerSide.head = 0;
+  control->writerSide.localHead = 0;
+  control->writerSide.waiting = 0;
+  control->writerSide.closed = 0;
+  control->writerSide.tailCache = 0;
+  control->writerSide.highWater = 0;
+  control->writerSide.waits = 0;
+  control->readerSide.tail = 0;
+  control->readerSide.waiting = 0;
+  control->readerSide.closed = 0;
+  control->readerSide.headCache = 0;
+  control->readerSide.waits = 0;
+  control->writerSide.process = 0;
+  control->readerSide.process = 0;
+  control->signals.dataSignal = 0;
+  control->signals.spaceSignal = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+void RingBuffer::attachWriter(void) {
+  control->writerSide.process.store(getpid());
+}
+
+/* ---------------------------------------------------------------------- */
+void RingBuffer::attachReader(void) {
+  control->readerSide.process.store(getpid());
+}
+
+/* ---------------------------------------------------------------------- */
+//  True when the process recorded for an end of a shared ring no longer
+//  exists - it was killed without closing its end.
+bool RingBuffer::gone(std::atomic<int32_t> & process) {
+  pid_t id = process.load();
+  return shared && id > 0 && kill(id, 0) < 0 && errno == ESRCH;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Return the free space in the ring, waiting until there is some.  Zero
+//  means the reader has gone away.
+//
+//  The waiting flag, the indices and the signal words are all sequentially
+//  consistent, so either the writer sees the reader's new tail before it
+//  sleeps, or the reader sees the waiting flag after it moves the tail and
+//  bumps the signal - a wake up can not be lost between the two.
+size_t RingBuffer::waitForSpace(void) {
+  size_t head = control->writerSide.localHead;
+  publish();  // the reader can only make space from data it can see
+  bool counted = false;
+  for (int spin = 0; ; spin++) {
+    if (control->readerSide.closed.load()) return 0;
+    control->writerSide.tailCache = control->readerSide.tail.load(std::memory_order_acquire);
+    size_t space = capacity - (head - control->writerSide.tailCache);
+    if (space) return space;
+    if (!counted) {
+      control->writerSide.waits.fetch_add(1, std::memory_order_relaxed);
+      counted = true;
+    }
+    if (spin < SPIN_LIMIT) {
+      Futex::cpuRelax();
+      continue;
+    }
+    control->writerSide.waiting.store(1);
+    uint32_t signal = control->signals.spaceSignal.load();
+    if (!control->readerSide.closed.load() && control->readerSide.tail.load() == control->writerSide.tailCache) {
+      Futex::wait(control->signals.spaceSignal, signal, shared, shared ? LIVENESS_CHECK : 0);
+    }
+    control->writerSide.waiting.store(0);
+    if (gone(control->readerSide.process)) control->readerSide.closed.store(1);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+//  Return the number of bytes waiting in the ring, waiting until there are
+//  some.  Zero means the writer has closed its end, or died, and the ring
+//  is drained.
+size_t RingBuffer::waitForData(void) {
+  size_t tail = control->readerSide.tail.load(std::memory_order_relaxed);
+  bool counted = false;
+  for (int spin = 0; ; spin++) {
+    // closed is read before head, so a closed writer's last block is seen
+    bool closed = control->writerSide.closed.load();
+    control->readerSide.headCache = control->writerSide.head.load(std::memory_order_acquire);
+    size_t available = control->readerSide.headCache - tail;
+    if (available) return available;
+    if (closed) return 0;
+    if (!counted) {
+      control->readerSide.waits.fetch_add(1, std::memory_order_relaxed);
+      counted = true;
+      // output this stage has held back should not wait on its input
+      Stream::output()->flush();
+    }
+    if (spin < SPIN_LIMIT) {
+      Futex::cpuRelax();
+      continue;
+    }
+    control->readerSide.waiting.store(1);
+    uint32_t signal = control->signals.dataSignal.load();
+    if (!control->writerSide.closed.load() && control->writerSide.head.load() == control->readerSide.headCache) {
+      Futex::wait(control->signals.dataSignal, signal, shared, shared ? LIVENESS_CHECK : 0);
+    }
+    control->readerSide.waiting.store(0);
+    if (gone(control->writerSide.process)) {
+      fprintf(stderr, "the writer of a shared memory ring has died\n");
+      control->writerSide.closed.store(1);  // what it published is still read
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+//  Make everything written so far visible to the reader.
+void RingBuffer::publish(void) {
+  size_t head = control->writerSide.localHead;
+  if (head == control->writerSide.head.load(std::memory_order_relaxed)) return;
+  control->writerSide.head.store(head);
+  if (control->readerSide.waiting.load()) Futex::wake(control->signals.dataSignal, shared);
+  size_t fill = head - control->readerSide.tail.load(std::memory_order_relaxed);
+  if (fill > control->writerSide.highWater.load(std::memory_order_relaxed)) {
+    control->writerSide.highWater.store(fill, std::memory_order_relaxed);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+//  Copy all of buffer into the ring, waiting for space as needed.  If the
+//  reader has gone away, the data is dropped - this is the in process
+//  equivalent of writing to a broken pipe.  Writes are published once
+//  PUBLISH_SIZE bytes have accumulated, so stages that write a sample at a
+//  time do not pay for waking the reader on every call.
+size_t RingBuffer::put(const void * buffer, size_t bytes) {
+  const unsigned char * source = reinterpret_cast<const unsigned char *>(buffer);
+  size_t remaining = bytes;
+  size_t head = control->writerSide.localHead;
+  while (remaining > 0) {
+    size_t amount = capacity - (head - control->writerSide.tailCache);
+    if (amount == 0 || control->readerSide.closed.load(std::memory_order_relaxed)) {
+      amount = waitForSpace();
+      if (amount == 0) return 0;
+    }
+    if (amount > remaining) amount = remaining;
+    size_t offset = head & mask;
+    size_t firstPart = capacity - offset;
+    if (firstPart > amount) firstPart = amount;
+    memcpy(data + offset, source, firstPart);
+    memcpy(data, source + firstPart, amount - firstPart);
+    head += amount;
+    source += amount;
+    remaining -= amount;
+    control->writerSide.localHead = head;
+  }
+  if (unpublished() >= PUBLISH_SIZE) publish();
+  return bytes;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Fill buffer from the ring, waiting for data as needed.  Fewer bytes than
+//  requested are returned only when the writer has closed its end.
+size_t RingBuffer::get(void * buffer, size_t bytes) {
+  unsigned char * destination = reinterpret_cast<unsigned char *>(buffer);
+  size_t remaining = bytes;
+  size_t tail = control->readerSide.tail.load(std::memory_order_relaxed);
+  while (remaining > 0) {
+    size_t amount = control->readerSide.headCache - tail;
+    if (amount == 0) {
+      amount = waitForData();
+      if (amount == 0) break;  // writer closed and ring drained
+    }
+    if (amount > remaining) amount = remaining;
+    size_t offset = tail & mask;
+    size_t firstPart = capacity - offset;
+    if (firstPart > amount) firstPart = amount;
+    memcpy(destination, data + offset, firstPart);
+    memcpy(destination + firstPart, data, amount - firstPart);
+    tail += amount;
+    destination += amount;
+    remaining -= amount;
+    control->readerSide.tail.store(tail);
+    if (control->writerSide.waiting.load()) Futex::wake(control->signals.spaceSignal, shared);
+  }
+  return bytes - remaining;
+}
+
+/* ---------------------------------------------------------------------- */
+void RingBuffer::closeWriter(void) {
+  publish();
+  control->writerSide.closed.store(1);
+  Futex::wake(control->signals.dataSignal, shared);
+}
+
+/* ---------------------------------------------------------------------- */
+void RingBuffer::closeReader(void) {
+  control->readerSide.closed.store(1);
+  Futex::wake(control->signals.spaceSignal, shared);
+}
+
+/* ---------------------------------------------------------------------- */
+size_t RingBuffer::Reader::read(void * buffer, size_t size, size_t count) {
+  return ring->get(buffer, size * count) / size;
+}
+
+/* ---------------------------------------------------------------------- */
+size_t RingBuffer::Reader::write(const void * buffer, size_t size, size_t count) {
+  return 0;  // read end only
+}
+
+/* ---------------------------------------------------------------------- */
+void RingBuffer::Reader::close(void) {
+  ring->closeReader();
+}
+
+/* ---------------------------------------------------------------------- */
+size_t RingBuffer::Writer::read(void * buffer, size_t size, size_t count) {
+  return 0;  // write end only
+}
+
+/* ---------------------------------------------------------------------- */
+size_t RingBuffer::Writer::write(const void * buffer, size_t size, size_t count) {
+  return ring->put(buffer, size * count) / size;
+}
+
+/* ---------------------------------------------------------------------- */
+void RingBuffer::Writer::close(void) {
+  ring->closeWriter();
+}
+
+/* ---------------------------------------------------------------------- */
+RingBuffer::~RingBuffer(void) {
+  if (ownsMemory) {
+    if (data) free(data);
+    delete control;
+  }
+}
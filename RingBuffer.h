@@ -0,0 +1,120 @@
+#ifndef RINGBUFFER_H_
+#define RINGBUFFER_H_
+/*
+ *      RingBuffer.h - lock free single producer / single consumer byte ring
+ *                     that links two pipeline stages running in the same
+ *                     process, or two processes through shared memory
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdint.h>
+#include <atomic>
+#include "Stream.h"
+/* ---------------------------------------------------------------------- */
+class RingBuffer {
+ public:
+  static const size_t CACHE_LINE = 64;
+  static const size_t PUBLISH_SIZE = 4096;  // smaller writes are held back until this much is written
+
+ private:
+  class Reader : public Stream {
+   private:
+    RingBuffer * ring;
+   public:
+    size_t read(void * buffer, size_t size, size_t count);
+    size_t write(const void * buffer, size_t size, size_t count);
+    void close(void);
+    explicit Reader(RingBuffer * ring) { this->ring = ring; }
+  };
+  class Writer : public Stream {
+   private:
+    RingBuffer * ring;
+   public:
+    size_t read(void * buffer, size_t size, size_t count);
+    size_t write(const void * buffer, size_t size, size_t count);
+    void close(void);
+    void flush(void) { ring->publish(); }
+    size_t pending(void) { return ring->unpublished(); }
+    explicit Writer(RingBuffer * ring) { this->ring = ring; }
+  };
+
+  // Each side owns a cache line.  The other side only reads the published
+  // index and the waiting flag, so the lines move between cores once per
+  // block rather than on every access.
+  struct alignas(CACHE_LINE) WriterSide {
+    std::atomic<size_t> head;          // total bytes ever written and published
+    size_t localHead;                  // total bytes ever written
+    std::atomic<uint32_t> waiting;     // writer is (about to be) asleep on spaceSignal
+    std::atomic<uint32_t> closed;
+    size_t tailCache;                  // last tail seen by the writer
+    std::atomic<size_t> highWater;     // largest fill level seen after a put
+    std::atomic<size_t> waits;         // times the writer found the ring full
+    std::atomic<int32_t> process;      // pid of the writer when shared between processes
+  };
+  struct alignas(CACHE_LINE) ReaderSide {
+    std::atomic<size_t> tail;          // total bytes ever read
+    std::atomic<uint32_t> waiting;     // reader is (about to be) asleep on dataSignal
+    std::atomic<uint32_t> closed;
+    size_t headCache;                  // last head seen by the reader
+    std::atomic<size_t> waits;         // times the reader found the ring empty
+    std::atomic<int32_t> process;      // pid of the reader when shared between processes
+  };
+  struct alignas(CACHE_LINE) Signals {
+    std::atomic<uint32_t> dataSignal;  // futex word the reader sleeps on
+    std::atomic<uint32_t> spaceSignal; // futex word the writer sleeps on
+  };
+
+
+ public:
+  // Everything both ends of the ring share.  It is placed in shared memory,
+  // along with the data, when the ends are in different processes.
+  struct Control {
+    WriterSide writerSide;
+    ReaderSide readerSide;
+    Signals signals;
+  };
+
+ private:
+  Control * control;
+  bool ownsMemory;
+  bool shared;                         // ends may be in different processes
+  unsigned char * data;
+  size_t capacity;                     // always a power of two
+  size_t mask;
+  Reader readEnd;
+  Writer writeEnd;
+
+  static const int LIVENESS_CHECK = 250;  // milliseconds between checks that the other process is alive
+
+  void reset(void);
+  bool gone(std::atomic<int32_t> & process);
+  size_t waitForSpace(void);
+  size_t waitForData(void);
+  void publish(void);
+  size_t unpublished(void) { return control->writerSide.localHead - control->writerSide.head.load(std::memory_order_relaxed); }
+
+ public:
+  size_t put(const void * buffer, size_t bytes);
+  size_t get(void * buffer, size_t bytes);
+  void closeWriter(void);
+  void closeReader(void);
+  // record the calling process as the writer or the reader of a shared
+  // ring, so the other end can tell when it dies without closing its end
+  void attachWriter(void);
+  void attachReader(void);
+  size_t size(void) { return capacity; }
+  size_t highWater(void) { return control->writerSide.highWater.load(std::memory_order_relaxed); }
+  size_t writerWaits(void) { return control->writerSide.waits.load(std::memory_order_relaxed); }
+  size_t readerWaits(void) { return control->readerSide.waits.load(std::memory_order_relaxed); }
+  bool writerClosed(void) { return control->writerSide.closed.load(); }
+  Stream * reader(void) { return &readEnd; }
+  Stream * writer(void) { return &writeEnd; }
+  explicit RingBuffer(size_t capacity);
+  RingBuffer(Control * control, unsigned char * data, size_t capacity, bool initialize);
+  ~RingBuffer(void);
+};
+#endif  // RINGBUFFER_H_
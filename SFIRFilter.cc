@@ -15,8 +15,10 @@
 #include <unistd.h>
 #include <string.h>
 
+#include "FIRKernels.h"
 #include "Poly.h"
 #include "SFIRFilter.h"
+#include "Stream.h"
 
 /* ---------------------------------------------------------------------- */
 SFIRFilter::SFIRFilter(float cutoff) {
@@ -179,6 +181,7 @@ void SFIRFilter::doWork(float cutoff, int decimation, bool highPass, bool comple
   }
   this->M = 2 * (M + 1) + 1;  // set number of coefficients
   this->coefficients = filterCoefficients;  // free this in destructor
+  symmetric = FIRKernels::symmetric(coefficients, this->M);  // true by construction, checked all the same
   this->decimation = decimation;
   N = 1024;  // default to 1K of output sample (I and Q or real)
   if (complexFilter) {
@@ -187,7 +190,7 @@ void SFIRFilter::doWork(float cutoff, int decimation, bool highPass, bool comple
     SIGNAL_BUFFER_SIZE = INPUT_BUFFER_SIZE + (this->M - 1) * sizeof(float) * 2 * decimation;
     OUTPUT_BUFFER_SIZE = N * 2 * sizeof(float);
     if (debug) fprintf(stderr, "allocating signal buffer of size %d bytes\n", SIGNAL_BUFFER_SIZE);
-    signalBuffer = reinterpret_cast<float *>(malloc(SIGNAL_BUFFER_SIZE));
+    signalBuffer = reinterpret_cast<float *>(calloc(SIGNAL_BUFFER_SIZE, 1));  // the first history is silence
     if (debug) fprintf(stderr, "allocating output buffer of size %d bytes\n", OUTPUT_BUFFER_SIZE);
     outputBuffer = reinterpret_cast<float *>(malloc(OUTPUT_BUFFER_SIZE));
     inputBuffer = signalBuffer + (this->M - 1) * 2 * decimation;  // buffer start for read
@@ -201,7 +204,7 @@ void SFIRFilter::doWork(float cutoff, int decimation, bool highPass, bool comple
     SIGNAL_BUFFER_SIZE = INPUT_BUFFER_SIZE + (this->M - 1) * sizeof(float) * decimation;
     OUTPUT_BUFFER_SIZE = N * sizeof(float);
     if (debug) fprintf(stderr, "allocating signal buffer of size %d bytes\n", SIGNAL_BUFFER_SIZE);
-    signalBuffer = reinterpret_cast<float *>(malloc(SIGNAL_BUFFER_SIZE));
+    signalBuffer = reinterpret_cast<float *>(calloc(SIGNAL_BUFFER_SIZE, 1));  // the first history is silence
     if (debug) fprintf(stderr, "allocating output buffer of size %d bytes\n", OUTPUT_BUFFER_SIZE);
     outputBuffer = reinterpret_cast<float *>(malloc(OUTPUT_BUFFER_SIZE));
     inputBuffer = signalBuffer + (this->M - 1) * decimation;  // buffer start for read
@@ -214,104 +217,68 @@ void SFIRFilter::doWork(float cutoff, int decimation, bool highPass, bool comple
 
 /* ---------------------------------------------------------------------- */
 int SFIRFilter::readSignalPipe() {
-  int count = fread(inputBuffer, sizeof(char), INPUT_BUFFER_SIZE, stdin);
+  int count = Stream::input()->read(inputBuffer, sizeof(char), INPUT_BUFFER_SIZE);
   return count;
 }
 
 /* ---------------------------------------------------------------------- */
 int SFIRFilter::writeSignalPipe() {
-  int count = fwrite(outputBuffer, sizeof(char), OUTPUT_BUFFER_SIZE, stdout);
+  int count = Stream::output()->write(outputBuffer, sizeof(char), OUTPUT_BUFFER_SIZE);
   return count;
 }
 
 /* ---------------------------------------------------------------------- */
 void SFIRFilter::filterSignal() {
-  float * I;
-  float * firstI;
-  float * Q;
-  float * coefficientPtr;
-  float * output;
-  float sumI;
-  float sumQ;
+  //
+  // Coefficient j is applied to the sample j * decimation samples after the
+  // first, so only every decimation'th input sample is ever used.  Those are
+  // gathered into one contiguous buffer for the vector kernels, which then
+  // step one sample per output.  Without decimation the signal buffer is
+  // used as it is.
+  //
+  int width = complexFilter ? 2 : 1;  // floats per sample
+  int used = M - 1 + N;               // samples used from each signal buffer
+  float * gathered = signalBuffer;
+  if (decimation > 1) gathered = reinterpret_cast<float *>(malloc(used * width * sizeof(float)));
+  float * pairs = complexFilter ? FIRKernels::interleave(coefficients, M) : 0;
 
   for (;;) {
     if (readSignalPipe() != INPUT_BUFFER_SIZE) {
       fprintf(stderr, "Short read....\n");
-      exit(-1);
+      Stream::output()->close();
+      break;
+    }
+    if (decimation > 1) {
+      float * source = signalBuffer;
+      float * destination = gathered;
+      for (int n = 0; n < used; n++) {
+        for (int w = 0; w < width; w++) destination[w] = source[w];
+        source += width * decimation;
+        destination += width;
+      }
     }
-
     if (complexFilter) {
-      I = signalBuffer;
-      // set I to the first input
-      // that will be processed by
-      // coefficient[0]
-      Q = I + 1;
-      output = outputBuffer;
-      coefficientPtr = coefficients;
-      int increment = 2 * decimation;
-      firstI = I + increment;  // this is the next first I location
-      //
-      // Filter with this current buffer of input
-      //
-      for (int i = 0; i < N; i++) {  // for N outputs
-        sumI = 0.0;
-        sumQ = 0.0;
-        coefficientPtr = coefficients;
-        for (int j = 0; j < M; j++) {
-          sumI += *coefficientPtr * *I;
-          sumQ += *coefficientPtr * *Q;
-          coefficientPtr++;
-          I += increment;
-          Q += increment;
-        }
-        I = firstI;
-        firstI += increment;
-        Q = I + 1;
-        *output++ = sumI;
-        *output++ = sumQ;
+      if (symmetric) {
+        FIRKernels::decimateSymmetricInterleaved(pairs, M, gathered, 1, outputBuffer, N);
+      } else {
+        FIRKernels::decimateInterleaved(pairs, M, gathered, 1, outputBuffer, N);
       }
-      //
-      // Copy the end of the buffer that will be used in the filtering
-      // of the next buffer that arrives
-      //
-      writeSignalPipe();
-      memcpy(signalBuffer, inputToDelay, (M-1) * 8 * decimation);
-      // after copy, the end of the copied data should match up with the beginning of the input buffer, so
-      // look at it after the read
     } else {
-      I = signalBuffer;
-      // set I to the first input
-      // that will be processed by
-      // coefficient[0]
-      output = outputBuffer;
-      coefficientPtr = coefficients;
-      int increment = decimation;
-      firstI = I + increment;  // this is the next first I location
-      //
-      // Filter with this current buffer of input
-      //
-      for (int i = 0; i < N; i++) {  // for N outputs
-        sumI = 0.0;
-        coefficientPtr = coefficients;
-        for (int j = 0; j < M; j++) {
-          sumI += *coefficientPtr * *I;
-          coefficientPtr++;
-          I += increment;
-        }
-        I = firstI;
-        firstI += increment;
-        *output++ = sumI;
+      if (symmetric) {
+        FIRKernels::decimateSymmetric(coefficients, M, gathered, 1, outputBuffer, N);
+      } else {
+        FIRKernels::decimate(coefficients, M, gathered, 1, outputBuffer, N);
       }
-      //
-      // Copy the end of the buffer that will be used in the filtering
-      // of the next buffer that arrives
-      //
-      writeSignalPipe();
-      memcpy(signalBuffer, inputToDelay, (M-1) * 4 * decimation);
-      // after copy, the end of the copied data should match up with the beginning of the input buffer, so
-      // look at it after the read
     }
+    writeSignalPipe();
+    //
+    // Copy the end of the buffer that will be used in the filtering
+    // of the next buffer that arrives
+    //
+    memcpy(signalBuffer, inputToDelay, (M - 1) * width * sizeof(float) * decimation);
   }
+  if (pairs) free(pairs);
+  if (gathered != signalBuffer) free(gathered);
 }
 
 /* ---------------------------------------------------------------------- */
@@ -26,6 +26,7 @@ class SFIRFilter {
   int M;
   int N;
   int decimation;
+  bool symmetric;          // coefficients mirror about the middle one
 
   int readSignalPipe();
   int writeSignalPipe();
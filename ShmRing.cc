@@ -0,0 +1,133 @@
+/*
+ *      ShmRing.cc - ring buffer in a named POSIX shared memory object
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <fcntl.h>
+#include <stdio.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <new>
+#include "ShmRing.h"
+/* ---------------------------------------------------------------------- */
+//  The writer creates the ring and the reader waits for it, so the two
+//  commands can be started in either order.
+ShmRing::ShmRing(const char * name, Role role, size_t capacity) {
+  this->name = std::string("/dspp_") + name;
+  this->role = role;
+  memory = MAP_FAILED;
+  mappedSize = 0;
+  object = 0;
+  ring = 0;
+  if (role == WRITER) {
+    if (capacity == 0 || capacity > MAX_SIZE) {
+      fprintf(stderr, "shared memory ring size must be from 1 to %zu bytes\n", MAX_SIZE);
+      return;
+    }
+    size_t size = PAGE;
+    while (size < capacity) size <<= 1;
+    create(size);
+  } else {
+    attach();
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+bool ShmRing::create(size_t capacity) {
+  shm_unlink(name.c_str());  // a ring left behind by a writer that did not finish
+  int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0660);
+  if (fd < 0) {
+    perror("could not create shared memory ring");
+    return false;
+  }
+  fchmod(fd, 0660);  // so a reader running as another user in the group can attach
+  struct stat status;
+  if (fstat(fd, &status) == 0) object = status.st_ino;
+  mappedSize = DATA_OFFSET + capacity;
+  if (ftruncate(fd, mappedSize) == 0) {
+    memory = mmap(0, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  close(fd);
+  if (memory == MAP_FAILED) {
+    perror("could not map shared memory ring");
+    shm_unlink(name.c_str());
+    return false;
+  }
+  unsigned char * base = reinterpret_cast<unsigned char *>(memory);
+  Header * header = new (base) Header;
+  RingBuffer::Control * control = new (base + CONTROL_OFFSET) RingBuffer::Control;
+  ring = new RingBuffer(control, base + DATA_OFFSET, capacity, true);
+  ring->attachWriter();
+  header->magic = MAGIC;
+  header->headerSize = DATA_OFFSET;
+  header->capacity = capacity;
+  header->ready.store(1);
+  fprintf(stderr, "created shared memory ring %s of %zu bytes\n", name.c_str(), capacity);
+  return true;
+}
+
+/* ---------------------------------------------------------------------- */
+bool ShmRing::attach(void) {
+  bool reported = false;
+  int fd = -1;
+  struct stat status;
+  // wait for the object to exist, be sized and be initialized by the writer
+  for (;;) {
+    if (fd < 0) fd = shm_open(name.c_str(), O_RDWR, 0);
+    if (fd >= 0 && memory == MAP_FAILED && fstat(fd, &status) == 0 && (size_t) status.st_size >= DATA_OFFSET) {
+      memory = mmap(0, PAGE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (memory != MAP_FAILED) mappedSize = PAGE;
+    }
+    if (memory != MAP_FAILED && reinterpret_cast<Header *>(memory)->ready.load()) break;
+    if (!reported) {
+      fprintf(stderr, "waiting for shared memory ring %s\n", name.c_str());
+      reported = true;
+    }
+    usleep(100000);
+  }
+  Header * header = reinterpret_cast<Header *>(memory);
+  if (header->magic != MAGIC || header->headerSize != DATA_OFFSET) {
+    fprintf(stderr, "shared memory ring %s was made by an incompatible dspp\n", name.c_str());
+    close(fd);
+    return false;
+  }
+  size_t capacity = header->capacity;
+  munmap(memory, mappedSize);
+  mappedSize = DATA_OFFSET + capacity;
+  memory = mmap(0, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    perror("could not map shared memory ring");
+    return false;
+  }
+  unsigned char * base = reinterpret_cast<unsigned char *>(memory);
+  RingBuffer::Control * control = reinterpret_cast<RingBuffer::Control *>(base + CONTROL_OFFSET);
+  ring = new RingBuffer(control, base + DATA_OFFSET, capacity, false);
+  ring->attachReader();
+  fprintf(stderr, "attached to shared memory ring %s of %zu bytes\n", name.c_str(), capacity);
+  return true;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Only the writer removes the name, and only while it still names the ring
+//  this writer created - a writer restarted in the meantime has made a new
+//  one that its reader may be attached to.  A reader just unmaps.
+ShmRing::~ShmRing(void) {
+  if (ring) {
+    delete ring;
+    if (role == WRITER) {
+      int fd = shm_open(name.c_str(), O_RDONLY, 0);
+      struct stat status;
+      if (fd >= 0) {
+        if (fstat(fd, &status) == 0 && status.st_ino == object) shm_unlink(name.c_str());
+        close(fd);
+      }
+    }
+  }
+  if (memory != MAP_FAILED) munmap(memory, mappedSize);
+}
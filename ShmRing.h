@@ -0,0 +1,54 @@
+#ifndef SHMRING_H_
+#define SHMRING_H_
+/*
+ *      ShmRing.h - ring buffer in a named POSIX shared memory object so that
+ *                  two dspp processes can pass samples without a kernel pipe
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdint.h>
+#include <sys/types.h>
+#include <atomic>
+#include <string>
+#include "RingBuffer.h"
+/* ---------------------------------------------------------------------- */
+class ShmRing {
+ public:
+  enum Role { WRITER, READER };
+  static const size_t DEFAULT_SIZE = 1 << 22;  // about 0.2 s of 2.4 MS/s complex float
+  static const size_t MAX_SIZE = 1 << 30;
+
+ private:
+  static const uint32_t MAGIC = 0x64737072;  // "dspr"
+  struct alignas(RingBuffer::CACHE_LINE) Header {
+    uint32_t magic;
+    uint32_t headerSize;                     // detects layout changes between builds
+    uint64_t capacity;
+    std::atomic<uint32_t> ready;             // set once the writer has initialized the ring
+  };
+  static const size_t PAGE = 4096;
+  static const size_t CONTROL_OFFSET = sizeof(Header);
+  static const size_t DATA_OFFSET = (CONTROL_OFFSET + sizeof(RingBuffer::Control) + PAGE - 1) / PAGE * PAGE;
+
+  std::string name;
+  Role role;
+  void * memory;
+  size_t mappedSize;
+  ino_t object;                        // the writer's, to unlink only its own
+  RingBuffer * ring;
+
+  bool create(size_t capacity);
+  bool attach(void);
+
+ public:
+  bool isOpen(void) { return ring != 0; }
+  Stream * reader(void) { return ring->reader(); }
+  Stream * writer(void) { return ring->writer(); }
+  ShmRing(const char * name, Role role, size_t capacity = DEFAULT_SIZE);
+  ~ShmRing(void);
+};
+#endif  // SHMRING_H_
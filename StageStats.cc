@@ -0,0 +1,239 @@
+/*
+ *      StageStats.cc - throughput and timing statistics for one command
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdlib.h>
+#include <time.h>
+#include <chrono>
+#include "StageStats.h"
+/* ---------------------------------------------------------------------- */
+StageStats::StageStats(const char * name, const char * path) {
+  this->name = name;
+  destination = stderr;
+  ownsDestination = false;
+  if (path && *path) {
+    destination = fopen(path, "a");
+    if (destination) {
+      setvbuf(destination, 0, _IOLBF, 0);  // whole lines, so stages sharing the file do not mix
+      ownsDestination = true;
+    } else {
+      perror("could not open statistics file, using standard error");
+      destination = stderr;
+    }
+  }
+  const char * setting = getenv("DSPP_STATS_INTERVAL");
+  interval = setting ? atoi(setting) : 10;
+  in.items = in.bytes = in.shortCalls = in.blocked = 0;
+  out.items = out.bytes = out.shortCalls = out.blocked = 0;
+  maxBlock = 0;
+  lastReadEnd = 0;
+  writeBlockedSinceRead = 0;
+  readingSince = 0;
+  writingSince = 0;
+  start = 0;
+  inputProbe = 0;
+  outputProbe = 0;
+  stopping = false;
+}
+
+/* ---------------------------------------------------------------------- */
+uint64_t StageStats::now(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (uint64_t) time.tv_sec * 1000000000 + time.tv_nsec;
+}
+
+/* ---------------------------------------------------------------------- */
+//  The calling thread's streams are replaced by probes until detach.
+void StageStats::attach(void) {
+  inputProbe = new Probe(Stream::input(), this);
+  outputProbe = new Probe(Stream::output(), this);
+  Stream::bind(inputProbe, outputProbe);
+  start = now();
+  take(previous);
+  if (interval > 0) reporter = std::thread(&StageStats::reportPeriodically, this);
+}
+
+/* ---------------------------------------------------------------------- */
+void StageStats::detach(void) {
+  if (!inputProbe) return;
+  if (reporter.joinable()) {
+    {
+      std::lock_guard<std::mutex> guard(lock);
+      stopping = true;
+    }
+    stop.notify_one();
+    reporter.join();
+  }
+  Snapshot first = { 0, 0, 0, 0, 0, 0, start };
+  Snapshot last;
+  take(last);
+  print(first, last, "total");
+  Stream::bind(inputProbe->wrapped(), outputProbe->wrapped());
+  delete inputProbe;
+  delete outputProbe;
+  inputProbe = 0;
+  outputProbe = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+//  A read or write still in progress counts up to now, so a long wait is
+//  spread over the reports it spans.
+void StageStats::take(Snapshot & snapshot) {
+  snapshot.inItems = in.items;
+  snapshot.outItems = out.items;
+  snapshot.inBytes = in.bytes;
+  snapshot.outBytes = out.bytes;
+  snapshot.readBlocked = in.blocked;
+  snapshot.writeBlocked = out.blocked;
+  snapshot.time = now();
+  uint64_t since = readingSince;
+  if (since && since < snapshot.time) snapshot.readBlocked += snapshot.time - since;
+  since = writingSince;
+  if (since && since < snapshot.time) snapshot.writeBlocked += snapshot.time - since;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Time neither reading nor writing is counted as compute time.
+void StageStats::print(const Snapshot & from, const Snapshot & to, const char * label) {
+  double seconds = (to.time - from.time) * 1e-9;
+  if (seconds <= 0.0) return;
+  double elapsed = to.time - from.time;
+  double reading = to.readBlocked - from.readBlocked;
+  double writing = to.writeBlocked - from.writeBlocked;
+  double computing = elapsed - reading - writing;
+  if (computing < 0.0) computing = 0.0;
+  fprintf(destination, "stats %s, %s %.1f s: in %.0f samples/s (%.0f bytes/s), out %.0f samples/s (%.0f bytes/s), "
+          "compute %.0f%%, blocked on read %.0f%%, on write %.0f%%, short reads %lu, max block %.3f ms\n",
+          name.c_str(), label, seconds,
+          (to.inItems - from.inItems) / seconds, (to.inBytes - from.inBytes) / seconds,
+          (to.outItems - from.outItems) / seconds, (to.outBytes - from.outBytes) / seconds,
+          computing * 100.0 / elapsed, reading * 100.0 / elapsed, writing * 100.0 / elapsed,
+          (unsigned long) in.shortCalls.load(), maxBlock.load() * 1e-6);
+}
+
+/* ---------------------------------------------------------------------- */
+void StageStats::reportPeriodically(void) {
+  std::unique_lock<std::mutex> guard(lock);
+  while (!stop.wait_for(guard, std::chrono::seconds(interval), [this] { return stopping; })) {
+    Snapshot current;
+    take(current);
+    print(previous, current, "last");
+    previous = current;
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+//  A block's processing time runs from the end of one read to the start of
+//  the next, less the time spent waiting to write its results.
+void StageStats::readStarting(uint64_t time) {
+  if (lastReadEnd == 0) return;
+  uint64_t block = time - lastReadEnd - writeBlockedSinceRead;
+  if (block > maxBlock.load(std::memory_order_relaxed)) maxBlock.store(block, std::memory_order_relaxed);
+}
+
+/* ---------------------------------------------------------------------- */
+size_t StageStats::Probe::read(void * buffer, size_t size, size_t count) {
+  uint64_t begin = now();
+  stats->readStarting(begin);
+  stats->readingSince = begin;
+  size_t got = stream->read(buffer, size, count);
+  uint64_t end = now();
+  stats->in.blocked.fetch_add(end - begin);
+  stats->readingSince = 0;
+  stats->in.items.fetch_add(got, std::memory_order_relaxed);
+  stats->in.bytes.fetch_add(got * size, std::memory_order_relaxed);
+  if (got < count) stats->in.shortCalls.fetch_add(1, std::memory_order_relaxed);
+  stats->lastReadEnd = end;
+  stats->writeBlockedSinceRead = 0;
+  return got;
+}
+
+/* ---------------------------------------------------------------------- */
+size_t StageStats::Probe::write(const void * buffer, size_t size, size_t count) {
+  uint64_t begin = now();
+  stats->writingSince = begin;
+  size_t written = stream->write(buffer, size, count);
+  uint64_t spent = now() - begin;
+  stats->out.blocked.fetch_add(spent);
+  stats->writingSince = 0;
+  stats->out.items.fetch_add(written, std::memory_order_relaxed);
+  stats->out.bytes.fetch_add(written * size, std::memory_order_relaxed);
+  if (written < count) stats->out.shortCalls.fetch_add(1, std::memory_order_relaxed);
+  stats->writeBlockedSinceRead += spent;
+  return written;
+}
+
+/* ---------------------------------------------------------------------- */
+//  A stream waiting for input flushes the output itself; that time is
+//  already counted as time reading.
+void StageStats::Probe::flush(void) {
+  if (stats->readingSince.load(std::memory_order_relaxed)) {
+    stream->flush();
+    return;
+  }
+  uint64_t begin = now();
+  stats->writingSince = begin;
+  stream->flush();
+  uint64_t spent = now() - begin;
+  stats->out.blocked.fetch_add(spent);
+  stats->writingSince = 0;
+  stats->writeBlockedSinceRead += spent;
+}
+
+/* ---------------------------------------------------------------------- */
+//  The probe is taken off the destination so that the wrapped streams can
+//  still move the data between them without copying.  Bytes moved count as
+//  samples both ways and the time as time waiting to read.
+size_t StageStats::Probe::transferTo(Stream * destination, size_t bytes) {
+  Probe * probe = dynamic_cast<Probe *>(destination);
+  uint64_t begin = now();
+  stats->readingSince = begin;
+  size_t moved = stream->transferTo(probe ? probe->wrapped() : destination, bytes);
+  stats->in.blocked.fetch_add(now() - begin);
+  stats->readingSince = 0;
+  stats->in.items.fetch_add(moved, std::memory_order_relaxed);
+  stats->in.bytes.fetch_add(moved, std::memory_order_relaxed);
+  stats->out.items.fetch_add(moved, std::memory_order_relaxed);
+  stats->out.bytes.fetch_add(moved, std::memory_order_relaxed);
+  if (moved < bytes) stats->in.shortCalls.fetch_add(1, std::memory_order_relaxed);
+  return moved;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Data the kernel moves on the wrapped descriptor, such as by tee(2) or
+//  vmsplice, counts as read or written by this probe, and the time in the
+//  call as time waiting to read or write.
+void StageStats::Probe::kernelStarting(void) {
+  if (this == stats->inputProbe) {
+    stats->readingSince = now();
+  } else {
+    stats->writingSince = now();
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+void StageStats::Probe::kernelMoved(size_t bytes) {
+  bool input = (this == stats->inputProbe);
+  Counters & counters = input ? stats->in : stats->out;
+  std::atomic<uint64_t> & since = input ? stats->readingSince : stats->writingSince;
+  uint64_t begin = since.exchange(0);
+  if (begin) {
+    uint64_t spent = now() - begin;
+    counters.blocked.fetch_add(spent);
+    if (!input) stats->writeBlockedSinceRead += spent;
+  }
+  counters.items.fetch_add(bytes, std::memory_order_relaxed);
+  counters.bytes.fetch_add(bytes, std::memory_order_relaxed);
+}
+
+/* ---------------------------------------------------------------------- */
+StageStats::~StageStats(void) {
+  detach();
+  if (ownsDestination) fclose(destination);
+}
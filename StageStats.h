@@ -0,0 +1,89 @@
+#ifndef STAGESTATS_H_
+#define STAGESTATS_H_
+/*
+ *      StageStats.h - throughput and timing statistics for one command.  The
+ *                     command's input and output streams are wrapped in
+ *                     probes that time every read and write, and the totals
+ *                     are reported periodically and when the command ends.
+ *                     Nothing is wrapped unless statistics are asked for.
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stdint.h>
+#include <stdio.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include "Stream.h"
+/* ---------------------------------------------------------------------- */
+class StageStats {
+ private:
+  struct Counters {
+    std::atomic<uint64_t> items;       // samples, in the units the command uses
+    std::atomic<uint64_t> bytes;
+    std::atomic<uint64_t> shortCalls;  // reads or writes that moved less than asked
+    std::atomic<uint64_t> blocked;     // nanoseconds inside read or write
+  };
+  struct Snapshot {
+    uint64_t inItems, outItems, inBytes, outBytes, readBlocked, writeBlocked, time;
+  };
+
+  // Stream that times and counts the calls made on the stream it wraps
+  class Probe : public Stream {
+   private:
+    Stream * stream;
+    StageStats * stats;
+   public:
+    Stream * wrapped(void) { return stream; }
+    size_t read(void * buffer, size_t size, size_t count);
+    size_t write(const void * buffer, size_t size, size_t count);
+    void close(void) { stream->close(); }
+    void flush(void);
+    size_t pending(void) { return stream->pending(); }
+    size_t transferTo(Stream * destination, size_t bytes);
+    FdStream * fdStream(void) { return stream->fdStream(); }
+    void kernelStarting(void);
+    void kernelMoved(size_t bytes);
+    Probe(Stream * stream, StageStats * stats) : stream(stream), stats(stats) {}
+  };
+
+  std::string name;
+  FILE * destination;
+  bool ownsDestination;
+  int interval;                        // seconds between reports, 0 for only at the end
+  Counters in;
+  Counters out;
+  std::atomic<uint64_t> maxBlock;      // longest time from one read to the next, less writing
+  uint64_t lastReadEnd;
+  uint64_t writeBlockedSinceRead;
+  std::atomic<uint64_t> readingSince; // start of the read or write in progress, else zero
+  std::atomic<uint64_t> writingSince;
+  uint64_t start;
+  Snapshot previous;
+  Probe * inputProbe;
+  Probe * outputProbe;
+  std::thread reporter;
+  std::mutex lock;
+  std::condition_variable stop;
+  bool stopping;
+
+  static uint64_t now(void);
+  void take(Snapshot & snapshot);
+  void print(const Snapshot & from, const Snapshot & to, const char * label);
+  void reportPeriodically(void);
+  void readStarting(uint64_t time);
+
+ public:
+  void attach(void);
+  void detach(void);
+  // path is zero or empty for standard error
+  StageStats(const char * name, const char * path);
+  ~StageStats(void);
+};
+#endif  // STAGESTATS_H_
@@ -0,0 +1,345 @@
+/*
+ *      Stream.cc - sample stream endpoints used by the dspp stages
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include "Stream.h"
+/* ---------------------------------------------------------------------- */
+static thread_local Stream * boundInput = 0;
+static thread_local Stream * boundOutput = 0;
+
+/* ---------------------------------------------------------------------- */
+//  The standard streams are never destroyed - in a pipeline a detached stage
+//  may still be blocked on standard input while the process exits - so
+//  standard output is flushed from an exit handler instead.
+static void flushStandardOutput(void) {
+  Stream::standardOutput()->flush();
+}
+
+/* ---------------------------------------------------------------------- */
+Stream * Stream::standardInput(void) {
+  static FdStream * standardInputStream = new FdStream(STDIN_FILENO);
+  return standardInputStream;
+}
+
+/* ---------------------------------------------------------------------- */
+Stream * Stream::standardOutput(void) {
+  static FdStream * standardOutputStream = 0;
+  static bool registered = (atexit(flushStandardOutput) == 0);
+  if (!standardOutputStream) standardOutputStream = new FdStream(STDOUT_FILENO);
+  (void) registered;
+  return standardOutputStream;
+}
+
+/* ---------------------------------------------------------------------- */
+Stream * Stream::input(void) {
+  if (!boundInput) boundInput = standardInput();
+  return boundInput;
+}
+
+/* ---------------------------------------------------------------------- */
+Stream * Stream::output(void) {
+  if (!boundOutput) boundOutput = standardOutput();
+  return boundOutput;
+}
+
+/* ---------------------------------------------------------------------- */
+void Stream::bind(Stream * input, Stream * output) {
+  boundInput = input;
+  boundOutput = output;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Bytes moved per system call.  The default keeps a 2.4 MS/s byte stream
+//  to about 70 calls a second; DSPP_BLOCK_SIZE trades that against latency.
+size_t Stream::blockSize(void) {
+  static size_t size = 0;
+  if (!size) {
+    const size_t PAGE = 4096;
+    size = 64 * 1024;
+    const char * setting = getenv("DSPP_BLOCK_SIZE");
+    if (setting) {
+      size_t requested = strtoul(setting, 0, 0);
+      if (requested < PAGE) {
+        fprintf(stderr, "DSPP_BLOCK_SIZE of %s is too small, using %zu\n", setting, PAGE);
+        requested = PAGE;
+      }
+      size = (requested + PAGE - 1) / PAGE * PAGE;
+    }
+  }
+  return size;
+}
+
+/* ---------------------------------------------------------------------- */
+size_t Stream::transferTo(Stream * destination, size_t bytes) {
+  size_t block = blockSize();
+  unsigned char * buffer = reinterpret_cast<unsigned char *>(malloc(block));
+  size_t moved = 0;
+  while (moved < bytes) {
+    size_t amount = (bytes - moved < block) ? bytes - moved : block;
+    size_t count = read(buffer, sizeof(unsigned char), amount);
+    if (destination->write(buffer, sizeof(unsigned char), count) < count) break;
+    moved += count;
+    if (count < amount) break;
+  }
+  free(buffer);
+  return moved;
+}
+
+/* ---------------------------------------------------------------------- */
+FdStream::FdStream(int fd) {
+  this->fd = fd;
+  closed = false;
+  broken = false;
+  struct stat status;
+  isPipe = (fstat(fd, &status) == 0) && S_ISFIFO(status.st_mode);
+#ifdef __linux__
+  mapBlocks = isPipe && getenv("DSPP_VMSPLICE");
+#else
+  mapBlocks = false;
+#endif
+  block = blockSize();
+  readBlock = 0;
+  readStart = 0;
+  readEnd = 0;
+  writeIndex = 0;
+  writeEnd = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+unsigned char * FdStream::allocateBlock(void) {
+  void * memory = 0;
+  if (posix_memalign(&memory, 4096, block)) {
+    fprintf(stderr, "could not allocate a %zu byte stream block\n", block);
+    exit(-1);
+  }
+  return reinterpret_cast<unsigned char *>(memory);
+}
+
+/* ---------------------------------------------------------------------- */
+//  Called before a read that may block.  Output held back for a larger
+//  write is passed on first if no input is ready, so a slow or bursty source
+//  does not add the block time to the latency of the stages after this one.
+void FdStream::waitingForInput(void) {
+  Stream * output = Stream::output();
+  if (output == this || output->pending() == 0) return;
+  struct pollfd ready = { fd, POLLIN, 0 };
+  if (poll(&ready, 1, 0) == 0) output->flush();
+}
+
+/* ---------------------------------------------------------------------- */
+size_t FdStream::read(void * buffer, size_t size, size_t count) {
+  if (closed) return 0;
+  unsigned char * destination = reinterpret_cast<unsigned char *>(buffer);
+  size_t wanted = size * count;
+  size_t got = readEnd - readStart;
+  if (got > wanted) got = wanted;
+  if (got > 0) {
+    memcpy(destination, readBlock + readStart, got);
+    readStart += got;
+  }
+  while (got < wanted) {
+    waitingForInput();
+    ssize_t amount;
+    if (wanted - got >= block) {  // large requests bypass the block
+      amount = ::read(fd, destination + got, wanted - got);
+    } else {
+      if (!readBlock) readBlock = allocateBlock();
+      amount = ::read(fd, readBlock, block);
+      if (amount > 0) {
+        readEnd = amount;
+        readStart = (wanted - got < readEnd) ? wanted - got : readEnd;
+        memcpy(destination + got, readBlock, readStart);
+        amount = readStart;
+      }
+    }
+    if (amount < 0 && errno == EINTR) continue;
+    if (amount <= 0) break;
+    got += amount;
+  }
+  // as with fread, a partial item at the end of the stream is discarded
+  return got / size;
+}
+
+/* ---------------------------------------------------------------------- */
+bool FdStream::writeAll(const unsigned char * data, size_t bytes) {
+  while (bytes > 0) {
+    ssize_t amount = ::write(fd, data, bytes);
+    if (amount < 0) {
+      if (errno == EINTR) continue;
+      broken = true;
+      return false;
+    }
+    data += amount;
+    bytes -= amount;
+  }
+  return true;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Hand whole pages of data to the pipe by reference.  Returns the number of
+//  bytes mapped, which is less than bytes if the pipe will not take them.
+size_t FdStream::mapAll(unsigned char * data, size_t bytes) {
+  size_t mapped = 0;
+#ifdef __linux__
+  while (mapped < bytes) {
+    struct iovec piece = { data + mapped, bytes - mapped };
+    ssize_t amount = vmsplice(fd, &piece, 1, 0);
+    if (amount < 0) {
+      if (errno == EINTR) continue;
+      break;
+    }
+    mapped += amount;
+  }
+#endif
+  return mapped;
+}
+
+/* ---------------------------------------------------------------------- */
+//  A mapped block stays in use until the reader has drained it from the
+//  pipe.  Each full block fills block / page pipe slots, so cycling through
+//  enough blocks to cover the pipe capacity plus the block being filled
+//  guarantees a block has left the pipe before it is written again.  The
+//  reader can enlarge the pipe at any time, so the size is checked each step.
+void FdStream::nextWriteBlock(void) {
+#ifdef __linux__
+  int pipeSize = fcntl(fd, F_GETPIPE_SZ);
+  size_t needed = (pipeSize > 0 ? pipeSize : 0) / block + 2;
+  if (needed > writeBlocks.size()) {
+    // fresh blocks go next in line so the ones still in the pipe age further
+    writeBlocks.insert(writeBlocks.begin() + writeIndex + 1, needed - writeBlocks.size(),
+                       reinterpret_cast<unsigned char *>(0));
+  }
+#endif
+  writeIndex = (writeIndex + 1) % writeBlocks.size();
+  if (!writeBlocks[writeIndex]) writeBlocks[writeIndex] = allocateBlock();
+}
+
+/* ---------------------------------------------------------------------- */
+//  Pass memory that stays unchanged for as long as the process lives, such
+//  as a read only file mapping, into a pipe by reference instead of copying
+//  it.  Anything held back by write goes first, by copy.
+size_t FdStream::writeMapped(const void * buffer, size_t bytes) {
+  if (closed || broken) return 0;
+  if (!isPipe) return write(buffer, 1, bytes);
+  flush();
+  unsigned char * data = const_cast<unsigned char *>(reinterpret_cast<const unsigned char *>(buffer));
+  size_t mapped = mapAll(data, bytes);
+  if (mapped < bytes) writeAll(data + mapped, bytes - mapped);
+  return broken ? 0 : bytes;
+}
+
+/* ---------------------------------------------------------------------- */
+void FdStream::flush(void) {
+  if (writeEnd == 0) return;
+  unsigned char * current = writeBlocks[writeIndex];
+  size_t bytes = writeEnd;
+  writeEnd = 0;
+  if (broken) return;
+  // only full blocks are mapped - the block accounting above depends on it
+  size_t mapped = (mapBlocks && bytes == block) ? mapAll(current, bytes) : 0;
+  if (mapped < bytes) {
+    if (mapped == 0 && mapBlocks && bytes == block) mapBlocks = false;  // pipe refuses pages
+    writeAll(current + mapped, bytes - mapped);
+  }
+  if (mapped > 0) nextWriteBlock();
+}
+
+/* ---------------------------------------------------------------------- */
+size_t FdStream::write(const void * buffer, size_t size, size_t count) {
+  if (closed || broken) return 0;
+  const unsigned char * source = reinterpret_cast<const unsigned char *>(buffer);
+  size_t bytes = size * count;
+  if (writeBlocks.empty()) writeBlocks.push_back(allocateBlock());
+  if (writeEnd + bytes < block) {
+    memcpy(writeBlocks[writeIndex] + writeEnd, source, bytes);
+    writeEnd += bytes;
+    return count;
+  }
+  if (writeEnd > 0) {  // top up the held block and pass it on
+    size_t fill = block - writeEnd;
+    memcpy(writeBlocks[writeIndex] + writeEnd, source, fill);
+    writeEnd = block;
+    flush();
+    source += fill;
+    bytes -= fill;
+  }
+  size_t direct = bytes - bytes % block;
+  if (direct > 0) {
+    writeAll(source, direct);
+    source += direct;
+    bytes -= direct;
+  }
+  memcpy(writeBlocks[writeIndex], source, bytes);
+  writeEnd = bytes;
+  return broken ? 0 : count;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Pass data through without it entering user space when either end is a
+//  pipe.  Anything already read ahead goes first, then splice moves the rest
+//  a block at a time.  A destination that wraps a descriptor, such as a
+//  statistics probe, is told what went past it.
+size_t FdStream::transferTo(Stream * destination, size_t bytes) {
+#ifdef __linux__
+  FdStream * to = destination->fdStream();
+  if (to && !closed && !to->closed && (isPipe || to->isPipe)) {
+    size_t moved = readEnd - readStart;
+    if (moved > bytes) moved = bytes;
+    if (moved > 0) {
+      to->write(readBlock + readStart, sizeof(unsigned char), moved);
+      readStart += moved;
+    }
+    to->flush();
+    destination->kernelStarting();
+    while (moved < bytes && !to->broken) {
+      size_t amount = (bytes - moved < block) ? bytes - moved : block;
+      ssize_t spliced = splice(fd, NULL, to->fd, NULL, amount, SPLICE_F_MOVE | SPLICE_F_MORE);
+      if (spliced < 0) {
+        if (errno == EINTR) continue;
+        if (errno == EINVAL) {
+          destination->kernelMoved(moved);
+          return moved + Stream::transferTo(destination, bytes - moved);
+        }
+        to->broken = true;
+        break;
+      }
+      if (spliced == 0) break;
+      moved += spliced;
+    }
+    destination->kernelMoved(moved);
+    return moved;
+  }
+#endif
+  return Stream::transferTo(destination, bytes);
+}
+
+/* ---------------------------------------------------------------------- */
+void FdStream::close(void) {
+  if (!closed) {
+    flush();
+    closed = true;
+    ::close(fd);
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+//  Blocks that were mapped into a pipe may still be referenced by it, so
+//  the write blocks are only released when none were mapped.
+FdStream::~FdStream(void) {
+  if (!closed) flush();
+  if (readBlock) free(readBlock);
+  if (writeBlocks.size() == 1) free(writeBlocks[0]);
+}
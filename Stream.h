@@ -0,0 +1,94 @@
+#ifndef STREAM_H_
+#define STREAM_H_
+/*
+ *      Stream.h - sample stream endpoints used by the dspp stages.  A stage
+ *                 reads from Stream::input() and writes to Stream::output().
+ *                 Standalone, these are standard input and output; inside a
+ *                 pipeline they are in memory links to the neighboring stages.
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+/* ---------------------------------------------------------------------- */
+class FdStream;
+
+class Stream {
+ public:
+  // read and write follow fread/fwrite conventions - the return value is the
+  // number of complete items transferred and a short count means end of stream
+  virtual size_t read(void * buffer, size_t size, size_t count) = 0;
+  virtual size_t write(const void * buffer, size_t size, size_t count) = 0;
+  virtual void close(void) = 0;
+  // written data may be held back to make larger transfers - flush passes it
+  // on now, and pending reports how much is being held
+  virtual void flush(void) {}
+  virtual size_t pending(void) { return 0; }
+  // copy up to bytes unchanged to destination, returning the number copied;
+  // fewer than requested means end of stream
+  virtual size_t transferTo(Stream * destination, size_t bytes);
+  // the descriptor stream this one is or wraps, for moving data with the
+  // kernel's zero copy calls, or zero; data moved that way is reported with
+  // kernelStarting before the call and kernelMoved after it, so that a
+  // wrapper can count it
+  virtual FdStream * fdStream(void) { return 0; }
+  virtual void kernelStarting(void) {}
+  virtual void kernelMoved(size_t bytes) {}
+  virtual ~Stream(void) {}
+
+  static Stream * input(void);   // endpoints of the calling thread
+  static Stream * output(void);
+  static void bind(Stream * input, Stream * output);
+  static Stream * standardInput(void);
+  static Stream * standardOutput(void);
+  static size_t blockSize(void);  // bytes per system call, DSPP_BLOCK_SIZE overrides
+};
+
+/* ---------------------------------------------------------------------- */
+//  Stream on a file descriptor using read and write system calls on large
+//  aligned blocks.  Small reads and writes are served from the block; large
+//  ones go straight to or from the caller's memory.  When the descriptor is a
+//  pipe, transferTo moves data with splice, and if DSPP_VMSPLICE is set,
+//  output blocks are mapped into the pipe with vmsplice instead of copied.
+class FdStream : public Stream {
+ private:
+  int fd;
+  bool closed;
+  bool broken;                         // a write failed, such as to a closed pipe
+  bool isPipe;
+  bool mapBlocks;                      // vmsplice output blocks
+  size_t block;
+  unsigned char * readBlock;
+  size_t readStart;                    // unread bytes are readBlock[readStart, readEnd)
+  size_t readEnd;
+  std::vector<unsigned char *> writeBlocks;  // more than one only when mapping blocks
+  size_t writeIndex;
+  size_t writeEnd;                     // bytes held in writeBlocks[writeIndex]
+
+  unsigned char * allocateBlock(void);
+  void waitingForInput(void);
+  bool writeAll(const unsigned char * data, size_t bytes);
+  size_t mapAll(unsigned char * data, size_t bytes);
+  void nextWriteBlock(void);
+
+ public:
+  size_t read(void * buffer, size_t size, size_t count);
+  size_t write(const void * buffer, size_t size, size_t count);
+  void close(void);
+  void flush(void);
+  size_t pending(void) { return writeEnd; }
+  size_t transferTo(Stream * destination, size_t bytes);
+  size_t writeMapped(const void * buffer, size_t bytes);
+  FdStream * fdStream(void) { return this; }
+  int descriptor(void) { return fd; }
+  bool onPipe(void) { return isPipe; }
+  size_t readAhead(void) { return readEnd - readStart; }
+  explicit FdStream(int fd);
+  ~FdStream(void);
+};
+#endif  // STREAM_H_
@@ -0,0 +1,217 @@
+/*
+ *      TeeBranch.cc - side branch of the tee command
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <errno.h>
+#include <fcntl.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#include "TeeBranch.h"
+/* ---------------------------------------------------------------------- */
+TeeBranch::TeeBranch(const char * commandLine, bool nonBlocking) {
+  this->nonBlocking = nonBlocking;
+  command = popen(commandLine, "w");
+  open = (command != 0);
+  if (!open) perror("tee could not start side command");
+  fd = open ? fileno(command) : -1;
+  nullFd = ::open("/dev/null", O_WRONLY);
+  pipeSize = 65536;
+#ifdef __linux__
+  if (open) {
+    int size = fcntl(fd, F_GETPIPE_SZ);
+    if (size > 0) pipeSize = size;
+  }
+#endif
+  // the side pipe's room is only estimated from the bytes in it, so a non
+  // blocking branch relies on EAGAIN to never wait for the side command
+  if (open && nonBlocking) fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  unitRemaining = 0;
+  unitDropping = false;
+  unitHolding = false;
+  held = reinterpret_cast<unsigned char *>(malloc(DROP_UNIT));
+  heldBytes = 0;
+  droppedUnits = 0;
+}
+
+/* ---------------------------------------------------------------------- */
+//  The branch takes or skips the stream a whole number of units at a time so
+//  that a skip never splits a sample.  A non blocking branch takes as many
+//  units as its pipe seems to have room for and skips a unit when there is
+//  no room, that is, when the side command is not keeping up.  The end of a
+//  unit held back by fallBehind is sent first, and until it has gone the
+//  units after it are skipped.
+void TeeBranch::startUnit(void) {
+  bool caughtUp = sendHeld();
+  unitRemaining = SIZE_MAX;
+  unitHolding = false;
+  unitDropping = !open;
+  if (open && nonBlocking) {
+    int queued = pipeSize;
+    if (caughtUp && ioctl(fd, FIONREAD, &queued) != 0) queued = 0;
+    size_t room = (pipeSize > (size_t) queued) ? pipeSize - queued : 0;
+    unitRemaining = room / DROP_UNIT * DROP_UNIT;
+    if (unitRemaining == 0) {
+      unitRemaining = DROP_UNIT;
+      unitDropping = true;
+      droppedUnits++;
+    }
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+//  The side pipe filled part way through what startUnit took, which a count
+//  of bytes in the pipe does not foresee when the pipe's slots hold small
+//  writes.  At the start of a unit the unit is skipped; part way through
+//  one the rest of it is held back, so the side command never sees part of
+//  a unit.
+void TeeBranch::fallBehind(void) {
+  size_t unitLeft = (unitRemaining - 1) % DROP_UNIT + 1;
+  if (unitLeft == DROP_UNIT) {
+    unitDropping = true;
+    droppedUnits++;
+  } else {
+    unitHolding = true;
+  }
+  unitRemaining = unitLeft;
+}
+
+/* ---------------------------------------------------------------------- */
+//  True when nothing is held back any more.
+bool TeeBranch::sendHeld(void) {
+  while (heldBytes > 0) {
+    ssize_t amount = ::write(fd, held, heldBytes);
+    if (amount < 0 && errno == EINTR) continue;
+    if (amount < 0 && errno == EAGAIN) return false;
+    if (amount <= 0) {  // the side command has gone away
+      open = false;
+      heldBytes = 0;
+      break;
+    }
+    heldBytes -= amount;
+    memmove(held, held + amount, heldBytes);
+  }
+  return true;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Copy path - data has already been read into user space.
+void TeeBranch::write(const unsigned char * data, size_t bytes) {
+  while (bytes > 0) {
+    if (unitRemaining == 0) startUnit();
+    size_t piece = (bytes < unitRemaining) ? bytes : unitRemaining;
+    size_t done = piece;
+    bool behind = false;
+    if (unitHolding) {
+      memcpy(held + heldBytes, data, piece);
+      heldBytes += piece;
+    } else if (!unitDropping) {
+      for (done = 0; done < piece; ) {
+        ssize_t amount = ::write(fd, data + done, piece - done);
+        if (amount < 0 && errno == EINTR) continue;
+        if (amount < 0 && errno == EAGAIN) {
+          behind = true;
+          break;
+        }
+        if (amount <= 0) {  // the side command has gone away
+          open = false;
+          unitDropping = true;
+          done = piece;
+          break;
+        }
+        done += amount;
+      }
+    }
+    data += done;
+    bytes -= done;
+    unitRemaining -= done;
+    if (behind) fallBehind();
+  }
+}
+
+/* ---------------------------------------------------------------------- */
+bool TeeBranch::discard(int in, size_t bytes) {
+  while (bytes > 0) {
+    ssize_t amount = -1;
+#ifdef __linux__
+    amount = splice(in, NULL, nullFd, NULL, bytes, SPLICE_F_MOVE);
+#endif
+    if (amount < 0 && errno == EINTR) continue;
+    if (amount < 0) {  // /dev/null without splice support
+      unsigned char scratch[DROP_UNIT];
+      amount = read(in, scratch, (bytes < DROP_UNIT) ? bytes : DROP_UNIT);
+    }
+    if (amount <= 0) return false;
+    bytes -= amount;
+  }
+  return true;
+}
+
+/* ---------------------------------------------------------------------- */
+//  Kernel path - exactly bytes are consumed from the input pipe, which tee(2)
+//  has already duplicated to the main output, and moved to the side pipe
+//  with splice without passing through user space.
+bool TeeBranch::spliceFrom(int in, size_t bytes) {
+  while (bytes > 0) {
+    if (unitRemaining == 0) startUnit();
+    size_t piece = (bytes < unitRemaining) ? bytes : unitRemaining;
+    size_t done = 0;
+    bool behind = false;
+    if (unitHolding) {
+      while (done < piece) {
+        ssize_t amount = read(in, held + heldBytes + done, piece - done);
+        if (amount < 0 && errno == EINTR) continue;
+        if (amount <= 0) return false;
+        done += amount;
+      }
+      heldBytes += piece;
+    } else {
+#ifdef __linux__
+      unsigned int flags = nonBlocking ? SPLICE_F_MOVE | SPLICE_F_NONBLOCK : SPLICE_F_MOVE;
+      while (!unitDropping && done < piece) {
+        ssize_t amount = splice(in, NULL, fd, NULL, piece - done, flags);
+        if (amount < 0 && errno == EINTR) continue;
+        if (amount < 0 && errno == EAGAIN) {
+          behind = true;
+          break;
+        }
+        if (amount <= 0) {  // the side command has gone away
+          open = false;
+          unitDropping = true;
+          break;
+        }
+        done += amount;
+      }
+#endif
+      if (!behind && done < piece) {
+        if (!discard(in, piece - done)) return false;
+        done = piece;
+      }
+    }
+    bytes -= done;
+    unitRemaining -= done;
+    if (behind) fallBehind();
+  }
+  return true;
+}
+
+/* ---------------------------------------------------------------------- */
+TeeBranch::~TeeBranch(void) {
+  if (droppedUnits) {
+    fprintf(stderr, "tee side branch fell behind and skipped %zu blocks of %zu bytes\n", droppedUnits, DROP_UNIT);
+  }
+  if (heldBytes && open) {  // the last unit is finished, waiting for the side command now
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) & ~O_NONBLOCK);
+    sendHeld();
+  }
+  if (command) pclose(command);
+  if (nullFd >= 0) close(nullFd);
+  free(held);
+}
@@ -0,0 +1,47 @@
+#ifndef TEEBRANCH_H_
+#define TEEBRANCH_H_
+/*
+ *      TeeBranch.h - side branch of the tee command: a shell command fed a
+ *                    copy of the stream, optionally without ever blocking
+ *                    the main stream
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <stddef.h>
+#include <stdio.h>
+/* ---------------------------------------------------------------------- */
+class TeeBranch {
+ public:
+  static const size_t DROP_UNIT = 4096;  // a multiple of every sample size
+
+ private:
+  FILE * command;
+  int fd;
+  int nullFd;                          // where the branch's share goes when it is not taken
+  bool nonBlocking;
+  bool open;
+  size_t pipeSize;
+  size_t unitRemaining;                // bytes left to take or skip before checking again
+  bool unitDropping;
+  bool unitHolding;                    // the rest of a unit goes to held
+  unsigned char * held;                // the end of a unit the side pipe had no room for
+  size_t heldBytes;
+  size_t droppedUnits;
+
+  void startUnit(void);
+  void fallBehind(void);
+  bool sendHeld(void);
+  bool discard(int in, size_t bytes);
+
+ public:
+  bool isOpen(void) { return open; }
+  void write(const unsigned char * data, size_t bytes);
+  bool spliceFrom(int in, size_t bytes);
+  TeeBranch(const char * commandLine, bool nonBlocking);
+  ~TeeBranch(void);
+};
+#endif  // TEEBRANCH_H_
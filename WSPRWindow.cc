@@ -22,6 +22,7 @@
 #include "SpotCandidate.h"
 #include "WSPRWindow.h"
 #include "WSPRUtilities.h"
+#include "Stream.h"
 //#define SELFTEST 1
 
 /* ---------------------------------------------------------------------- */
@@ -424,13 +425,13 @@ void WSPRWindow::doWork() {
         // Before reading another sample set, disard the remaining samples associated with the previous 2 minute block
         fprintf(stderr, "Discarding %d unused samples of last 2 minute window\n",
                 (PERIOD - PROCESSING_SIZE) * BASE_BAND * 2);
-        fread(remainsOf2Min, sizeof(float), (PERIOD - PROCESSING_SIZE) * BASE_BAND * 2, stdin);
+        Stream::input()->read(remainsOf2Min, sizeof(float), (PERIOD - PROCESSING_SIZE) * BASE_BAND * 2);
       }
       fprintf(stderr, "allocating window IQ memory - %ld bytes\n", (int)freq  * sizeof(float) * 2 * PROCESSING_SIZE);
       now = time(0);
       entry = {now, reinterpret_cast<float *> (malloc((int)freq * sizeof(float) * 2 * PROCESSING_SIZE))};
       fprintf(stderr, "\nCollecting %d samples at %ld - %s", sampleBufferSize, now - baseTime, ctime(&now));
-      if ((count = fread(entry.data, sizeof(float), PROCESSING_SIZE * BASE_BAND * 2, stdin)) == 0) {
+      if ((count = Stream::input()->read(entry.data, sizeof(float), PROCESSING_SIZE * BASE_BAND * 2)) == 0) {
         fprintf(stderr, "Input read was empty, sleeping for a while at %s", ctime(&now));
         sleep(1.0); 
         if (background == 0) { // kick off a queued buffer
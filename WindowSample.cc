@@ -17,6 +17,7 @@
 #include <time.h>
 #include <unistd.h>
 #include "WindowSample.h"
+#include "Stream.h"
 //#define SELFTEST 1
 
 /* ---------------------------------------------------------------------- */
@@ -69,7 +70,7 @@ void WindowSample::doWork() {
     }
     gettimeofday(&tv, NULL);
     while (justBefore != ( tv.tv_sec % modulo) || tv.tv_usec < 960000) {  // wait here until time to sample
-      fread(IQSamples, sizeof(uint8_t), BUFFER_SIZE, stdin);  // skip samples
+      Stream::input()->read(IQSamples, sizeof(uint8_t), BUFFER_SIZE);  // skip samples
       gettimeofday(&tv, NULL);  
     }
     done = false;
@@ -128,8 +129,8 @@ void WindowSample::doWork() {
       }
       fprintf( stderr, "countsHigh %d, countsLow %d, correction %d\n", countsHigh, countsLow, correction);
       while (accumulator < samplesInPeriod && count != 0) {
-        count = fread(IQSamples, sizeof(uint8_t), BUFFER_SIZE, stdin);
-        fwrite(IQSamples, sizeof(uint8_t), BUFFER_SIZE, stdout);
+        count = Stream::input()->read(IQSamples, sizeof(uint8_t), BUFFER_SIZE);
+        Stream::output()->write(IQSamples, sizeof(uint8_t), BUFFER_SIZE);
         accumulator += count;
       }
       done =  count == 0 || done;
@@ -19,9 +19,13 @@
 #include <errno.h>
 #include <string.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <cinttypes>
 #include <time.h>
 #include <unistd.h>
 #include <getopt.h>
+#include <signal.h>
+#include <string>
 
 #include <sys/ioctl.h>
 
@@ -32,6 +36,9 @@
 static const char USAGE_STR[] = "\n"
         "Usage: %s <command> [ parameter 1 [ ... parameter n]]\n"
         "  -h                          : help\n"
+        "  --stats[=file]              : with any command, report samples/s, compute and blocked time,\n"
+        "                                short reads and longest block on stderr or to file\n"
+        "                                (every DSPP_STATS_INTERVAL seconds, default 10, and at the end)\n"
         "  convert_byte_sInt16         : convert little endian byte stream to internal short ints\n"
         "  convert_byte_f              : convert a signed byte stream to internal floating point\n"
         "  convert_uByte_f             : convert a unsigned byte stream to internal floating point\n"
@@ -39,8 +46,16 @@ static const char USAGE_STR[] = "\n"
         "  shift_frequency_cc          : recenter a signal by x cycles per sample\n"
         "  shift_frequency_uByte_uByte : recenter a signal (raw RTL) by x cycles per sample\n"
         "  fsSlash4_byte_byte          : mix / shift frequency by fs/4\n"
+        "  fsSlash4_byte_c             : shift frequency by fs/4 and decimate by 2 with a half-band filter\n"
+        "                                [passband [dB]]\n"
         "  decimate_cc                 : replace every n samples with 1 (complex)\n"
+        "                                (-p inputRate outputRate passband stopband [dB]: plan and run\n"
+        "                                a cascade of CIC, half-band and FIR stages)\n"
         "  fmdemod_cf                  : demodulate FM signal\n"
+        "  wbfm_demod                  : demodulate broadcast FM to audio\n"
+        "                                inputRate audioRate [de-emphasis us (75)]\n"
+        "  nbfm_demod                  : demodulate narrow band FM to audio\n"
+        "                                inputRate audioRate [de-emphasis us (0)]\n"
         "  decimate_ff                 : replace every n samples with 1 (real)\n"
         "  convert_f_uInt16            : convert a float(real) stream into an unsigned short stream\n"
         "  convert_f_sInt16            : convert a float(real) stream into an signed short stream\n"
@@ -50,15 +65,22 @@ static const char USAGE_STR[] = "\n"
         "  custom_fir_cc               : FIR filter a complex stream\n"
         "  sfir_cc                     : Smooth FIR filter a complex stream\n"
         "  comb_byte_c                 : Comb filter a complex stream\n"
+        "                                decimation [order [delay [compensation taps]]]\n"
+        "  comb_uByte_c                : Comb filter a complex unsigned byte (RTL) stream, arguments as comb_byte_c\n"
+        "  ddc_uByte_cc                : shift, filter and decimate a complex unsigned byte (RTL) stream\n"
+        "                                shift cutoff taps decimation\n"
         "  sfir_ff                     : Smooth FIR filter a real stream\n"
         "  real_to_complex_fc          : real stream to complex stream\n"
         "  real_to_quadrature_fc       : real stream to complex quadrature stream\n"
+        "                                [-H [-d]] analytic signal by Hilbert transform, -d shifted down a quarter of the rate and decimated by 2\n"
         "  fmmod_fc                    : real stream FM modulated quadrature (I/Q) stream\n"
+        "                                sampleRate [deviation Hz (5000)]\n"
         "  head                        : take first n bytes of stream\n"
         "  tail                        : take bytes after n bytes of stream\n"
         "  convert_sInt16_f            : convert a signed short stream to a float(real) stream\n"
         "  fft_cc                      : convert a complex stream to a complex stream in the frequency domain\n"
         "  tee                         : tee stream to another stream\n"
+        "                                [-n] never let the other stream block this one\n"
         "  sfir_cc                     : smooth fir filter, complex stream to complex stream\n"
         "  sfir_ff                     : smooth fir filter, float(real) stream to float stream\n"
         "  real_of_complex_cf          : real(float) part of complex stream to float stream\n"
@@ -66,12 +88,33 @@ static const char USAGE_STR[] = "\n"
         "  gain                        : multiply float/complex by scalar\n"
         "  limit_real_stream           : limit a floating point stream between -1.0 and 1.0\n"
         "  dc_removal                  : remove average value of the stream\n"
+        "  dc_block_ff                 : remove the DC of a real stream with a one-pole estimate\n"
+        "                                [timeConstant] in samples, default 16384\n"
+        "  dc_block_cc                 : remove the DC of each channel of an I/Q stream and correct I/Q imbalance\n"
+        "                                [timeConstant [imbalanceTimeConstant]] in pairs, 0 for no correction\n"
         "  agc                         : automatic gain control, sustain a fixed average level\n"
+        "                                target [attack decay [lookahead]] time constants and delay in samples\n"
         "  split_stream                : split input stream into multiple streams\n"
+        "                                [-b] wait for the slowest stream (default) or [-d] drop data for it\n"
         "  FT8Window                   : find FT8 spots in a FT8 window\n"
         "  WSPRWindow                  : find WSPR spots in a WSPR window\n"
         "  WindowSample                : Synchronize a sampling window to a clock\n"
-        "  convert_f_byte              : convert a float stream to a signed byte stream\n";
+        "  convert_f_byte              : convert a float stream to a signed byte stream\n"
+        "  convert_f_shm               : write a float stream to a named shared memory ring\n"
+        "  convert_shm_f               : read a float stream from a named shared memory ring\n"
+        "  frame_wrap                  : add a header and numbered frames to a sample stream\n"
+        "                                type channels sampleRate [centerFrequency]\n"
+        "  frame_unwrap                : strip the framing, reporting any missing samples\n"
+        "                                [-z] fill missing samples with zeros [type] check the sample type\n"
+        "  file_source                 : stream a recording through a memory map\n"
+        "                                [-r bytesPerSecond] pace to real time, path [offset [length]]\n"
+        "  file_sink                   : write a stream to a recording through a memory map\n"
+        "  halfband_cc                 : decimate a complex stream by 2 with a half-band filter\n"
+        "                                [passband [dB]] passband a fraction of the input rate, default 0.2 and 80\n"
+        "  halfband_ff                 : decimate a real stream by 2 with a half-band filter\n"
+        "  pipeline                    : run a \"command | command ...\" chain inside one process\n"
+        "                                [-a] pin each stage to its own core\n"
+        "                                [-r seconds] report link fill levels periodically\n";
 
 static struct option longOpts[] = {
   { "convert_byte_sInt16"        , no_argument, NULL, 1 },
@@ -112,6 +155,22 @@ static struct option longOpts[] = {
   { "convert_f_byte"             , no_argument, NULL, 41 },
   { "FT8Window"                  , no_argument, NULL, 42 },
   { "real_to_quadrature_fc"      , no_argument, NULL, 43 },
+  { "pipeline"                   , no_argument, NULL, 44 },
+  { "convert_f_shm"              , no_argument, NULL, 45 },
+  { "convert_shm_f"              , no_argument, NULL, 46 },
+  { "frame_wrap"                 , no_argument, NULL, 47 },
+  { "frame_unwrap"               , no_argument, NULL, 48 },
+  { "file_source"                , no_argument, NULL, 49 },
+  { "file_sink"                  , no_argument, NULL, 50 },
+  { "halfband_cc"                , no_argument, NULL, 51 },
+  { "halfband_ff"                , no_argument, NULL, 52 },
+  { "comb_uByte_c"               , no_argument, NULL, 53 },
+  { "ddc_uByte_cc"               , no_argument, NULL, 54 },
+  { "fsSlash4_byte_c"            , no_argument, NULL, 55 },
+  { "wbfm_demod"                 , no_argument, NULL, 56 },
+  { "nbfm_demod"                 , no_argument, NULL, 57 },
+  { "dc_block_ff"                , no_argument, NULL, 58 },
+  { "dc_block_cc"                , no_argument, NULL, 59 },
   { NULL, 0, NULL, 0 }
 };
 
@@ -126,18 +185,22 @@ static struct option longOpts[] = {
 
 /* ---------------------------------------------------------------------- */
 
-#ifdef LE_MACHINE
 int dspp::convert_byte_sInt16() {
-
-  union encode {
-    char bytes[2];
-    short integer;
-  } piece;
-
-  const int byteBufferSize = sizeof(piece.bytes);
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
+  const int BUFFER_SIZE = 4096;
+  uint8_t bytes[2 * BUFFER_SIZE];
+  int16_t integers[BUFFER_SIZE];
+  int count;
   for (;;) {
-    fread(&piece.bytes, sizeof(char), byteBufferSize, stdin);
-    fwrite(&piece.integer, sizeof(short), 1, stdout);
+    count = inputStream->read(&bytes, sizeof(bytes[0]), sizeof(bytes)) / 2;
+    Convert::littleEndian16(bytes, integers, count);
+    outputStream->write(&integers, sizeof(int16_t), count);
+    if (count < BUFFER_SIZE) {
+      fprintf(stderr, "Short data stream, convert_byte_sInt16\n");
+      outputStream->close();
+      return 0;
+    }
   }
 
   return 0;
@@ -145,97 +208,343 @@ int dspp::convert_byte_sInt16() {
 }
 
 /* ---------------------------------------------------------------------- */
-#else
-
-int dspp::convert_byte_sInt16() {
+/*
+ *      convert_byte_f.c -- DSP Pipe - byte(signed) stream to float
+ *
+ *      Copyright (C) 2019 
+ *          Mark Broihier
+ *
+ */
 
-  union encode {
-    char bytes[2];
-    short integer;
-  } piece;
+/* ---------------------------------------------------------------------- */
 
+int dspp::convert_byte_f() {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
+  const int BUFFER_SIZE = 4096;
+  int8_t in[BUFFER_SIZE];
+  float out[BUFFER_SIZE];
+  int count;
   for (;;) {
-    fread(&piece.bytes[1], sizeof(char), 1, stdin);
-    fread(&piece.bytes[0], sizeof(char), 1, stdin);
-    fwrite(&piece.integer, sizeof(short), 1, stdout);
+    count = inputStream->read(&in, sizeof(int8_t), BUFFER_SIZE);
+    if (count < BUFFER_SIZE) {
+      fprintf(stderr, "Short data stream, convert_byte_f\n");
+      outputStream->close();
+      return 0;
+    }
+    Convert::byteToFloat(in, out, BUFFER_SIZE);
+    outputStream->write(&out, sizeof(float), BUFFER_SIZE);
   }
 
   return 0;
 
 }
-#endif
-
 /* ---------------------------------------------------------------------- */
 /*
- *      convert_byte_f.c -- DSP Pipe - byte(signed) stream to float
+ *      convert_f_byte.c -- DSP Pipe - float stream to byte(signed) stream
  *
- *      Copyright (C) 2019 
+ *      Copyright (C) 2023
  *          Mark Broihier
  *
  */
 
 /* ---------------------------------------------------------------------- */
 
-int dspp::convert_byte_f() {
+int dspp::convert_f_byte() {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
-  signed char c[BUFFER_SIZE];
-  float f[BUFFER_SIZE];
+  float in[BUFFER_SIZE];
+  int8_t out[BUFFER_SIZE];
   int count;
-  float * fptr;
-  signed char * cptr;
   for (;;) {
-    count = fread(&c, sizeof(char), BUFFER_SIZE, stdin);
-    if(count < BUFFER_SIZE) {
-      fprintf(stderr, "Short data stream, convert_byte_f\n");
-      fclose(stdout);
+    count = inputStream->read(&in, sizeof(float), BUFFER_SIZE);
+    Convert::floatToByte(in, out, count);
+    outputStream->write(&out, sizeof(int8_t), count);
+    if (count < BUFFER_SIZE) {
+      fprintf(stderr, "Short data stream, convert_f_byte\n");
+      outputStream->close();
       return 0;
     }
-    cptr = c;
-    fptr = f;
-    for (int i=0; i < BUFFER_SIZE; i++) {
-      *fptr++ = *cptr++/128.0 ;
-    }
-    fwrite(&f, sizeof(float), BUFFER_SIZE, stdout);
   }
 
   return 0;
 
 }
+
 /* ---------------------------------------------------------------------- */
 /*
- *      convert_f_byte.c -- DSP Pipe - float stream to byte(signed) stream
+ *      convert_f_shm.cc -- DSP Pipe - float stream to a shared memory ring
  *
- *      Copyright (C) 2023
+ *      Copyright (C) 2026
  *          Mark Broihier
  *
+ *  Passes the stream to another dspp process, started with convert_shm_f
+ *  and the same name, through a named POSIX shared memory ring instead of a
+ *  kernel pipe.
  */
 
 /* ---------------------------------------------------------------------- */
 
-int dspp::convert_f_byte() {
+int dspp::convert_f_shm(const char * name, int size) {
+  Stream * inputStream = Stream::input();
   const int BUFFER_SIZE = 4096;
-  int8_t sbyte[BUFFER_SIZE];
   float f[BUFFER_SIZE];
-  int count;
-  float * fptr;
-  int8_t * cptr;
+  size_t count;
+  ShmRing ring(name, ShmRing::WRITER, size);
+  if (!ring.isOpen()) {
+    inputStream->close();
+    return 0;
+  }
+  Stream * ringStream = ring.writer();
   for (;;) {
-    count = fread(&f, sizeof(float), BUFFER_SIZE, stdin);
-    cptr = sbyte;
-    fptr = f;
-    for (int i=0; i < count; i++) {
-      *cptr++ = *fptr++ ;
+    count = inputStream->read(&f, sizeof(float), BUFFER_SIZE);
+    if (ringStream->write(&f, sizeof(float), count) < count) {
+      fprintf(stderr, "shared memory ring reader has closed, convert_f_shm\n");
+      break;
     }
-    fwrite(&sbyte, sizeof(int8_t), count, stdout);
     if(count < BUFFER_SIZE) {
-      fprintf(stderr, "Short data stream, convert_f_byte\n");
-      fclose(stdout);
-      return 0;
+      fprintf(stderr, "Short data stream, convert_f_shm\n");
+      break;
+    }
+  }
+  ringStream->close();
+  inputStream->close();
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/*
+ *      convert_shm_f.cc -- DSP Pipe - shared memory ring to float stream
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ */
+
+/* ---------------------------------------------------------------------- */
+
+int dspp::convert_shm_f(const char * name) {
+  Stream * outputStream = Stream::output();
+  const int BUFFER_SIZE = 4096;
+  float f[BUFFER_SIZE];
+  size_t count;
+  // a reader killed by SIGPIPE would leave the writer waiting for it, so
+  // see the broken pipe as a failed write and close the ring instead
+  signal(SIGPIPE, SIG_IGN);
+  ShmRing ring(name, ShmRing::READER);
+  if (!ring.isOpen()) {
+    outputStream->close();
+    return 0;
+  }
+  Stream * ringStream = ring.reader();
+  for (;;) {
+    count = ringStream->read(&f, sizeof(float), BUFFER_SIZE);
+    if (outputStream->write(&f, sizeof(float), count) < count) break;
+    if(count < BUFFER_SIZE) {
+      fprintf(stderr, "Short data stream, convert_shm_f\n");
+      break;
+    }
+  }
+  ringStream->close();
+  outputStream->close();
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/*
+ *      frame_wrap.cc -- DSP Pipe - raw sample stream to framed stream
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  Puts a header describing the samples in front of the stream and carries
+ *  the samples in frames numbered with the index of their first sample (see
+ *  FrameFormat.h).
+ */
+
+/* ---------------------------------------------------------------------- */
+
+int dspp::frame_wrap(const char * sampleType, int channels, double sampleRate, double centerFrequency) {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
+  int type = FrameFormat::typeFromName(sampleType);
+  if (type == 0) {
+    fprintf(stderr, "frame_wrap: unknown sample type %s\n", sampleType);
+    inputStream->close();
+    outputStream->close();
+    return 0;
+  }
+  FrameWriter writer(outputStream, type, channels, sampleRate, centerFrequency);
+  const int BUFFER_SIZE = FrameFormat::PAYLOAD_SIZE;
+  unsigned char buffer[BUFFER_SIZE];
+  if (writer.writeHeader()) {
+    for (;;) {
+      size_t count = inputStream->read(buffer, 1, BUFFER_SIZE);
+      if (!writer.write(buffer, count)) break;
+      if (count < (size_t) BUFFER_SIZE) {
+        fprintf(stderr, "Short data stream, frame_wrap\n");
+        writer.close();
+        break;
+      }
+    }
+  }
+  inputStream->close();
+  outputStream->close();
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/*
+ *      frame_unwrap.cc -- DSP Pipe - framed stream to raw sample stream
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  Strips the framing, checking the sample type if one is given.  Samples
+ *  missing between frames are counted and reported, and with zeroFill they
+ *  are replaced with zero samples so that the output stays sample accurate.
+ */
+
+/* ---------------------------------------------------------------------- */
+
+int dspp::frame_unwrap(const char * sampleType, bool zeroFill) {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
+  FrameReader reader(inputStream);
+  if (reader.readHeader()) {
+    const FrameFormat::StreamHeader & format = reader.format();
+    fprintf(stderr, "frame_unwrap: %s samples, %d channel(s), %.0f samples/s, center %.0f Hz\n",
+            FrameFormat::typeName(format.sampleType), format.channels, format.sampleRate, format.centerFrequency);
+    if (sampleType && FrameFormat::typeFromName(sampleType) != (int) format.sampleType) {
+      fprintf(stderr, "frame_unwrap: expected %s samples but the stream has %s samples\n",
+              sampleType, FrameFormat::typeName(format.sampleType));
+    } else {
+      unsigned char zeros[FrameFormat::PAYLOAD_SIZE];
+      memset(zeros, 0, sizeof(zeros));
+      size_t fillBytes = sizeof(zeros) / reader.bytesPerSample() * reader.bytesPerSample();
+      for (;;) {
+        size_t bytes;
+        uint64_t missing;
+        const unsigned char * payload = reader.next(bytes, missing);
+        if (!payload) break;
+        if (zeroFill) {
+          for (uint64_t fill = missing * reader.bytesPerSample(); fill > 0; ) {
+            size_t piece = (fill < fillBytes) ? fill : fillBytes;
+            if (outputStream->write(zeros, 1, piece) < piece) break;
+            fill -= piece;
+          }
+        }
+        if (outputStream->write(payload, 1, bytes) < bytes) break;
+      }
+      if (reader.numberOfGaps()) {
+        fprintf(stderr, "frame_unwrap: %" PRIu64 " samples missing in %" PRIu64 " gaps%s\n", reader.missing(), reader.numberOfGaps(),
+                zeroFill ? ", filled with zeros" : "");
+      }
     }
   }
+  inputStream->close();
+  outputStream->close();
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/*
+ *      file_source.cc -- DSP Pipe - recording to stream through a memory map
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  Streams length bytes (all when zero) of a recording, starting offset
+ *  bytes in.  Into a pipe, the mapped pages are passed by reference rather
+ *  than copied.  With a non zero bytesPerSecond the recording is paced to
+ *  that rate, as it was when it was captured.
+ */
+
+/* ---------------------------------------------------------------------- */
 
+int dspp::file_source(const char * path, off_t offset, off_t length, double bytesPerSecond) {
+  Stream * outputStream = Stream::output();
+  if (offset < 0 || length < 0) {
+    fprintf(stderr, "file_source: offset and length can not be negative\n");
+    outputStream->close();
+    return 0;
+  }
+  MappedFile file(path, MappedFile::READ);
+  off_t end = file.size();
+  if (length > 0 && offset + length < end) end = offset + length;
+  if (!file.isOpen() || offset > end) {
+    if (file.isOpen()) fprintf(stderr, "file_source: offset is past the end of %s\n", path);
+    outputStream->close();
+    return 0;
+  }
+  FdStream * pipe = outputStream->fdStream();
+  if (pipe && !pipe->onPipe()) pipe = 0;
+  // paced replay sends about every 10 milliseconds
+  size_t chunk = MappedFile::WINDOW_SIZE;
+  if (bytesPerSecond > 0.0) {
+    chunk = (size_t) (bytesPerSecond / 100.0) / 4096 * 4096;
+    if (chunk == 0) chunk = 4096;
+  }
+  struct timespec start;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (off_t position = offset; position < end; ) {
+    size_t bytes = (end - position < (off_t) chunk) ? end - position : chunk;
+    const unsigned char * data = file.view(position, bytes);
+    if (!data) break;
+    if (bytesPerSecond > 0.0) {
+      double due = (position - offset) / bytesPerSecond;
+      struct timespec deadline = start;
+      deadline.tv_sec += (time_t) due;
+      deadline.tv_nsec += (long) ((due - (time_t) due) * 1e9);
+      if (deadline.tv_nsec >= 1000000000) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000;
+      }
+      while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, 0) == EINTR) {}
+    }
+    size_t sent;
+    if (pipe) {
+      outputStream->kernelStarting();
+      sent = pipe->writeMapped(data, bytes);
+      outputStream->kernelMoved(sent);
+    } else {
+      sent = outputStream->write(data, 1, bytes);
+    }
+    if (sent < bytes) break;
+    if (bytesPerSecond > 0.0) outputStream->flush();  // paced data goes on now
+    position += bytes;
+  }
+  outputStream->close();
   return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/*
+ *      file_sink.cc -- DSP Pipe - stream to recording through a memory map
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  The stream is read straight into the mapped file.
+ */
+
+/* ---------------------------------------------------------------------- */
 
+int dspp::file_sink(const char * path) {
+  Stream * inputStream = Stream::input();
+  MappedFile file(path, MappedFile::WRITE);
+  size_t block = Stream::blockSize();
+  for (;;) {
+    size_t room = block;
+    unsigned char * destination = file.reserve(room);
+    if (!destination) break;
+    size_t count = inputStream->read(destination, 1, room);
+    file.commit(count);
+    if (count < room) break;
+  }
+  inputStream->close();
+  return 0;
 }
 
 /* ---------------------------------------------------------------------- */
@@ -250,25 +559,21 @@ int dspp::convert_f_byte() {
 /* ---------------------------------------------------------------------- */
 
 int dspp::convert_uByte_f() {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
-  unsigned char c[BUFFER_SIZE];
-  float f[BUFFER_SIZE];
+  uint8_t in[BUFFER_SIZE];
+  float out[BUFFER_SIZE];
   int count;
-  float * fptr;
-  unsigned char * cptr;
   for (;;) {
-    count = fread(&c, sizeof(char), BUFFER_SIZE, stdin);
-    if(count < BUFFER_SIZE) {
+    count = inputStream->read(&in, sizeof(uint8_t), BUFFER_SIZE);
+    if (count < BUFFER_SIZE) {
       fprintf(stderr, "Short data stream, convert_uByte_f\n");
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
-    cptr = c;
-    fptr = f;
-    for (int i=0; i < BUFFER_SIZE; i++) {
-      *fptr++ = (*cptr++ - 128)/128.0;
-    }
-    fwrite(&f, sizeof(float), BUFFER_SIZE, stdout);
+    Convert::uByteToFloat(in, out, BUFFER_SIZE);
+    outputStream->write(&out, sizeof(float), BUFFER_SIZE);
   }
 
   return 0;
@@ -286,26 +591,21 @@ int dspp::convert_uByte_f() {
 /* ---------------------------------------------------------------------- */
 
 int dspp::convert_uByte_byte() {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
-  unsigned char c[BUFFER_SIZE];
-  char b[BUFFER_SIZE];
+  uint8_t in[BUFFER_SIZE];
+  int8_t out[BUFFER_SIZE];
   int count;
-  char * bptr;
-  unsigned char * cptr;
   for (;;) {
-    count = fread(&c, sizeof(char), BUFFER_SIZE, stdin);
-    if(count < BUFFER_SIZE) {
-      fwrite(&b, sizeof(char), count, stdout);
+    count = inputStream->read(&in, sizeof(uint8_t), BUFFER_SIZE);
+    Convert::uByteToByte(in, out, count);
+    outputStream->write(&out, sizeof(int8_t), count);
+    if (count < BUFFER_SIZE) {
       fprintf(stderr, "Short data stream, convert_uByte_byte\n");
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
-    cptr = c;
-    bptr = b;
-    for (int i=0; i < BUFFER_SIZE; i++) {
-      *bptr++ = *cptr++ - 128;
-    }
-    fwrite(&b, sizeof(char), BUFFER_SIZE, stdout);
   }
 
   return 0;
@@ -326,65 +626,37 @@ int dspp::convert_uByte_byte() {
 /* ---------------------------------------------------------------------- */
 
 int dspp::shift_frequency_cc(float amount) {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
   float f[BUFFER_SIZE];
-  float of[BUFFER_SIZE];
   int count;
-  float * fptr, * ofptr;
-  float sinDeltaAmount = sin(amount*2.0*M_PI);
-  float cosDeltaAmount = cos(amount*2.0*M_PI);
-  float phase = 0.0;
-  float cosAmount = 1.0;
-  float sinAmount = 0.0;
-  float newCosAmount;
-  float newSinAmount;
-
-  float I;
-  float Q;
-
-  fprintf(stderr, "cycles per sample correction: %f\n", amount);
+  /*
+    Assuming I is r*cos(2*PI*fc*t) and
+             Q is -r*sin(2*PI*fc*t)  where fc is the center frequency the signal r is sampled at
+
+    Then to to recenter to a new frequency fs, use the trigonometric identities:
+      cos(a + b) = cos(a)*cos(b) - sin(a)*sin(b)
+      sin(a + b) = sin(a)*cos(b) + cos(a)*sin(b)
+
+    shifted I = I * cos(2*PI*fs*t) + Q * sin(2*PI*fs*t)
+    shifted Q = Q * cos(2*PI*fs*t) - I * sin(2*PI*fs*t)
+
+    The NCO keeps 2*PI*fs*t as an exact phase accumulator, so the angle
+    carries over from one buffer to the next without a jump.
+   */
+  NCO oscillator(amount);
+
+  fprintf(stderr, "cycles per sample correction: %f%s\n", amount, oscillator.tableDriven() ? ", table NCO" : "");
   for (;;) {
-    count = fread(&f, sizeof(float), BUFFER_SIZE, stdin);
+    count = inputStream->read(&f, sizeof(float), BUFFER_SIZE);
     if(count == 0) {
       fprintf(stderr, "End of data stream, shift_frequency_cc\n");
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
-    fptr = f;
-    ofptr = of;
-
-    for (int i=0; i < count; i+=2) {
-      /*
-        Assuming I is r*cos(2*PI*fc*t) and
-                 Q is -r*sin(2*PI*fc*t)  where fc is the center frequency the signal r is sampled at
-
-        Then to to recenter to a new frequency fs, use the trigonometric identities:
-          cos(a + b) = cos(a)*cos(b) - sin(a)*sin(b)
-          sin(a + b) = sin(a)*cos(b) + cos(a)*sin(b)
-
-        shifted I = I * cos(2*PI*fs*t) + Q * sin(2*PI*fs*t)
-        shifted Q = Q * cos(2*PI*fs*t) - I * sin(2*PI*fs*t)
-
-        To advance the sin/cos 2*PI*fs*t functions, the sin/cos of sum of angles identities are again 
-        used. Since each sample is separated by a fixed delta of time, successively applying the 
-        identities advances the angle/time.
-
-       */
-      I = *fptr++;
-      Q = *fptr++;
-      *ofptr++ = I * cosAmount + Q * sinAmount;
-      *ofptr++ = Q * cosAmount - I * sinAmount;
-      newCosAmount = cosAmount * cosDeltaAmount - sinAmount * sinDeltaAmount;
-      newSinAmount = sinAmount * cosDeltaAmount + cosAmount * sinDeltaAmount;
-      cosAmount = newCosAmount;
-      sinAmount = newSinAmount;
-    }
-    fwrite(&of, sizeof(float), count, stdout);
-    phase += cosDeltaAmount * count / 2.0;
-    while(phase > M_PI) phase -= 2.0 * M_PI;   // taken from CSDR
-    while(phase < -M_PI) phase += 2.0 * M_PI;
-    cosAmount = cos(phase);
-    sinAmount = sin(phase);
+    oscillator.shift(f, f, count / 2);
+    outputStream->write(&f, sizeof(float), count);
   }
 
   return 0;
@@ -405,65 +677,31 @@ int dspp::shift_frequency_cc(float amount) {
 /* ---------------------------------------------------------------------- */
 
 int dspp::shift_frequency_uByteuByte(float amount) {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
   unsigned char b[BUFFER_SIZE];
   unsigned char ob[BUFFER_SIZE];
+  float f[BUFFER_SIZE];
   int count;
-  unsigned char * ubptr, * uobptr;
-  float sinDeltaAmount = sin(amount*2.0*M_PI);
-  float cosDeltaAmount = cos(amount*2.0*M_PI);
-  float phase = 0.0;
-  float cosAmount = 1.0;
-  float sinAmount = 0.0;
-  float newCosAmount;
-  float newSinAmount;
-
-  float I;
-  float Q;
-
-  fprintf(stderr, "cycles per sample correction: %f\n", amount);
+  NCO oscillator(amount);  // see shift_frequency_cc
+
+  fprintf(stderr, "cycles per sample correction: %f%s\n", amount, oscillator.tableDriven() ? ", table NCO" : "");
   for (;;) {
-    count = fread(&b, sizeof(char), BUFFER_SIZE, stdin);
+    count = inputStream->read(&b, sizeof(char), BUFFER_SIZE);
     if(count < BUFFER_SIZE) {
       fprintf(stderr, "Short data stream, shift_frequency_uByteuByte\n");
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
-    ubptr = b;
-    uobptr = ob;
-
-    for (int i=0; i < BUFFER_SIZE; i+=2) {
-      /*
-        Assuming I is r*cos(2*PI*fc*t) and
-                 Q is -r*sin(2*PI*fc*t)  where fc is the center frequency the signal r is sampled at
-
-        Then to to recenter to a new frequency fs, use the trigonometric identities:
-          cos(a + b) = cos(a)*cos(b) - sin(a)*sin(b)
-          sin(a + b) = sin(a)*cos(b) + cos(a)*sin(b)
-
-        shifted I = I * cos(2*PI*fs*t) + Q * sin(2*PI*fs*t)
-        shifted Q = Q * cos(2*PI*fs*t) - I * sin(2*PI*fs*t)
-
-        To advance the sin/cos 2*PI*fs*t functions, the sin/cos of sum of angles identities are again 
-        used. Since each sample is separated by a fixed delta of time, successively applying the 
-        identities advances the angle/time.
-
-       */
-      I = (*ubptr++ - 128)/128.0;
-      Q = (*ubptr++ - 128)/128.0;
-      *uobptr++ = (I * cosAmount + Q * sinAmount)*128.0 + 128;
-      *uobptr++ = (Q * cosAmount - I * sinAmount)*128.0 + 128;
-      newCosAmount = cosAmount * cosDeltaAmount - sinAmount * sinDeltaAmount;
-      newSinAmount = sinAmount * cosDeltaAmount + cosAmount * sinDeltaAmount;
-      cosAmount = newCosAmount;
-      sinAmount = newSinAmount;
-    }
-    fwrite(&ob, sizeof(char), BUFFER_SIZE, stdout);
-    phase += cosDeltaAmount * count / 2.0;
-    while(phase > M_PI) phase -= 2.0 * M_PI;   // taken from CSDR
-    while(phase < -M_PI) phase += 2.0 * M_PI;
-    cosAmount = cos(phase);
-    sinAmount = sin(phase);
+    for (int i = 0; i < BUFFER_SIZE; i++) {
+      f[i] = (b[i] - 128) / 128.0f;
+    }
+    oscillator.shift(f, f, BUFFER_SIZE / 2);
+    for (int i = 0; i < BUFFER_SIZE; i++) {
+      ob[i] = f[i] * 128.0f + 128;
+    }
+    outputStream->write(&ob, sizeof(char), BUFFER_SIZE);
   }
 
   return 0;
@@ -483,29 +721,26 @@ int dspp::shift_frequency_uByteuByte(float amount) {
 /* ---------------------------------------------------------------------- */
 
 int dspp::fsSlash4_byte_byte() {
-  const int BUFFER_SIZE = 8;
-  char b[BUFFER_SIZE];
-  char ob[BUFFER_SIZE];
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
+  const int BUFFER_SIZE = 1 << 16;  // a multiple of the 8 byte mixing cycle
+  signed char * b = reinterpret_cast<signed char *>(malloc(BUFFER_SIZE));
+  signed char * ob = reinterpret_cast<signed char *>(malloc(BUFFER_SIZE));
   int count;
 
-  fprintf(stderr, "fs/4 mix\n");
+  fprintf(stderr, "fs/4 mix with %s shuffles\n", FsSlash4::implementation());
   for (;;) {
-    count = fread(&b, sizeof(char), BUFFER_SIZE, stdin);
+    count = inputStream->read(b, sizeof(char), BUFFER_SIZE);
+    int cycles = count / 8;
+    FsSlash4::rotate(b, ob, cycles);
+    outputStream->write(ob, sizeof(char), cycles * 8);
     if(count < BUFFER_SIZE) {
       fprintf(stderr, "Short data stream, fsSlash_byte_byte\n");
-      fclose(stdout);
+      outputStream->close();
+      free(b);
+      free(ob);
       return 0;
     }
-    ob[0] = b[0];
-    ob[1] = b[1];
-    ob[2] = -b[3];
-    ob[3] = b[2];
-    ob[4] = -b[4];
-    ob[5] = -b[5];
-    ob[6] = b[7];
-    ob[7] = -b[6];
-
-    fwrite(&ob, sizeof(char), BUFFER_SIZE, stdout);
   }
 
   return 0;
@@ -532,6 +767,16 @@ int dspp::decimate_cc(float cutOffFrequency, int M, int amount, int N, const cha
 
 }
 
+/* ---------------------------------------------------------------------- */
+int dspp::decimate_cc(double inputRate, double outputRate, double passband, double stopband, double attenuation) {
+
+  MultiStageDecimator decimator(inputRate, outputRate, passband, stopband, attenuation);
+  decimator.filterSignal();
+
+  return 0;
+
+}
+
 /* ---------------------------------------------------------------------- */
 /*
  *      fmdemod_cf.cc -- DSP Pipe - demodulate a FM signal
@@ -578,6 +823,8 @@ int dspp::decimate_cc(float cutOffFrequency, int M, int amount, int N, const cha
 
 /* ---------------------------------------------------------------------- */
 int dspp::fmdemod_cf() {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 2048;
   float f[BUFFER_SIZE];
   const int HALF_BUFFER_SIZE = BUFFER_SIZE / 2;
@@ -599,10 +846,10 @@ int dspp::fmdemod_cf() {
   float Qsquared;
 
   for (;;) {
-    count = fread(&f, sizeof(char), fSize, stdin);
+    count = inputStream->read(&f, sizeof(char), fSize);
     if(count < fSize) {
       fprintf(stderr, "Short data stream, fmdemod_cf\n");
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
     ofptr = of;
@@ -620,7 +867,7 @@ int dspp::fmdemod_cf() {
       lastI = I;
       lastQ = Q;
     }
-    fwrite(&of, sizeof(char), ofSize, stdout);
+    outputStream->write(&of, sizeof(char), ofSize);
   }
   return 0;
 
@@ -670,25 +917,21 @@ int dspp::decimate_ff(float cutOffFrequency, int M, int amount, int N, const cha
 /* ---------------------------------------------------------------------- */
 
 int dspp::convert_f_uInt16() {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
-  unsigned short uin[BUFFER_SIZE];
-  float f[BUFFER_SIZE];
+  float in[BUFFER_SIZE];
+  uint16_t out[BUFFER_SIZE];
   int count;
-  float * fptr;
-  unsigned short * iptr;
   for (;;) {
-    count = fread(&f, sizeof(float), BUFFER_SIZE, stdin);
-    if(count < BUFFER_SIZE) {
+    count = inputStream->read(&in, sizeof(float), BUFFER_SIZE);
+    if (count < BUFFER_SIZE) {
       fprintf(stderr, "Short data stream, convert_f_uInt16\n");
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
-    iptr = uin;
-    fptr = f;
-    for (int i=0; i < BUFFER_SIZE; i++) {
-      *iptr++ = (*fptr++ + 1.0) * 32767.0;
-    }
-    fwrite(&uin, sizeof(short), BUFFER_SIZE, stdout);
+    Convert::floatToUInt16(in, out, BUFFER_SIZE);
+    outputStream->write(&out, sizeof(uint16_t), BUFFER_SIZE);
   }
 
   return 0;
@@ -708,25 +951,21 @@ int dspp::convert_f_uInt16() {
 /* ---------------------------------------------------------------------- */
 
 int dspp::convert_f_sInt16() {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
-  short sin[BUFFER_SIZE];
-  float f[BUFFER_SIZE];
+  float in[BUFFER_SIZE];
+  int16_t out[BUFFER_SIZE];
   int count;
-  float * fptr;
-  short * iptr;
   for (;;) {
-    count = fread(&f, sizeof(float), BUFFER_SIZE, stdin);
-    if(count < BUFFER_SIZE) {
+    count = inputStream->read(&in, sizeof(float), BUFFER_SIZE);
+    if (count < BUFFER_SIZE) {
       fprintf(stderr, "Short data stream, convert_f_sInt16\n");
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
-    iptr = sin;
-    fptr = f;
-    for (int i=0; i < BUFFER_SIZE; i++) {
-      *iptr++ = *fptr++ * 32767.0;
-    }
-    fwrite(&sin, sizeof(short), BUFFER_SIZE, stdout);
+    Convert::floatToSInt16(in, out, BUFFER_SIZE);
+    outputStream->write(&out, sizeof(int16_t), BUFFER_SIZE);
   }
 
   return 0;
@@ -745,27 +984,22 @@ int dspp::convert_f_sInt16() {
 /* ---------------------------------------------------------------------- */
 
 int dspp::convert_sInt16_f() {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
-  short sin[BUFFER_SIZE];
-  float f[BUFFER_SIZE];
+  int16_t in[BUFFER_SIZE];
+  float out[BUFFER_SIZE];
   int count;
-  float * fptr;
-  short * iptr;
-  float scale = 1.0 / 32767.0;
   for (;;) {
-    count = fread(&sin, sizeof(short), BUFFER_SIZE, stdin);
-    if(count < BUFFER_SIZE) {
+    count = inputStream->read(&in, sizeof(int16_t), BUFFER_SIZE);
+    if (count < BUFFER_SIZE) {
       fprintf(stderr, "Short data stream, convert_sInt16_f\n");
       fprintf(stderr, "shorts: %d\n", count);
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
-    iptr = sin;
-    fptr = f;
-    for (int i=0; i < BUFFER_SIZE; i++) {
-      *fptr++ = *iptr++ * scale;
-    }
-    fwrite(&f, sizeof(float), BUFFER_SIZE, stdout);
+    Convert::sInt16ToFloat(in, out, BUFFER_SIZE);
+    outputStream->write(&out, sizeof(float), BUFFER_SIZE);
   }
 
   return 0;
@@ -853,6 +1087,8 @@ int dspp::custom_fir_cc(const char * filePath, int M, int N, FIRFilter::WindowTy
 
 /* ---------------------------------------------------------------------- */
 int dspp::real_to_complex_fc() {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
   float signal[BUFFER_SIZE];
   float complexSignal[BUFFER_SIZE*2];
@@ -861,10 +1097,10 @@ int dspp::real_to_complex_fc() {
   float * signalPtr;
   float * complexSignalPtr;
   for (;;) {
-    numberRead = fread(&signal, sizeof(float), BUFFER_SIZE, stdin);
+    numberRead = inputStream->read(&signal, sizeof(float), BUFFER_SIZE);
     if(numberRead < BUFFER_SIZE) {
       fprintf(stderr, "Short data stream, real_to_complex_fc\n");
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
     signalPtr = signal;
@@ -873,7 +1109,7 @@ int dspp::real_to_complex_fc() {
       *complexSignalPtr++ = *signalPtr++;
       *complexSignalPtr++ = 0.0;
     }
-    fwrite(&complexSignal, sizeof(float), BUFFER_SIZE*2, stdout);
+    outputStream->write(&complexSignal, sizeof(float), BUFFER_SIZE*2);
   }
 
   return 0;
@@ -888,11 +1124,11 @@ int dspp::real_to_complex_fc() {
  */
 
 /* ---------------------------------------------------------------------- */
-int dspp::real_to_quadrature_fc(bool selector) {
+int dspp::real_to_quadrature_fc(bool selector, bool decimate) {
   const int BUFFER_SIZE = 256;
   RealToQuadrature rtqo(BUFFER_SIZE);
   if (selector) {
-    rtqo.processSampleSetHilbert();
+    rtqo.processSampleSetHilbert(decimate);
   } else {
     rtqo.processSampleSetDownconversion();
   }
@@ -909,6 +1145,8 @@ int dspp::real_to_quadrature_fc(bool selector) {
 
 /* ---------------------------------------------------------------------- */
 int dspp::real_of_complex_cf() {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
   float signal[BUFFER_SIZE];
   float complexSignal[BUFFER_SIZE*2];
@@ -917,10 +1155,10 @@ int dspp::real_of_complex_cf() {
   float * signalPtr;
   float * complexSignalPtr;
   for (;;) {
-    numberRead = fread(&complexSignal, sizeof(float), BUFFER_SIZE*2, stdin);
+    numberRead = inputStream->read(&complexSignal, sizeof(float), BUFFER_SIZE*2);
     if(numberRead < BUFFER_SIZE*2) {
       fprintf(stderr, "Short data stream, real_of_complex_cf\n");
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
     signalPtr = signal;
@@ -929,7 +1167,7 @@ int dspp::real_of_complex_cf() {
       *signalPtr++ = *complexSignalPtr++;
       complexSignalPtr++;
     }
-    fwrite(&signal, sizeof(float), BUFFER_SIZE, stdout);
+    outputStream->write(&signal, sizeof(float), BUFFER_SIZE);
   }
 
   return 0;
@@ -946,6 +1184,8 @@ int dspp::real_of_complex_cf() {
 
 /* ---------------------------------------------------------------------- */
 int dspp::mag_cf() {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
   float signal[BUFFER_SIZE*2];
   float mag[BUFFER_SIZE];
@@ -954,10 +1194,10 @@ int dspp::mag_cf() {
   float * magPtr;
   float  * complexSignalPtr;
   for (;;) {
-    numberRead = fread(&signal, sizeof(float), BUFFER_SIZE*2, stdin);
+    numberRead = inputStream->read(&signal, sizeof(float), BUFFER_SIZE*2);
     if(numberRead < BUFFER_SIZE) {
       fprintf(stderr, "Short data stream, mag_cf\n");
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
     magPtr = mag;
@@ -967,7 +1207,7 @@ int dspp::mag_cf() {
       float j = *complexSignalPtr++;
       *magPtr++ = sqrt(r * r + j * j);
     }
-    fwrite(&mag, sizeof(float), BUFFER_SIZE, stdout);
+    outputStream->write(&mag, sizeof(float), BUFFER_SIZE);
   }
 
   return 0;
@@ -984,6 +1224,8 @@ int dspp::mag_cf() {
 
 /* ---------------------------------------------------------------------- */
 int dspp::gain(float gain) {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
   float signal[BUFFER_SIZE];
   float amplifiedSignal[BUFFER_SIZE];
@@ -992,10 +1234,10 @@ int dspp::gain(float gain) {
   float * amplifiedSignalPtr;
   float  * signalPtr;
   for (;;) {
-    numberRead = fread(&signal, sizeof(float), BUFFER_SIZE, stdin);
+    numberRead = inputStream->read(&signal, sizeof(float), BUFFER_SIZE);
     if(numberRead < BUFFER_SIZE) {
       fprintf(stderr, "Short data stream, gain\n");
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
     signalPtr = signal;
@@ -1003,7 +1245,7 @@ int dspp::gain(float gain) {
     for (int i=0; i < BUFFER_SIZE; i++) {
       *amplifiedSignalPtr++ = *signalPtr++ * gain;
     }
-    fwrite(&amplifiedSignal, sizeof(float), BUFFER_SIZE, stdout);
+    outputStream->write(&amplifiedSignal, sizeof(float), BUFFER_SIZE);
   }
 
   return 0;
@@ -1021,6 +1263,8 @@ int dspp::gain(float gain) {
 
 /* ---------------------------------------------------------------------- */
 int dspp::limit_real_stream() {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
   float signal[BUFFER_SIZE];
   float output[BUFFER_SIZE];
@@ -1029,10 +1273,10 @@ int dspp::limit_real_stream() {
   float * outputPtr;
   float  * signalPtr;
   for (;;) {
-    numberRead = fread(&signal, sizeof(float), BUFFER_SIZE, stdin);
+    numberRead = inputStream->read(&signal, sizeof(float), BUFFER_SIZE);
     if(numberRead < BUFFER_SIZE) {
       fprintf(stderr, "Short data stream, limit_real_stream\n");
-      fclose(stdout);
+      outputStream->close();
       return 0;
     }
     signalPtr = signal;
@@ -1048,7 +1292,7 @@ int dspp::limit_real_stream() {
       }
       *outputPtr++ = r;
     }
-    fwrite(&output, sizeof(float), BUFFER_SIZE, stdout);
+    outputStream->write(&output, sizeof(float), BUFFER_SIZE);
   }
 
   return 0;
@@ -1065,6 +1309,8 @@ int dspp::limit_real_stream() {
 
 /* ---------------------------------------------------------------------- */
 int dspp::dc_removal(float * buffer, int size) {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   float * signal = reinterpret_cast<float *>(malloc(sizeof(float)* size));
   float * output = reinterpret_cast<float *>(malloc(sizeof(float)* size));
   float accumulator = 0.0;
@@ -1075,10 +1321,10 @@ int dspp::dc_removal(float * buffer, int size) {
   float * bufferPtr;
   float scale = 1.0 / size;
   for (;;) {
-    numberRead = fread(signal, sizeof(float), size, stdin);
+    numberRead = inputStream->read(signal, sizeof(float), size);
     if(numberRead < size) {
       fprintf(stderr, "Short data stream, dc_removal\n");
-      fclose(stdout);
+      outputStream->close();
       free(signal);
       free(output);
       return 0;
@@ -1092,7 +1338,7 @@ int dspp::dc_removal(float * buffer, int size) {
       *outputPtr++ = *signalPtr - accumulator * scale;  // remove average
       *bufferPtr++ = *signalPtr++;
     }
-    fwrite(output, sizeof(float), size, stdout);
+    outputStream->write(output, sizeof(float), size);
     //fprintf(stderr, "bias = %f\n", accumulator * scale);
   }
 
@@ -1110,13 +1356,13 @@ int dspp::dc_removal(float * buffer, int size) {
 
 /* ---------------------------------------------------------------------- */
 int dspp::agc(float target) {
-  AGC * agcObject;
-  agcObject = new AGC(target);
-  if (! agcObject) {
-    fprintf(stderr, "AGC object creation failed\n");
-  } else {
-    agcObject->doWork();
-  }
+  return agc(target, AGC::DEFAULT_ATTACK, AGC::DEFAULT_DECAY, 0);
+}
+
+/* ---------------------------------------------------------------------- */
+int dspp::agc(float target, float attack, float decay, int lookahead) {
+  AGC agcObject(target, attack, decay, lookahead);
+  agcObject.doWork();
   return 0;
 }
 
@@ -1133,44 +1379,26 @@ int dspp::agc(float target) {
 /* ---------------------------------------------------------------------- */
 
 int dspp::head(int amount) {
-  const int BUFFER_SIZE = 4096;
-  int count = 0;
-  unsigned char bytes[BUFFER_SIZE];
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   if (amount > 0) {
     fprintf(stderr, "Limiting data to %d bytes, head\n", amount);
   } else {
     fprintf(stderr, "unsupported size: %d bytes, head\n", amount);
-    fclose(stdin);
-    fclose(stdout);
+    inputStream->close();
+    outputStream->close();
     return 0;
   }
-    
-  for (;;) {
-    count = fread(&bytes, sizeof(unsigned char), BUFFER_SIZE, stdin);
-    if(count < BUFFER_SIZE) {
-      fprintf(stderr, "Short data stream, head\n");
-      fwrite(&bytes, sizeof(unsigned char), count, stdout);
-      fclose(stdout);
-      return 0;
-    }
-    if (amount > count) {
-      fwrite(&bytes, sizeof(unsigned char), count, stdout);
-    } else {
-      if (amount > 0) {
-        fwrite(&bytes, sizeof(unsigned char), amount, stdout);
-      } else {
-        fprintf(stderr, "Done with writes, head\n");
-        break;
-      }
-    }
-    amount -= BUFFER_SIZE;
-    if (amount < 1) {
-      break;
-    }
+  // the bytes are passed through unchanged, so let the stream move them
+  // without copying where it can
+  if (inputStream->transferTo(outputStream, amount) < (size_t) amount) {
+    fprintf(stderr, "Short data stream, head\n");
+    outputStream->close();
+    return 0;
   }
-  fprintf(stderr, "Loop terminated, head\n");
-  fclose(stdin);
-  fclose(stdout);
+  fprintf(stderr, "Done with writes, head\n");
+  inputStream->close();
+  outputStream->close();
   return 0;
 }
 /* ---------------------------------------------------------------------- */
@@ -1185,36 +1413,22 @@ int dspp::head(int amount) {
 /* ---------------------------------------------------------------------- */
 
 int dspp::tail(int amount) {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
-  int count = 0;
-  int offset = 0;
   unsigned char bytes[BUFFER_SIZE];
-  bool skipPhase = true;
-  for (;;) {
-    count = fread(&bytes, sizeof(unsigned char), BUFFER_SIZE, stdin);
-    if(count < BUFFER_SIZE) {
-      if (count == 0) {
-        fprintf(stderr, "Short data stream, tail\n");
-        fwrite(&bytes, sizeof(unsigned char), count, stdout);
-        fclose(stdout);
-        return 0;
-      }
-    }
-    if (skipPhase) {
-      amount -= count;
-      if (amount <= 1) {
-        offset = count + amount;
-        count -= offset;
-        //fprintf(stderr, "writing %d bytes from bytes[%d]\n", count, offset);
-        fwrite(&bytes[offset], sizeof(unsigned char), count, stdout);
-        skipPhase = false;
-      }
-    } else {
-        fwrite(&bytes, sizeof(unsigned char), count, stdout);
+  while (amount > 0) {
+    int skip = (amount < BUFFER_SIZE) ? amount : BUFFER_SIZE;
+    if (inputStream->read(&bytes, sizeof(unsigned char), skip) < (size_t) skip) {
+      fprintf(stderr, "Short data stream, tail\n");
+      outputStream->close();
+      return 0;
     }
+    amount -= skip;
   }
-  fprintf(stderr, "Internal error path - should not get here, tail\n");
-  fclose(stdout);
+  inputStream->transferTo(outputStream, SIZE_MAX);
+  fprintf(stderr, "Short data stream, tail\n");
+  outputStream->close();
   return 0;
 }
 /* ---------------------------------------------------------------------- */
@@ -1240,33 +1454,55 @@ int dspp::fft_cc(int numberOfComplexSamples) {
  *      Copyright (C) 2019 
  *          Mark Broihier
  *
+ *  When the input and output are both pipes, the stream is duplicated in
+ *  the kernel: tee(2) copies it to the output without consuming it and
+ *  splice(2) then moves it to the side command.  Otherwise it is copied
+ *  through user space.  With a non blocking side branch, the side command
+ *  loses data when it falls behind rather than slowing the main stream.
  */
 
 /* ---------------------------------------------------------------------- */
 
-int dspp::tee(char * otherStream) {
+int dspp::tee(char * otherStream, bool nonBlocking) {
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   const int BUFFER_SIZE = 4096;
   int count = 0;
   unsigned char bytes[BUFFER_SIZE];
-  FILE * otherPath;
-  otherPath = popen(otherStream, "w");
-  for (;;) {
-    count = fread(&bytes, sizeof(unsigned char), BUFFER_SIZE, stdin);
-    if(count < BUFFER_SIZE) {
-      if (count == 0) {
-        fprintf(stderr, "Short data stream, tee\n");
-        fwrite(&bytes, sizeof(unsigned char), count, stdout);
-        fwrite(&bytes, sizeof(unsigned char), count, otherPath);
-        fclose(stdout);
-        pclose(otherPath);
-        return 0;
-      }
+  // a closed output or side command should end a write, not the process
+  sigset_t brokenPipe;
+  sigemptyset(&brokenPipe);
+  sigaddset(&brokenPipe, SIGPIPE);
+  pthread_sigmask(SIG_BLOCK, &brokenPipe, 0);
+  TeeBranch side(otherStream, nonBlocking);
+#ifdef __linux__
+  FdStream * in = inputStream->fdStream();
+  FdStream * out = outputStream->fdStream();
+  if (in && out && in->onPipe() && out->onPipe() && in->readAhead() == 0) {
+    fprintf(stderr, "Duplicating stream in the kernel, tee\n");
+    outputStream->flush();
+    for (;;) {
+      inputStream->kernelStarting();
+      ssize_t duplicated = ::tee(in->descriptor(), out->descriptor(), Stream::blockSize(), 0);
+      inputStream->kernelMoved(duplicated > 0 ? duplicated : 0);
+      outputStream->kernelMoved(duplicated > 0 ? duplicated : 0);
+      if (duplicated < 0 && errno == EINTR) continue;
+      if (duplicated <= 0) break;  // end of input, or the output has closed
+      if (!side.spliceFrom(in->descriptor(), duplicated)) break;
     }
-    fwrite(&bytes, sizeof(unsigned char), count, stdout);
-    fwrite(&bytes, sizeof(unsigned char), count, otherPath);
+    fprintf(stderr, "Short data stream, tee\n");
+    outputStream->close();
+    return 0;
+  }
+#endif
+  for (;;) {
+    count = inputStream->read(&bytes, sizeof(unsigned char), BUFFER_SIZE);
+    if (count == 0) break;
+    if (outputStream->write(&bytes, sizeof(unsigned char), count) < (size_t) count) break;
+    side.write(bytes, count);
   }
-  fprintf(stderr, "Internal error path - should not get here, tail\n");
-  fclose(stdout);
+  fprintf(stderr, "Short data stream, tee\n");
+  outputStream->close();
   return 0;
 }
 /* ---------------------------------------------------------------------- */
@@ -1277,97 +1513,108 @@ int dspp::tee(char * otherStream) {
  *      Copyright (C) 2022
  *          Mark Broihier
  *
+ *  The input is read once into a ring in shared memory.  Each output
+ *  command is fed by its own process that writes from the ring, in place,
+ *  at its own cursor.  With -b (the default) the input waits for the
+ *  slowest command; with -d a command that falls a ring behind loses data
+ *  instead of holding up the others.
  */
 
 /* ---------------------------------------------------------------------- */
 
+static void feedConsumer(FanOutRing & ring, int index, bool dropping, const char * command) {
+  // the command inherits the disposition, so it starts with the default
+  // and dies on a broken pipe of its own; only then is it ignored here,
+  // where a command that exits should close this cursor, not kill the
+  // process
+  signal(SIGPIPE, SIG_DFL);
+  FILE * path = popen(command, "w");
+  signal(SIGPIPE, SIG_IGN);
+  if (!path) {
+    perror("split_stream could not start command");
+    ring.closeConsumer(index);
+    return;
+  }
+  int fd = fileno(path);
+  unsigned char * copy = dropping ? reinterpret_cast<unsigned char *>(malloc(Stream::blockSize())) : 0;
+  bool open = true;
+  while (open) {
+    size_t bytes = Stream::blockSize();
+    const unsigned char * block = ring.peek(index, bytes);
+    if (!block) break;
+    if (dropping) {  // the producer may overwrite the ring, so check a copy
+      memcpy(copy, block, bytes);
+      if (!ring.release(index, bytes)) continue;
+      block = copy;
+    }
+    for (size_t written = 0; written < bytes; ) {
+      ssize_t amount = write(fd, block + written, bytes - written);
+      if (amount < 0 && errno == EINTR) continue;
+      if (amount <= 0) {
+        open = false;
+        break;
+      }
+      written += amount;
+    }
+    if (!dropping) ring.release(index, bytes);
+  }
+  ring.closeConsumer(index);
+  if (copy) free(copy);
+  pclose(path);
+}
+
+/* ---------------------------------------------------------------------- */
+
 int dspp::split_stream(char ** paths) {
-  struct node { int p[2]; node * link; };
-  node * descriptors = 0;
-  node * head = 0;
-  const int BUFFER_SIZE = 4096;
+  Stream * inputStream = Stream::input();
+  Stream * outputStream = Stream::output();
   int pathIndex = 2;
-  int numberOfChildren = 1;
-  unsigned char bytes[BUFFER_SIZE];
-  const char * thisPath;
-  int p[2];
-  pipe(p);
-  while (paths[pathIndex] != 0) {
-    thisPath = paths[pathIndex++];
-    if (descriptors) {
-      while (descriptors->link) descriptors = descriptors->link;
-      descriptors->link = (node *) malloc(sizeof(node));
-      descriptors = descriptors->link;
-      descriptors->link = 0;
-      pipe(descriptors->p);
-    } else {
-      descriptors = (node *) malloc(sizeof(node));
-      descriptors->link = 0;
-      pipe(descriptors->p);
-      head = descriptors;
-    }
+  FanOutRing::Policy policy = FanOutRing::BLOCK;
+  if (paths[pathIndex] && strcmp(paths[pathIndex], "-d") == 0) {
+    policy = FanOutRing::DROP;
+    pathIndex++;
+  } else if (paths[pathIndex] && strcmp(paths[pathIndex], "-b") == 0) {
+    pathIndex++;
+  }
+  int numberOfChildren = 0;
+  while (paths[pathIndex + numberOfChildren] != 0) numberOfChildren++;
+  FanOutRing ring(numberOfChildren, policy);
+  if (numberOfChildren == 0 || !ring.isOpen()) {
+    fprintf(stderr, "split_stream has no output streams\n");
+    outputStream->close();
+    return 0;
+  }
+  for (int child = 0; child < numberOfChildren; child++) {
     pid_t id = fork();
     if (id == 0) {
-      p[0] = descriptors->p[0];
-      p[1] = descriptors->p[1];
-      int count = 0;
-      fprintf(stderr, "Child %d has started\n", numberOfChildren);
-      FILE * fd = popen(thisPath, "w");
-      perror(" popen status ");
-      int numberOfWrites = 1;
-      for (;;) {
-        count = read(p[0], &bytes, BUFFER_SIZE);
-        perror(" read status ");
-        fprintf(stderr, "%d read count was: %d\n", numberOfChildren, count);
-        if(count != BUFFER_SIZE) {
-          fwrite(&bytes, sizeof(unsigned char), count, fd);  // write last bit of data
-          fprintf(stderr, "number of writes by %d is %d\n", numberOfChildren, numberOfWrites++);
-          fprintf(stderr, "Short data stream in child, split pipe\n");
-          pclose(fd);
-          return 0;
-        }
-        fwrite(&bytes, sizeof(unsigned char), count, fd);
-        fprintf(stderr, "number of writes by %d is %d\n", numberOfChildren, numberOfWrites++);
-        perror(" write status ");
-      }
+      feedConsumer(ring, child, policy == FanOutRing::DROP, paths[pathIndex + child]);
+      _exit(0);
     }
-    numberOfChildren++;
+    ring.setConsumerProcess(child, id);
   }
-  numberOfChildren--;
   fprintf(stderr, "spawned %d children\n", numberOfChildren);
-  int status = 0;
-  int count = 0;
-  int numberOfWrites = 1;
   for (;;) {
-    count = fread(&bytes, sizeof(unsigned char), BUFFER_SIZE, stdin);
-    fprintf(stderr, "parent read count was: %d\n", count);
-    if(count == 0) {
-      fprintf(stderr, "split_stream data stream input has closed\n");
+    size_t room = Stream::blockSize();
+    unsigned char * space = ring.claim(room);
+    if (!space) {
+      fprintf(stderr, "every split_stream output has closed\n");
       break;
     }
-    descriptors = head;
-    for (int child = 0; child < numberOfChildren; child++) {
-      if (count != write(descriptors->p[1], &bytes, count)) {
-        fprintf(stderr, "write to pipe failed in parent\n");
-      } else {
-        perror(" write to pipe successful in parent ");
-      }
-      descriptors = descriptors->link;
-    }
-    fprintf(stderr, "number of writes by parent is %d\n", numberOfWrites++);
-  }
-  while (true) {
-    fprintf(stderr, "waiting for children\n");
-    pid_t id = wait(&status);
-    fprintf(stderr, "Got as status for id: %d\n", id);
-    if (id < 0) {
-      break;  // done
+    size_t count = inputStream->read(space, sizeof(unsigned char), room);
+    ring.publish(count);
+    if (count < room) {
+      fprintf(stderr, "split_stream data stream input has closed\n");
+      break;
     }
   }
+  ring.close();
+  int status = 0;
+  while (wait(&status) > 0) {}
   fprintf(stderr, "all children have terminated\n");
-  fprintf(stderr, "Closing IPC pipe\n");
-  close(p[1]);
-  fclose(stdout);
+  for (int child = 0; child < numberOfChildren; child++) {
+    ring.report(child, paths[pathIndex + child]);
+  }
+  outputStream->close();
   return 0;
 }
 /* ---------------------------------------------------------------------- */
@@ -1425,527 +1672,879 @@ int dspp::window_sample(int period, int modulo, int syncTo) {
 }
 /* ---------------------------------------------------------------------- */
 
-int main(int argc, char *argv[]) {
-
-  dspp dsppInstance;
-
-  int c;
+/* ---------------------------------------------------------------------- */
 
-  const unsigned int COMMAND_LENGTH = 32;
+static int runCommand(dspp & dsppInstance, int c, int argc, char *argv[], const char * stats);
 
-  if (argc <= 1 || !argv[1] || (strlen(argv[1]) >= COMMAND_LENGTH)) {
-    fprintf(stderr, USAGE_STR, argv[0]);
-    return -2;
+/* ---------------------------------------------------------------------- */
+/*
+ *      Statistics option - "--stats" reports on standard error and
+ *      "--stats=file" appends to file.  It may appear anywhere after the
+ *      command name and is removed from argv, so commands never see it.
+ */
+static const char * statsOption = 0;
+
+static const char * takeStatsOption(int & argc, char *argv[]) {
+  const char * option = 0;
+  for (int index = 2; index < argc; ) {
+    if (strcmp(argv[index], "--stats") == 0 || strncmp(argv[index], "--stats=", 8) == 0) {
+      option = (argv[index][7] == '=') ? argv[index] + 8 : "";
+      for (int next = index; next < argc; next++) argv[next] = argv[next + 1];
+      argc--;
+    } else {
+      index++;
+    }
   }
+  return option;
+}
 
-  char command[COMMAND_LENGTH];
+/* ---------------------------------------------------------------------- */
+/*
+ *      Find the option value of a command name - exact match only
+ */
+static int lookupCommand(const char * name) {
+  for (struct option * entry = longOpts; entry->name; entry++) {
+    if (strcmp(entry->name, name) == 0) return entry->val;
+  }
+  return -1;
+}
 
-  memset(command, 0, sizeof(command));
+/* ---------------------------------------------------------------------- */
+/*
+ *      Pipeline stage entry - argv has the same layout as a command line
+ */
+static int runStage(int argc, char *argv[]) {
+  dspp dsppInstance;
+  const char * stats = takeStatsOption(argc, argv);
+  return runCommand(dsppInstance, lookupCommand(argv[1]), argc, argv, stats ? stats : statsOption);
+}
 
-  char * new_argv[argc];
-  if (argc > 1) {
-    if (argv[1][0] == '-') {
-      snprintf(command, sizeof(command)-1, "%s", argv[1]);
-    } else {
-      snprintf(command, sizeof(command)-3, "--%s", argv[1]);
-    }
-  } else {
-    fprintf(stderr, USAGE_STR, argv[0]);
-    return -2;
-  }
+/* ---------------------------------------------------------------------- */
+/*
+ *      pipeline.cc -- DSP Pipe - run a chain of commands in one process
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  The description uses shell pipe syntax, for example:
+ *    dspp pipeline "convert_uByte_f | shift_frequency_cc -0.25 | decimate_cc 0.005 79 50 40 HAMMING"
+ *  Each stage runs on its own thread and stages are linked by lock free
+ *  rings, so no samples pass through kernel pipes between stages.  With -a
+ *  each stage is pinned to its own core, and with -r seconds the fill level
+ *  of every link is reported periodically as well as when the chain ends.
+ */
 
-  int index;
+/* ---------------------------------------------------------------------- */
 
-  for (index = 0; index < argc; index++) {
-    if (index == 1) {
-      new_argv[1] = (char *) &command;
-    } else {
-      new_argv[index] = argv[index];
+int dspp::pipeline(const char * programName, const char * description, bool pin, int reportInterval) {
+  Pipeline chain(programName, description);
+  chain.pinToCores(pin);
+  chain.reportEvery(reportInterval);
+  if (chain.numberOfStages() == 0) {
+    fprintf(stderr, "pipeline has no stages\n");
+    return 0;
+  }
+  for (int index = 0; index < chain.numberOfStages(); index++) {
+    int command = lookupCommand(chain.stageName(index));
+    if (command < 0 || command == 44) {  // unknown or a nested pipeline
+      fprintf(stderr, "pipeline stage %d, %s, is not a supported command\n", index + 1, chain.stageName(index));
+      return 0;
     }
   }
+  chain.run(runStage);
+  return 0;
+}
+
+/* ---------------------------------------------------------------------- */
+/*
+ *      Run one command.  The return value is negative for a usage error,
+ *      otherwise it is non zero once the command has finished processing.
+ */
+static int dispatchCommand(dspp & dsppInstance, int c, int argc, char *argv[]) {
 
   int doneProcessing = 0;
-  while ((c = getopt_long(argc, new_argv, "h", longOpts, NULL)) >= 0) {
-    switch (c) {
-      case 'h': {
-        fprintf(stderr, USAGE_STR, argv[0]);
-        return -2;
-      }
-      case 1: {
-        doneProcessing = !dsppInstance.convert_byte_sInt16();
-        break;
-      }
-      case 2: {
-        doneProcessing = !dsppInstance.convert_byte_f();
-        break;
-      }
-      case 3: {
-        doneProcessing = !dsppInstance.convert_uByte_f();
-        break;
-      }
-      case 4: {
-          float amount;
-	  if (argc == 3) {
-            sscanf(argv[2], "%f", &amount);
-            doneProcessing = !dsppInstance.shift_frequency_cc(amount);
-	  } else {
-	    fprintf(stderr, "shift_frequency_cc parameter error\n");
-	    doneProcessing = true;
-	  }
-          break;
-      }
-      case 5: {
-          float cutOffFrequency;
-          int M;
-          int amount;
-	  int N;
-	  if (argc == 7) {
-            sscanf(argv[2], "%f", &cutOffFrequency);
-            sscanf(argv[3], "%d", &M);
-            sscanf(argv[4], "%d", &amount);
-	    sscanf(argv[5], "%d", &N);
-            doneProcessing = !dsppInstance.decimate_cc(cutOffFrequency, M, amount, N, argv[6]);
-	  } else {
-	    fprintf(stderr, "decimate_cc parameter error\n");
-	    doneProcessing = true;
-	  }
-          break;
-      }
-      case 6: {
-        doneProcessing = !dsppInstance.fmdemod_cf();
-        break;
-      }
-      case 7: {
-          float cutOffFrequency;
-          int M;
-          int amount;
-	  int N;
-	  if (argc == 7) {
-            sscanf(argv[2], "%f", &cutOffFrequency);
-            sscanf(argv[3], "%d", &M);
-            sscanf(argv[4], "%d", &amount);
-	    sscanf(argv[5], "%d", &N);
-            doneProcessing = !dsppInstance.decimate_ff(cutOffFrequency, M, amount, N, argv[6]);
-          } else if (argc == 4) {
-            sscanf(argv[2], "%d", &amount);
-            doneProcessing = !dsppInstance.decimate_ff(0.0, 0, amount, 0, argv[3]);
-	  } else {
-	    fprintf(stderr, "decimate_ff parameter error\n");
-	    doneProcessing = true;
-	  }
-          break;
-      }
-      case 8: {
-        doneProcessing = !dsppInstance.convert_f_uInt16();
-        break;
-      }
-      case 9: {
-        doneProcessing = !dsppInstance.convert_f_sInt16();
-        break;
-      }
-      case 10: {
-        int port;
-        int frequency = 0;
-        int sampleRate = 0;
-        int mode = 0;
-        int gain = 0;
-	if (argc == 8 || argc == 4) {
-          sscanf(argv[3], "%d", &port);
-	  if (argc == 8) {
-            sscanf(argv[4], "%d", &frequency);
-	    sscanf(argv[5], "%d", &sampleRate);
-            sscanf(argv[6], "%d", &mode);
-            sscanf(argv[7], "%d", &gain);
-	  }
-          fprintf(stderr, "calling tcp client\n");
-          doneProcessing = !dsppInstance.convert_tcp_byte(argv[2], port, frequency, sampleRate, mode, gain);
-	} else {
-	  fprintf(stderr, "convert_tcp_byte parameter error\n");
-	  doneProcessing = true;
-	}
-        break;
-      }
-      case 11: {
-        int port;
-	if (argc == 4) {
-          sscanf(argv[3], "%d", &port);
-          fprintf(stderr, "starting TCP server\n");
-          doneProcessing = !dsppInstance.convert_byte_tcp(argv[2], port);
-	} else {
-	  fprintf(stderr, "convert_byte_tcp parameter error\n");
-	  doneProcessing = true;
-	}
-        break;
-      }
-      case 12: {
-        int M;
-        int N;
-	if (argc == 6 && !strncmp("CUSTOM", argv[5], strlen("CUSTOM"))) {
-          sscanf(argv[3], "%d", &M);
-          sscanf(argv[4], "%d", &N);
-          fprintf(stderr, "starting custom FIR filter\n");
-          doneProcessing = !dsppInstance.custom_fir_ff(argv[2], M, N, FIRFilter::CUSTOM);
-	} else {
-	  fprintf(stderr, "custom_fir_ff parameter error\n");
-          fprintf(stderr, "%d %s\n", argc, argv[5]);
-	  doneProcessing = true;
-	}
-        break;
-      }
-      case 13: {
-        int M;
-        int N;
-	if (argc == 6 && !strncmp("CUSTOM", argv[5], strlen("CUSTOM"))) {
-          sscanf(argv[3], "%d", &M);
-          sscanf(argv[4], "%d", &N);
-          fprintf(stderr, "starting custom FIR filter\n");
-          doneProcessing = !dsppInstance.custom_fir_cc(argv[2], M, N, FIRFilter::CUSTOM);
-	} else {
-	  fprintf(stderr, "custom_fir_cc parameter error\n");
-          fprintf(stderr, "%d %s\n", argc, argv[5]);
-	  doneProcessing = true;
-	}
-        break;
-      }
-      case 14: {
-	if (argc == 2) {
-          fprintf(stderr, "starting real to complex \n");
-          doneProcessing = !dsppInstance.real_to_complex_fc();
-	} else {
-	  fprintf(stderr, "real_to_complex_fc parameter error\n");
-          fprintf(stderr, "%d\n", argc);
-	  doneProcessing = true;
-	}
-        break;
-      }
-      case 15: {
-        float sampleRate;
+  switch (c) {
+    case 'h': {
+      fprintf(stderr, USAGE_STR, argv[0]);
+      return -2;
+    }
+    case 1: {
+      doneProcessing = !dsppInstance.convert_byte_sInt16();
+      break;
+    }
+    case 2: {
+      doneProcessing = !dsppInstance.convert_byte_f();
+      break;
+    }
+    case 3: {
+      doneProcessing = !dsppInstance.convert_uByte_f();
+      break;
+    }
+    case 4: {
+        float amount;
         if (argc == 3) {
-          sscanf(argv[2], "%f", &sampleRate);
-          FMMod modulator(sampleRate);
-          doneProcessing = !modulator.modulate();
+          sscanf(argv[2], "%f", &amount);
+          doneProcessing = !dsppInstance.shift_frequency_cc(amount);
         } else {
-	  fprintf(stderr, "fmmod_fc parameter error\n");
-          fprintf(stderr, "%d\n", argc);
-	  doneProcessing = true;
+          fprintf(stderr, "shift_frequency_cc parameter error\n");
+          doneProcessing = true;
         }
         break;
-      }
-      case 16: {
+    }
+    case 5: {
+        float cutOffFrequency;
+        int M;
         int amount;
-        if (argc == 3) {
-          sscanf(argv[2], "%d", &amount);
-          doneProcessing = !dsppInstance.head(amount);
+        int N;
+        if ((argc == 7 || argc == 8) && strcmp(argv[2], "-p") == 0) {
+          double inputRate;
+          double outputRate;
+          double passband;
+          double stopband;
+          double attenuation = 80.0;
+          sscanf(argv[3], "%lf", &inputRate);
+          sscanf(argv[4], "%lf", &outputRate);
+          sscanf(argv[5], "%lf", &passband);
+          sscanf(argv[6], "%lf", &stopband);
+          if (argc == 8) sscanf(argv[7], "%lf", &attenuation);
+          doneProcessing = !dsppInstance.decimate_cc(inputRate, outputRate, passband, stopband, attenuation);
+        } else if (argc == 7) {
+          sscanf(argv[2], "%f", &cutOffFrequency);
+          sscanf(argv[3], "%d", &M);
+          sscanf(argv[4], "%d", &amount);
+          sscanf(argv[5], "%d", &N);
+          doneProcessing = !dsppInstance.decimate_cc(cutOffFrequency, M, amount, N, argv[6]);
         } else {
-	  fprintf(stderr, "head parameter error\n");
-          fprintf(stderr, "%d\n", argc);
-	  doneProcessing = true;
+          fprintf(stderr, "decimate_cc parameter error\n");
+          doneProcessing = true;
         }
         break;
-      }
-      case 17: {
+    }
+    case 6: {
+      doneProcessing = !dsppInstance.fmdemod_cf();
+      break;
+    }
+    case 7: {
+        float cutOffFrequency;
+        int M;
         int amount;
-        if (argc == 3) {
+        int N;
+        if (argc == 7) {
+          sscanf(argv[2], "%f", &cutOffFrequency);
+          sscanf(argv[3], "%d", &M);
+          sscanf(argv[4], "%d", &amount);
+          sscanf(argv[5], "%d", &N);
+          doneProcessing = !dsppInstance.decimate_ff(cutOffFrequency, M, amount, N, argv[6]);
+        } else if (argc == 4) {
           sscanf(argv[2], "%d", &amount);
-          doneProcessing = !dsppInstance.tail(amount);
+          doneProcessing = !dsppInstance.decimate_ff(0.0, 0, amount, 0, argv[3]);
         } else {
-	  fprintf(stderr, "tail parameter error\n");
-          fprintf(stderr, "%d\n", argc);
-	  doneProcessing = true;
+          fprintf(stderr, "decimate_ff parameter error\n");
+          doneProcessing = true;
         }
         break;
+    }
+    case 8: {
+      doneProcessing = !dsppInstance.convert_f_uInt16();
+      break;
+    }
+    case 9: {
+      doneProcessing = !dsppInstance.convert_f_sInt16();
+      break;
+    }
+    case 10: {
+      int port;
+      int frequency = 0;
+      int sampleRate = 0;
+      int mode = 0;
+      int gain = 0;
+      if (argc == 8 || argc == 4) {
+        sscanf(argv[3], "%d", &port);
+        if (argc == 8) {
+          sscanf(argv[4], "%d", &frequency);
+          sscanf(argv[5], "%d", &sampleRate);
+          sscanf(argv[6], "%d", &mode);
+          sscanf(argv[7], "%d", &gain);
+        }
+        fprintf(stderr, "calling tcp client\n");
+        doneProcessing = !dsppInstance.convert_tcp_byte(argv[2], port, frequency, sampleRate, mode, gain);
+      } else {
+        fprintf(stderr, "convert_tcp_byte parameter error\n");
+        doneProcessing = true;
       }
-      case 18: {
-        doneProcessing = !dsppInstance.convert_sInt16_f();
-        break;
+      break;
+    }
+    case 11: {
+      int port;
+      if (argc == 4) {
+        sscanf(argv[3], "%d", &port);
+        fprintf(stderr, "starting TCP server\n");
+        doneProcessing = !dsppInstance.convert_byte_tcp(argv[2], port);
+      } else {
+        fprintf(stderr, "convert_byte_tcp parameter error\n");
+        doneProcessing = true;
       }
-      case 19: {
-        int numberOfComplexSamples = 0;
-        if (argc == 3) {
-          sscanf(argv[2], "%d", &numberOfComplexSamples);
-          doneProcessing = !dsppInstance.fft_cc(numberOfComplexSamples);
-        } else {
-          fprintf(stderr, "fft_cc parameter error\n");
-        }
-        break;
+      break;
+    }
+    case 12: {
+      int M;
+      int N;
+      if (argc == 6 && !strncmp("CUSTOM", argv[5], strlen("CUSTOM"))) {
+        sscanf(argv[3], "%d", &M);
+        sscanf(argv[4], "%d", &N);
+        fprintf(stderr, "starting custom FIR filter\n");
+        doneProcessing = !dsppInstance.custom_fir_ff(argv[2], M, N, FIRFilter::CUSTOM);
+      } else {
+        fprintf(stderr, "custom_fir_ff parameter error\n");
+        fprintf(stderr, "%d %s\n", argc, argv[5]);
+        doneProcessing = true;
       }
-      case 20: {
-        if (argc == 3) {
-          fprintf(stderr, "Starting parallel stream: %s\n", argv[2]);
-          doneProcessing = !dsppInstance.tee(argv[2]);
-        } else {
-          fprintf(stderr, "tee parameter error\n");
-        }
-        break;
+      break;
+    }
+    case 13: {
+      int M;
+      int N;
+      if (argc == 6 && !strncmp("CUSTOM", argv[5], strlen("CUSTOM"))) {
+        sscanf(argv[3], "%d", &M);
+        sscanf(argv[4], "%d", &N);
+        fprintf(stderr, "starting custom FIR filter\n");
+        doneProcessing = !dsppInstance.custom_fir_cc(argv[2], M, N, FIRFilter::CUSTOM);
+      } else {
+        fprintf(stderr, "custom_fir_cc parameter error\n");
+        fprintf(stderr, "%d %s\n", argc, argv[5]);
+        doneProcessing = true;
       }
-      case 21: {
-        float cutoff = 0.3333333;
-        int decimation = 1;
-        if (argc == 3) {
-          sscanf(argv[2], "%f", &cutoff);
-          SFIRFilter sfilter(cutoff);
-          fprintf(stderr, "Low pass smooth filter a complex stream with cutoff at %s of Nyquist\n", argv[2]);
-          sfilter.filterSignal();
-          doneProcessing = true;
-        } else if (argc == 4) {
-          sscanf(argv[2], "%f", &cutoff);
-          sscanf(argv[3], "%d", &decimation);
-          SFIRFilter sfilter(cutoff, decimation);
+      break;
+    }
+    case 14: {
+      if (argc == 2) {
+        fprintf(stderr, "starting real to complex \n");
+        doneProcessing = !dsppInstance.real_to_complex_fc();
+      } else {
+        fprintf(stderr, "real_to_complex_fc parameter error\n");
+        fprintf(stderr, "%d\n", argc);
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 15: {
+      float sampleRate;
+      float deviation = 5000.0;
+      if (argc == 3 || argc == 4) {
+        sscanf(argv[2], "%f", &sampleRate);
+        if (argc == 4) sscanf(argv[3], "%f", &deviation);
+        FMMod modulator(sampleRate, deviation);
+        doneProcessing = !modulator.modulate();
+      } else {
+        fprintf(stderr, "fmmod_fc parameter error\n");
+        fprintf(stderr, "%d\n", argc);
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 16: {
+      int amount;
+      if (argc == 3) {
+        sscanf(argv[2], "%d", &amount);
+        doneProcessing = !dsppInstance.head(amount);
+      } else {
+        fprintf(stderr, "head parameter error\n");
+        fprintf(stderr, "%d\n", argc);
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 17: {
+      int amount;
+      if (argc == 3) {
+        sscanf(argv[2], "%d", &amount);
+        doneProcessing = !dsppInstance.tail(amount);
+      } else {
+        fprintf(stderr, "tail parameter error\n");
+        fprintf(stderr, "%d\n", argc);
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 18: {
+      doneProcessing = !dsppInstance.convert_sInt16_f();
+      break;
+    }
+    case 19: {
+      int numberOfComplexSamples = 0;
+      if (argc == 3) {
+        sscanf(argv[2], "%d", &numberOfComplexSamples);
+        doneProcessing = !dsppInstance.fft_cc(numberOfComplexSamples);
+      } else {
+        fprintf(stderr, "fft_cc parameter error\n");
+      }
+      break;
+    }
+    case 20: {
+      if (argc == 3) {
+        fprintf(stderr, "Starting parallel stream: %s\n", argv[2]);
+        doneProcessing = !dsppInstance.tee(argv[2], false);
+      } else if (argc == 4 && strcmp(argv[2], "-n") == 0) {
+        fprintf(stderr, "Starting non blocking parallel stream: %s\n", argv[3]);
+        doneProcessing = !dsppInstance.tee(argv[3], true);
+      } else {
+        fprintf(stderr, "tee parameter error\n");
+      }
+      break;
+    }
+    case 21: {
+      float cutoff = 0.3333333;
+      int decimation = 1;
+      if (argc == 3) {
+        sscanf(argv[2], "%f", &cutoff);
+        SFIRFilter sfilter(cutoff);
+        fprintf(stderr, "Low pass smooth filter a complex stream with cutoff at %s of Nyquist\n", argv[2]);
+        sfilter.filterSignal();
+        doneProcessing = true;
+      } else if (argc == 4) {
+        sscanf(argv[2], "%f", &cutoff);
+        sscanf(argv[3], "%d", &decimation);
+        SFIRFilter sfilter(cutoff, decimation);
+        fprintf(stderr,
+                "Low pass smooth filter a complex stream with cutoff at %s of Nyquist - decimation of %s:\n",
+                argv[2], argv[3]);
+        sfilter.filterSignal();
+        doneProcessing = true;
+      } else if (argc == 5) {
+        sscanf(argv[2], "%f", &cutoff);
+        sscanf(argv[3], "%d", &decimation);
+        bool highPass = strcmp(argv[4], "true") == 0;
+        SFIRFilter sfilter(cutoff, decimation, highPass);
+        if (highPass) {
           fprintf(stderr,
-                  "Low pass smooth filter a complex stream with cutoff at %s of Nyquist - decimation of %s:\n",
+                  "High pass smooth filter a complex stream with cutoff at %s of Nyquist - decimation of %s:\n",
                   argv[2], argv[3]);
-          sfilter.filterSignal();
-          doneProcessing = true;
-        } else if (argc == 5) {
-          sscanf(argv[2], "%f", &cutoff);
-          sscanf(argv[3], "%d", &decimation);
-          bool highPass = strcmp(argv[4], "true") == 0;
-          SFIRFilter sfilter(cutoff, decimation, highPass);
-          if (highPass) {
-            fprintf(stderr,
-                    "High pass smooth filter a complex stream with cutoff at %s of Nyquist - decimation of %s:\n",
-                    argv[2], argv[3]);
-          } else {
-            fprintf(stderr,
-                    "Low pass smooth filter a complex stream with cutoff at %s of Nyquist - decimation of %s:\n",
-                    argv[2], argv[3]);
-          }
-          sfilter.filterSignal();
-          doneProcessing = true;
         } else {
-          fprintf(stderr, "sfir_cc parameter error\n");
+          fprintf(stderr,
+                  "Low pass smooth filter a complex stream with cutoff at %s of Nyquist - decimation of %s:\n",
+                  argv[2], argv[3]);
         }
-        break;
+        sfilter.filterSignal();
+        doneProcessing = true;
+      } else {
+        fprintf(stderr, "sfir_cc parameter error\n");
       }
-      case 22: {
-        float cutoff = 0.3333333;
-        int decimation = 1;
-        if (argc == 3) {
-          sscanf(argv[2], "%f", &cutoff);
-          SFIRFilter sfilter(cutoff, decimation, false, false);
-          fprintf(stderr, "Low pass smooth filter a real stream with cutoff at %s of Nyquist:\n", argv[2]);
-          sfilter.filterSignal();
-          doneProcessing = true;
-        } else if (argc == 4) {
-          sscanf(argv[2], "%f", &cutoff);
-          sscanf(argv[3], "%d", &decimation);
-          SFIRFilter sfilter(cutoff, decimation, false, false);
+      break;
+    }
+    case 22: {
+      float cutoff = 0.3333333;
+      int decimation = 1;
+      if (argc == 3) {
+        sscanf(argv[2], "%f", &cutoff);
+        SFIRFilter sfilter(cutoff, decimation, false, false);
+        fprintf(stderr, "Low pass smooth filter a real stream with cutoff at %s of Nyquist:\n", argv[2]);
+        sfilter.filterSignal();
+        doneProcessing = true;
+      } else if (argc == 4) {
+        sscanf(argv[2], "%f", &cutoff);
+        sscanf(argv[3], "%d", &decimation);
+        SFIRFilter sfilter(cutoff, decimation, false, false);
+        fprintf(stderr,
+                "Low pass smooth filter a real stream with cutoff at %s of Nyquist - decimation of %s:\n",
+                argv[2], argv[3]);
+        sfilter.filterSignal();
+        doneProcessing = true;
+      } else if (argc == 5) {
+        sscanf(argv[2], "%f", &cutoff);
+        sscanf(argv[3], "%d", &decimation);
+        bool highPass = strcmp(argv[4], "true") == 0;
+        SFIRFilter sfilter(cutoff, decimation, highPass, false);
+        if (highPass) {
           fprintf(stderr,
-                  "Low pass smooth filter a real stream with cutoff at %s of Nyquist - decimation of %s:\n",
+                  "High pass smooth filter a real stream with cutoff at %s of Nyquist - decimation of %s:\n",
                   argv[2], argv[3]);
-          sfilter.filterSignal();
-          doneProcessing = true;
-        } else if (argc == 5) {
-          sscanf(argv[2], "%f", &cutoff);
-          sscanf(argv[3], "%d", &decimation);
-          bool highPass = strcmp(argv[4], "true") == 0;
-          SFIRFilter sfilter(cutoff, decimation, highPass, false);
-          if (highPass) {
-            fprintf(stderr,
-                    "High pass smooth filter a real stream with cutoff at %s of Nyquist - decimation of %s:\n",
-                    argv[2], argv[3]);
-          } else {
-            fprintf(stderr,
-                    "Low pass smooth filter a real stream with cutoff at %s of Nyquist - decimation of %s:\n",
-                    argv[2], argv[3]);
-          }
-          sfilter.filterSignal();
-          doneProcessing = true;
         } else {
-          fprintf(stderr, "sfir_ff parameter error\n");
+          fprintf(stderr,
+                  "Low pass smooth filter a real stream with cutoff at %s of Nyquist - decimation of %s:\n",
+                  argv[2], argv[3]);
         }
-        break;
+        sfilter.filterSignal();
+        doneProcessing = true;
+      } else {
+        fprintf(stderr, "sfir_ff parameter error\n");
       }
-      case 23: {
-	if (argc == 2) {
-          fprintf(stderr, "starting real of complex\n");
-          doneProcessing = !dsppInstance.real_of_complex_cf();
-	} else {
-	  fprintf(stderr, "real_of_complex_cf parameter error\n");
-          fprintf(stderr, "%d\n", argc);
-	  doneProcessing = true;
-	}
-        break;
+      break;
+    }
+    case 23: {
+      if (argc == 2) {
+        fprintf(stderr, "starting real of complex\n");
+        doneProcessing = !dsppInstance.real_of_complex_cf();
+      } else {
+        fprintf(stderr, "real_of_complex_cf parameter error\n");
+        fprintf(stderr, "%d\n", argc);
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 25:
+    case 53: {
+      int decimation = 1;
+      int order = 2;
+      int delay = 1;
+      int taps = 0;
+      bool unsignedInput = c == 53;
+      if (argc == 3) {
+        sscanf(argv[2], "%d", &decimation);
+        CFilter cfilter(decimation, unsignedInput);
+        fprintf(stderr, "Comb filter a complex stream with decimation: %s\n", argv[2]);
+        cfilter.filterSignal();
+        doneProcessing = true;
+      } else if (argc >= 4 && argc <= 6) {
+        sscanf(argv[2], "%d", &decimation);
+        sscanf(argv[3], "%d", &order);
+        if (argc >= 5) sscanf(argv[4], "%d", &delay);
+        if (argc == 6) sscanf(argv[5], "%d", &taps);
+        CFilter cfilter(decimation, order, delay, unsignedInput, taps);
+        cfilter.filterSignal();
+        doneProcessing = true;
+      } else {
+        fprintf(stderr, "Comb filter parameter error\n");
+        doneProcessing = true;
       }
-      case 25: {
-        int decimation = 1;
+      break;
+    }
+    case 54: {
+      if (argc == 6) {
+        double shift;
+        float cutOffFrequency;
+        int taps;
+        int decimation;
+        sscanf(argv[2], "%lf", &shift);
+        sscanf(argv[3], "%f", &cutOffFrequency);
+        sscanf(argv[4], "%d", &taps);
+        sscanf(argv[5], "%d", &decimation);
+        DownConverter converter(shift, cutOffFrequency, taps, decimation);
+        converter.filterSignal();
+        doneProcessing = true;
+      } else {
+        fprintf(stderr, "ddc_uByte_cc parameter error\n");
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 26: {
+      if (argc == 2) {
+        fprintf(stderr, "starting mag\n");
+        doneProcessing = !dsppInstance.mag_cf();
+      } else {
+        fprintf(stderr, "mag should have no parameters - error\n");
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 27: {
+      if (argc == 3) {
+        fprintf(stderr, "starting gain\n");
+        float gain = 0.0;
+        sscanf(argv[2], "%f", &gain);
+        doneProcessing = !dsppInstance.gain(gain);
+      } else {
+        fprintf(stderr, "gain should have one floating point parameter - error\n");
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 28: {
+      if (argc == 2) {
+        fprintf(stderr, "starting limit_real_stream\n");
+        doneProcessing = !dsppInstance.limit_real_stream();
+      } else {
+        fprintf(stderr, "limit_real_stream should have no parameters - error\n");
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 29: {
+      if (argc == 2) {
+        const int BUFFER_SIZE = 4096;
+        fprintf(stderr, "starting dc_removal\n");
+        float buffer[BUFFER_SIZE];
+        for (int i = 0; i < BUFFER_SIZE; i++) buffer[i] = 0.0;
+        doneProcessing = !dsppInstance.dc_removal(buffer, BUFFER_SIZE);
+      } else {
+        fprintf(stderr, "dc_removal should have no parameters - error\n");
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 30: {
+      float target = 0.0;
+      float attack = AGC::DEFAULT_ATTACK;
+      float decay = AGC::DEFAULT_DECAY;
+      int lookahead = 0;
+      if (argc == 3 || argc == 5 || argc == 6) {
+        fprintf(stderr, "starting agc\n");
+        sscanf(argv[2], "%f", &target);
+        if (argc >= 5) {
+          sscanf(argv[3], "%f", &attack);
+          sscanf(argv[4], "%f", &decay);
+        }
+        if (argc == 6) sscanf(argv[5], "%d", &lookahead);
+        doneProcessing = !dsppInstance.agc(target, attack, decay, lookahead);
+      } else {
+        fprintf(stderr, "agc should have a target level and optionally attack decay [lookahead] - error\n");
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 31: {
+        float amount;
         if (argc == 3) {
-          sscanf(argv[2], "%d", &decimation);
-          CFilter cfilter(decimation);
-          fprintf(stderr, "Comb filter a complex stream with decimation: %s\n", argv[2]);
-          cfilter.filterSignal();
+          sscanf(argv[2], "%f", &amount);
+          doneProcessing = !dsppInstance.shift_frequency_uByteuByte(amount);
+        } else {
+          fprintf(stderr, "shift_frequency_uByteuByte parameter error\n");
           doneProcessing = true;
-	} else {
-	  fprintf(stderr, "Comb filter parameter error\n");
-	  doneProcessing = true;
-	}
+        }
         break;
-      }
-      case 26: {
+    }
+    case 32: {
+      doneProcessing = !dsppInstance.convert_uByte_byte();
+      break;
+    }
+    case 33: {
         if (argc == 2) {
-	  fprintf(stderr, "starting mag\n");
-          doneProcessing = !dsppInstance.mag_cf();
-	} else {
-	  fprintf(stderr, "mag should have no parameters - error\n");
-	  doneProcessing = true;
-	}
+          doneProcessing = !dsppInstance.fsSlash4_byte_byte();
+        } else {
+          fprintf(stderr, "fs/4 parameter error - shouldn't be any\n");
+          doneProcessing = true;
+        }
         break;
+    }
+    case 36: {
+      if (argc >= 3) {
+        fprintf(stderr, "starting split_stream\n");
+        doneProcessing = !dsppInstance.split_stream(argv);
+      } else {
+        fprintf(stderr, "split_stream needs at least two pipes - error\n");
+        doneProcessing = true;
       }
-      case 27: {
-        if (argc == 3) {
-	  fprintf(stderr, "starting gain\n");
-          float gain = 0.0;
-          sscanf(argv[2], "%f", &gain);
-          doneProcessing = !dsppInstance.gain(gain);
-	} else {
-	  fprintf(stderr, "gain should have one floating point parameter - error\n");
-	  doneProcessing = true;
-	}
-        break;
+      break;
+    }
+    case 39: {
+      float dialFrequency = 0.0;
+      char prefix[128];
+      int numberOfCandidates = 0;
+      if (argc == 7) {
+        fprintf(stderr, "starting WSPRWindow\n");
+        sscanf(argv[2], "%f", &dialFrequency);
+        snprintf(prefix, sizeof(prefix), "%s", argv[3]);
+        sscanf(argv[4], "%d", &numberOfCandidates);
+        doneProcessing = !dsppInstance.WSPR_window(dialFrequency, prefix, numberOfCandidates,
+                                                   argv[5], argv[6]);
+      } else {
+        fprintf(stderr, "WSPRWindow should have 5 parameters - error\n");
+        doneProcessing = true;
       }
-      case 28: {
-        if (argc == 2) {
-	  fprintf(stderr, "starting limit_real_stream\n");
-          doneProcessing = !dsppInstance.limit_real_stream();
-	} else {
-	  fprintf(stderr, "limit_real_stream should have no parameters - error\n");
-	  doneProcessing = true;
-	}
-        break;
+      break;
+    }
+    case 40: {
+      int period = 0;
+      int modulo = 0;
+      int syncTo = 0;
+      if (argc == 5) {
+        fprintf(stderr, "starting WindowSamle\n");
+        sscanf(argv[2], "%d", &period);
+        sscanf(argv[3], "%d", &modulo);
+        sscanf(argv[4], "%d", &syncTo);
+        doneProcessing = !dsppInstance.window_sample(period, modulo, syncTo);
+      } else {
+        fprintf(stderr, "WindowSample should have 3 parameters - error\n");
+        doneProcessing = true;
       }
-      case 29: {
-        if (argc == 2) {
-          const int BUFFER_SIZE = 4096;
-	  fprintf(stderr, "starting dc_removal\n");
-          float buffer[BUFFER_SIZE];
-          for (int i = 0; i < BUFFER_SIZE; i++) buffer[i] = 0.0;
-          doneProcessing = !dsppInstance.dc_removal(buffer, BUFFER_SIZE);
-	} else {
-	  fprintf(stderr, "dc_removal should have no parameters - error\n");
-	  doneProcessing = true;
-	}
-        break;
+      break;
+    }
+    case 41: {
+      doneProcessing = !dsppInstance.convert_f_byte();
+      break;
+    }
+    case 42: {
+      float dialFrequency = 0.0;
+      char prefix[128];
+      int numberOfCandidates = 0;
+      if (argc == 7) {
+        fprintf(stderr, "starting FT8Window\n");
+        sscanf(argv[2], "%f", &dialFrequency);
+        snprintf(prefix, sizeof(prefix), "%s", argv[3]);
+        sscanf(argv[4], "%d", &numberOfCandidates);
+        doneProcessing = !dsppInstance.FT8_window(dialFrequency, prefix, numberOfCandidates,
+                                                   argv[5], argv[6]);
+      } else {
+        fprintf(stderr, "FT8Window should have 5 parameters - error\n");
+        doneProcessing = true;
       }
-      case 30: {
-        float target = 0.0;
-        if (argc == 3) {
-	  fprintf(stderr, "starting agc\n");
-          sscanf(argv[2], "%f", &target);
-          doneProcessing = !dsppInstance.agc(target);
-	} else {
-	  fprintf(stderr, "agc should have only a target level parameter - error\n");
-	  doneProcessing = true;
-	}
-        break;
+      break;
+    }
+    case 43: {
+      if (argc == 2) {
+        fprintf(stderr, "starting real to complex quadrature - downconversion\n");
+        doneProcessing = !dsppInstance.real_to_quadrature_fc(false, false);
+      } else {
+        bool decimate = argc == 4 && strcmp(argv[3], "-d") == 0;
+        if ((argc == 3 || decimate) && strcmp(argv[2], "-H") == 0) {
+          fprintf(stderr, "starting real to complex quadrature - Hilbert\n");
+          doneProcessing = !dsppInstance.real_to_quadrature_fc(true, decimate);
+        } else {
+          fprintf(stderr, "real_to_quadrature_fc parameter error\n");
+          fprintf(stderr, "%d\n", argc);
+          doneProcessing = true;
+        }
       }
-      case 31: {
-          float amount;
-	  if (argc == 3) {
-            sscanf(argv[2], "%f", &amount);
-            doneProcessing = !dsppInstance.shift_frequency_uByteuByte(amount);
-	  } else {
-	    fprintf(stderr, "shift_frequency_uByteuByte parameter error\n");
-	    doneProcessing = true;
-	  }
+      break;
+    }
+    case 44: {
+      int first = 2;
+      bool pin = false;
+      int reportInterval = 0;
+      while (first < argc && argv[first][0] == '-') {
+        if (strcmp(argv[first], "-a") == 0) {
+          pin = true;
+          first++;
+        } else if (strcmp(argv[first], "-r") == 0 && first + 1 < argc) {
+          reportInterval = atoi(argv[first + 1]);
+          first += 2;
+        } else {
           break;
+        }
       }
-      case 32: {
-        doneProcessing = !dsppInstance.convert_uByte_byte();
-        break;
+      if (argc > first) {
+        std::string description;
+        for (int index = first; index < argc; index++) {
+          description += argv[index];
+          description += " ";
+        }
+        doneProcessing = !dsppInstance.pipeline(argv[0], description.c_str(), pin, reportInterval);
+      } else {
+        fprintf(stderr, "pipeline needs a command chain parameter - error\n");
+        doneProcessing = true;
       }
-      case 33: {
-	  if (argc == 2) {
-            doneProcessing = !dsppInstance.fsSlash4_byte_byte();
-	  } else {
-	    fprintf(stderr, "fs/4 parameter error - shouldn't be any\n");
-	    doneProcessing = true;
-	  }
-          break;
+      break;
+    }
+    case 45: {
+      if (argc == 3 || argc == 4) {
+        int size = ShmRing::DEFAULT_SIZE;
+        if (argc == 4) sscanf(argv[3], "%d", &size);
+        doneProcessing = !dsppInstance.convert_f_shm(argv[2], size);
+      } else {
+        fprintf(stderr, "convert_f_shm needs a ring name and optional size in bytes - error\n");
+        doneProcessing = true;
       }
-      case 36: {
-        if (argc >= 3) {
-	  fprintf(stderr, "starting split_stream\n");
-          doneProcessing = !dsppInstance.split_stream(argv);
-	} else {
-	  fprintf(stderr, "split_stream needs at least two pipes - error\n");
-	  doneProcessing = true;
-	}
-        break;
+      break;
+    }
+    case 46: {
+      if (argc == 3) {
+        doneProcessing = !dsppInstance.convert_shm_f(argv[2]);
+      } else {
+        fprintf(stderr, "convert_shm_f needs a ring name - error\n");
+        doneProcessing = true;
       }
-      case 39: {
-        float dialFrequency = 0.0;
-        char prefix[128];
-        int numberOfCandidates = 0;
-        if (argc == 7) {
-	  fprintf(stderr, "starting WSPRWindow\n");
-          sscanf(argv[2], "%f", &dialFrequency);
-          snprintf(prefix, sizeof(prefix), "%s", argv[3]);
-          sscanf(argv[4], "%d", &numberOfCandidates);
-          doneProcessing = !dsppInstance.WSPR_window(dialFrequency, prefix, numberOfCandidates,
-                                                     argv[5], argv[6]);
-	} else {
-	  fprintf(stderr, "WSPRWindow should have 5 parameters - error\n");
-	  doneProcessing = true;
-	}
-        break;
+      break;
+    }
+    case 47: {
+      if (argc == 5 || argc == 6) {
+        int channels = atoi(argv[3]);
+        double sampleRate = atof(argv[4]);
+        double centerFrequency = (argc == 6) ? atof(argv[5]) : 0.0;
+        doneProcessing = !dsppInstance.frame_wrap(argv[2], channels, sampleRate, centerFrequency);
+      } else {
+        fprintf(stderr, "frame_wrap needs sample type, channels, sample rate and optional center frequency - error\n");
+        doneProcessing = true;
       }
-      case 40: {
-        int period = 0;
-        int modulo = 0;
-        int syncTo = 0;
-        if (argc == 5) {
-	  fprintf(stderr, "starting WindowSamle\n");
-          sscanf(argv[2], "%d", &period);
-          sscanf(argv[3], "%d", &modulo);
-          sscanf(argv[4], "%d", &syncTo);
-          doneProcessing = !dsppInstance.window_sample(period, modulo, syncTo);
-	} else {
-	  fprintf(stderr, "WindowSample should have 3 parameters - error\n");
-	  doneProcessing = true;
-	}
-        break;
+      break;
+    }
+    case 48: {
+      int first = 2;
+      bool zeroFill = false;
+      if (first < argc && strcmp(argv[first], "-z") == 0) {
+        zeroFill = true;
+        first++;
       }
-      case 41: {
-        doneProcessing = !dsppInstance.convert_f_byte();
-        break;
+      if (argc - first <= 1) {
+        doneProcessing = !dsppInstance.frame_unwrap((argc > first) ? argv[first] : 0, zeroFill);
+      } else {
+        fprintf(stderr, "frame_unwrap takes [-z] and an optional sample type - error\n");
+        doneProcessing = true;
       }
-      case 42: {
-        float dialFrequency = 0.0;
-        char prefix[128];
-        int numberOfCandidates = 0;
-        if (argc == 7) {
-	  fprintf(stderr, "starting FT8Window\n");
-          sscanf(argv[2], "%f", &dialFrequency);
-          snprintf(prefix, sizeof(prefix), "%s", argv[3]);
-          sscanf(argv[4], "%d", &numberOfCandidates);
-          doneProcessing = !dsppInstance.FT8_window(dialFrequency, prefix, numberOfCandidates,
-                                                     argv[5], argv[6]);
-	} else {
-	  fprintf(stderr, "FT8Window should have 5 parameters - error\n");
-	  doneProcessing = true;
-	}
-        break;
+      break;
+    }
+    case 49: {
+      int first = 2;
+      double bytesPerSecond = 0.0;
+      if (first + 1 < argc && strcmp(argv[first], "-r") == 0) {
+        bytesPerSecond = atof(argv[first + 1]);
+        first += 2;
       }
-      case 43: {
-	if (argc == 2) {
-          fprintf(stderr, "starting real to complex quadrature - downconversion\n");
-          doneProcessing = !dsppInstance.real_to_quadrature_fc(false);
-	} else {
-          if (argc == 3 && strncmp(argv[2], "-H", 0) == 0) {
-            fprintf(stderr, "starting real to complex quadrature - Hilbert\n");
-            doneProcessing = !dsppInstance.real_to_quadrature_fc(true);
-          } else {
-            fprintf(stderr, "real_to_quadrature_fc parameter error\n");
-            fprintf(stderr, "%d\n", argc);
-            doneProcessing = true;
-          }
-	}
-        break;
+      if (argc - first >= 1 && argc - first <= 3) {
+        off_t offset = (argc - first >= 2) ? strtoll(argv[first + 1], 0, 0) : 0;
+        off_t length = (argc - first == 3) ? strtoll(argv[first + 2], 0, 0) : 0;
+        if (offset < 0 || length < 0) {
+          fprintf(stderr, "file_source needs [-r bytesPerSecond] path [offset [length]], with an offset and length "
+                  "of 0 or more - error\n");
+          doneProcessing = true;
+        } else {
+          doneProcessing = !dsppInstance.file_source(argv[first], offset, length, bytesPerSecond);
+        }
+      } else {
+        fprintf(stderr, "file_source needs [-r bytesPerSecond] path [offset [length]] - error\n");
+        doneProcessing = true;
       }
-      default:
-        return -2;
+      break;
+    }
+    case 50: {
+      if (argc == 3) {
+        doneProcessing = !dsppInstance.file_sink(argv[2]);
+      } else {
+        fprintf(stderr, "file_sink needs a path - error\n");
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 51:
+    case 52: {
+      float passband = 0.2;
+      float attenuation = 80.0;
+      if (argc <= 4) {
+        if (argc >= 3) sscanf(argv[2], "%f", &passband);
+        if (argc == 4) sscanf(argv[3], "%f", &attenuation);
+        HalfBandFilter filter(passband, attenuation, c == 51);
+        filter.filterSignal();
+        doneProcessing = true;
+      } else {
+        fprintf(stderr, "%s parameter error\n", argv[1]);
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 55: {
+      float passband = 0.2;
+      float attenuation = 80.0;
+      if (argc <= 4) {
+        if (argc >= 3) sscanf(argv[2], "%f", &passband);
+        if (argc == 4) sscanf(argv[3], "%f", &attenuation);
+        HalfBandFilter filter(passband, attenuation, true);
+        filter.filterQuarterShifted();
+        doneProcessing = true;
+      } else {
+        fprintf(stderr, "fsSlash4_byte_c parameter error\n");
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 56:
+    case 57: {
+      bool wide = c == 56;
+      double inputRate;
+      double audioRate;
+      double deemphasis = wide ? 75.0 : 0.0;
+      if (argc == 4 || argc == 5) {
+        sscanf(argv[2], "%lf", &inputRate);
+        sscanf(argv[3], "%lf", &audioRate);
+        if (argc == 5) sscanf(argv[4], "%lf", &deemphasis);
+        if (wide) {
+          FMDemod demodulator(inputRate, audioRate, 75000.0, 15000.0, 19000.0, deemphasis * 1e-6);
+          demodulator.demodulate();
+        } else {
+          FMDemod demodulator(inputRate, audioRate, 5000.0, 0.4 * audioRate, 0.5 * audioRate, deemphasis * 1e-6);
+          demodulator.demodulate();
+        }
+        doneProcessing = true;
+      } else {
+        fprintf(stderr, "%s parameter error\n", argv[1]);
+        doneProcessing = true;
+      }
+      break;
+    }
+    case 58:
+    case 59: {
+      bool complex = c == 59;
+      double timeConstant = DCBlock::DEFAULT_TIME_CONSTANT;
+      double imbalanceTimeConstant = DCBlock::DEFAULT_IMBALANCE_TIME_CONSTANT;
+      if (argc <= (complex ? 4 : 3)) {
+        if (argc >= 3) sscanf(argv[2], "%lf", &timeConstant);
+        if (argc == 4) sscanf(argv[3], "%lf", &imbalanceTimeConstant);
+        DCBlock blocker(complex, timeConstant, imbalanceTimeConstant);
+        blocker.filterSignal();
+        doneProcessing = true;
+      } else {
+        fprintf(stderr, "%s parameter error\n", argv[1]);
+        doneProcessing = true;
       }
-    if (doneProcessing) {
+      break;
+    }
+    default:
+      return -2;
+  }
+  return doneProcessing;
+
+}
+
+/* ---------------------------------------------------------------------- */
+/*
+ *      Run one command, measuring it when stats is not zero.  A pipeline is
+ *      not measured itself - each of its stages is.
+ */
+static int runCommand(dspp & dsppInstance, int c, int argc, char *argv[], const char * stats) {
+  if (!stats || c <= 0 || c == 'h' || c == 44) return dispatchCommand(dsppInstance, c, argc, argv);
+  StageStats stageStats(argv[1], stats);
+  stageStats.attach();
+  int status = dispatchCommand(dsppInstance, c, argc, argv);
+  stageStats.detach();
+  return status;
+}
+
+#ifndef DSPP_NO_MAIN  // dspp_bench links the stages without the command line
+int main(int argc, char *argv[]) {
+
+  dspp dsppInstance;
+
+  int c;
+
+  const unsigned int COMMAND_LENGTH = 32;
+
+  if (argc <= 1 || !argv[1] || (strlen(argv[1]) >= COMMAND_LENGTH)) {
+    fprintf(stderr, USAGE_STR, argv[0]);
+    return -2;
+  }
+
+  statsOption = takeStatsOption(argc, argv);
+
+  char command[COMMAND_LENGTH];
+
+  memset(command, 0, sizeof(command));
+
+  char * new_argv[argc];
+  if (argc > 1) {
+    if (argv[1][0] == '-') {
+      snprintf(command, sizeof(command)-1, "%s", argv[1]);
+    } else {
+      snprintf(command, sizeof(command)-3, "--%s", argv[1]);
+    }
+  } else {
+    fprintf(stderr, USAGE_STR, argv[0]);
+    return -2;
+  }
+
+  int index;
+
+  for (index = 0; index < argc; index++) {
+    if (index == 1) {
+      new_argv[1] = (char *) &command;
+    } else {
+      new_argv[index] = argv[index];
+    }
+  }
+
+  while ((c = getopt_long(argc, new_argv, "h", longOpts, NULL)) >= 0) {
+    int status = runCommand(dsppInstance, c, argc, argv, statsOption);
+    if (status < 0) {
+      return status;
+    }
+    if (status) {
       break;
     }
   }
@@ -1953,5 +2552,6 @@ int main(int argc, char *argv[]) {
   return 0;
 
 }
+#endif  // DSPP_NO_MAIN
 
 /* ---------------------------------------------------------------------- */
@@ -11,18 +11,34 @@
 #include <sys/socket.h>
 #include <sys/types.h>
 
+#include "Convert.h"
 #include "FIRFilter.h"
 #include "DsppFFT.h"
+#include "FMDemod.h"
 #include "FMMod.h"
+#include "FsSlash4.h"
+#include "NCO.h"
 #include "RealToQuadrature.h"
 #include "RTLTCPClient.h"
 #include "RTLTCPServer.h"
 #include "SFIRFilter.h"
 #include "CFilter.h"
+#include "DCBlock.h"
+#include "DownConverter.h"
+#include "HalfBandFilter.h"
+#include "MultiStageDecimator.h"
 #include "AGC.h"
 #include "FT8Window.h"
 #include "WSPRWindow.h"
 #include "WindowSample.h"
+#include "Stream.h"
+#include "Pipeline.h"
+#include "ShmRing.h"
+#include "FanOutRing.h"
+#include "TeeBranch.h"
+#include "FrameFormat.h"
+#include "MappedFile.h"
+#include "StageStats.h"
 /* ---------------------------------------------------------------------- */
 class dspp {
 
@@ -39,6 +55,7 @@ class dspp {
   int shift_frequency_uByteuByte(float cyclesPerSample);
   int fsSlash4_byte_byte();
   int decimate_cc(float cutOffFrequency, int M, int amount, int N, const char * window);
+  int decimate_cc(double inputRate, double outputRate, double passband, double stopband, double attenuation);
   int fmdemod_cf();
   int decimate_ff(float cutOffFrequency, int M, int amount, int N, const char * window);
   int convert_f_uInt16();
@@ -48,7 +65,7 @@ class dspp {
   int custom_fir_ff(const char * filePath, int M, int N, FIRFilter::WindowType window);
   int custom_fir_cc(const char * filePath, int M, int N, FIRFilter::WindowType window);
   int real_to_complex_fc();
-  int real_to_quadrature_fc(bool selector);
+  int real_to_quadrature_fc(bool selector, bool decimate);
   int real_of_complex_cf();
   int mag_cf();
   int gain(float gain);
@@ -57,16 +74,24 @@ class dspp {
   int tail(int amount);
   int convert_sInt16_f();
   int fft_cc(int numberOfComplexSamples);
-  int tee(char * otherStream);
+  int tee(char * otherStream, bool nonBlocking);
   int limit_real_stream();
   int dc_removal(float * buffer, int size);
   int agc(float target);
+  int agc(float target, float attack, float decay, int lookahead);
   int split_stream(char ** paths);
   int FT8_window(float dialFrequency, char * prefix, int numberOfCandidates, char * reporterID,
                   char * reporterLocation);
   int WSPR_window(float dialFrequency, char * prefix, int numberOfCandidates, char * reporterID,
                   char * reporterLocation);
   int window_sample(int samplesInPeriod, int modulo, int syncTo);
+  int convert_f_shm(const char * name, int size);
+  int convert_shm_f(const char * name);
+  int frame_wrap(const char * sampleType, int channels, double sampleRate, double centerFrequency);
+  int frame_unwrap(const char * sampleType, bool zeroFill);
+  int file_source(const char * path, off_t offset, off_t length, double bytesPerSecond);
+  int file_sink(const char * path);
+  int pipeline(const char * programName, const char * description, bool pin, int reportInterval);
 
   //dspp(void);
 
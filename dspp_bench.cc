@@ -0,0 +1,235 @@
+/*
+ *      dspp_bench.cc - in memory benchmark of the dspp processing stages
+ *
+ *      Copyright (C) 2026
+ *          Mark Broihier
+ *
+ *  Each case runs a stage, exactly as the dspp command would, between a
+ *  source that repeats a synthetic signal and a sink that throws the result
+ *  away, so no pipes or files are involved.  A case is repeated with twice
+ *  the input until it runs for at least the minimum time.  Results are
+ *  written to standard output as comma separated values, one line per
+ *  case, for comparing builds and hosts:
+ *
+ *    host,machine,compiler,case,parameters,samples,seconds,Msamples_per_s,ns_per_sample
+ *
+ *  A sample is one input sample of the stage - an I/Q pair for complex
+ *  streams.  Stage messages go to standard error.
+ *
+ *    dspp_bench [-t minimumSeconds] [case ...]
+ */
+
+/* ---------------------------------------------------------------------- */
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <sys/utsname.h>
+#include <functional>
+#include <vector>
+#include "dspp.h"
+/* ---------------------------------------------------------------------- */
+//  Stream that serves a pattern over and over until limit bytes have been
+//  read.
+class PatternSource : public Stream {
+ private:
+  const std::vector<unsigned char> & pattern;
+  size_t position;
+  size_t remaining;
+ public:
+  size_t read(void * buffer, size_t size, size_t count) {
+    unsigned char * destination = reinterpret_cast<unsigned char *>(buffer);
+    size_t wanted = size * count;
+    if (wanted > remaining) wanted = remaining / size * size;
+    for (size_t done = 0; done < wanted; ) {
+      size_t piece = pattern.size() - position;
+      if (piece > wanted - done) piece = wanted - done;
+      memcpy(destination + done, pattern.data() + position, piece);
+      position = (position + piece) % pattern.size();
+      done += piece;
+    }
+    remaining -= wanted;
+    return wanted / size;
+  }
+  size_t write(const void * buffer, size_t size, size_t count) { return 0; }
+  void close(void) { remaining = 0; }
+  PatternSource(const std::vector<unsigned char> & pattern, size_t limit) :
+    pattern(pattern), position(0), remaining(limit) {}
+};
+
+/* ---------------------------------------------------------------------- */
+//  Stream that counts and discards what is written to it.
+class DiscardSink : public Stream {
+ private:
+  size_t bytes;
+ public:
+  size_t read(void * buffer, size_t size, size_t count) { return 0; }
+  size_t write(const void * buffer, size_t size, size_t count) {
+    bytes += size * count;
+    return count;
+  }
+  void close(void) {}
+  size_t written(void) { return bytes; }
+  DiscardSink(void) : bytes(0) {}
+};
+
+/* ---------------------------------------------------------------------- */
+enum SignalType { UBYTE_IQ, BYTE_IQ, FLOAT_IQ, FLOAT_REAL, SINT16_REAL };
+
+struct BenchCase {
+  const char * name;
+  const char * parameters;
+  SignalType signal;
+  size_t sampleBytes;                  // bytes per input sample
+  std::function<void(void)> run;
+};
+
+/* ---------------------------------------------------------------------- */
+//  About a second of each signal at 2.4 MS/s: a tone a tenth of the sample
+//  rate off center with a little noise, so that nothing is trivially zero.
+static std::vector<unsigned char> makeSignal(SignalType type) {
+  const size_t SAMPLES = 1 << 20;
+  std::vector<unsigned char> signal;
+  srand(1);
+  for (size_t index = 0; index < SAMPLES; index++) {
+    float phase = 2.0 * M_PI * 0.1 * index;
+    float noise = (rand() / (float) RAND_MAX - 0.5) * 0.02;
+    float I = 0.7 * cos(phase) + noise;
+    float Q = -0.7 * sin(phase) - noise;
+    switch (type) {
+      case UBYTE_IQ:
+        signal.push_back((unsigned char) (127.5 + I * 127.0));
+        signal.push_back((unsigned char) (127.5 + Q * 127.0));
+        break;
+      case BYTE_IQ:
+        signal.push_back((unsigned char) (signed char) (I * 127.0));
+        signal.push_back((unsigned char) (signed char) (Q * 127.0));
+        break;
+      case FLOAT_IQ:
+        signal.insert(signal.end(), (unsigned char *) &I, (unsigned char *) &I + sizeof(float));
+        signal.insert(signal.end(), (unsigned char *) &Q, (unsigned char *) &Q + sizeof(float));
+        break;
+      case FLOAT_REAL:
+        signal.insert(signal.end(), (unsigned char *) &I, (unsigned char *) &I + sizeof(float));
+        break;
+      case SINT16_REAL: {
+        short value = (short) (I * 32767.0);
+        signal.insert(signal.end(), (unsigned char *) &value, (unsigned char *) &value + sizeof(short));
+        break;
+      }
+    }
+  }
+  return signal;
+}
+
+/* ---------------------------------------------------------------------- */
+static double seconds(void) {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return time.tv_sec + time.tv_nsec * 1e-9;
+}
+
+/* ---------------------------------------------------------------------- */
+static std::vector<BenchCase> benchCases(dspp & instance) {
+  std::vector<BenchCase> cases = {
+    { "convert_uByte_f", "", UBYTE_IQ, 2, [&] { instance.convert_uByte_f(); } },
+    { "convert_byte_f", "", BYTE_IQ, 2, [&] { instance.convert_byte_f(); } },
+    { "convert_uByte_byte", "", UBYTE_IQ, 2, [&] { instance.convert_uByte_byte(); } },
+    { "convert_byte_sInt16", "", BYTE_IQ, 2, [&] { instance.convert_byte_sInt16(); } },
+    { "convert_f_byte", "", FLOAT_IQ, 8, [&] { instance.convert_f_byte(); } },
+    { "convert_f_sInt16", "", FLOAT_REAL, 4, [&] { instance.convert_f_sInt16(); } },
+    { "convert_f_uInt16", "", FLOAT_REAL, 4, [&] { instance.convert_f_uInt16(); } },
+    { "convert_sInt16_f", "", SINT16_REAL, 2, [&] { instance.convert_sInt16_f(); } },
+    { "shift_frequency_cc", "-0.1", FLOAT_IQ, 8, [&] { instance.shift_frequency_cc(-0.1); } },
+    { "shift_frequency_uByte_uByte", "-0.1", UBYTE_IQ, 2, [&] { instance.shift_frequency_uByteuByte(-0.1); } },
+    { "fsSlash4_byte_byte", "", UBYTE_IQ, 2, [&] { instance.fsSlash4_byte_byte(); } },
+    { "fsSlash4_byte_c", "0.2 80", UBYTE_IQ, 2, [&] { HalfBandFilter filter(0.2, 80.0, true); filter.filterQuarterShifted(); } },
+    { "decimate_cc", "0.005 79 50 40 HAMMING (2.4 MS/s to 48 kS/s)", FLOAT_IQ, 8,
+      [&] { instance.decimate_cc(0.005, 79, 50, 40, "HAMMING"); } },
+    { "decimate_ff", "0.1 79 5 40 HAMMING", FLOAT_REAL, 4,
+      [&] { instance.decimate_ff(0.1, 79, 5, 40, "HAMMING"); } },
+    { "decimate_cc", "0.02 511 1 1024 HAMMING (long filter)", FLOAT_IQ, 8,
+      [&] { instance.decimate_cc(0.02, 511, 1, 1024, "HAMMING"); } },
+    { "decimate_cc", "-p 2400000 375 150 187.5 (WSPR channel in one cascade)", FLOAT_IQ, 8,
+      [&] { instance.decimate_cc(2400000.0, 375.0, 150.0, 187.5, 80.0); } },
+    { "halfband_cc", "0.2 80", FLOAT_IQ, 8, [&] { HalfBandFilter filter(0.2, 80.0, true); filter.filterSignal(); } },
+    { "halfband_ff", "0.2 80", FLOAT_REAL, 4, [&] { HalfBandFilter filter(0.2, 80.0, false); filter.filterSignal(); } },
+    { "sfir_cc", "0.3 4", FLOAT_IQ, 8, [&] { SFIRFilter filter(0.3, 4); filter.filterSignal(); } },
+    { "sfir_ff", "0.3 4", FLOAT_REAL, 4, [&] { SFIRFilter filter(0.3, 4, false, false); filter.filterSignal(); } },
+    { "comb_byte_c", "10", BYTE_IQ, 2, [&] { CFilter filter(10); filter.filterSignal(); } },
+    { "comb_uByte_c", "40 4 1 31", UBYTE_IQ, 2, [&] { CFilter filter(40, 4, 1, true, 31); filter.filterSignal(); } },
+    { "ddc_uByte_cc", "-0.254167 0.005 79 50 (2.4 MS/s to 48 kS/s)", UBYTE_IQ, 2,
+      [&] { DownConverter converter(-0.254167, 0.005, 79, 50); converter.filterSignal(); } },
+    { "ddc_uByte_cc", "-0.254167 0.02 511 8 (long filter)", UBYTE_IQ, 2,
+      [&] { DownConverter converter(-0.254167, 0.02, 511, 8); converter.filterSignal(); } },
+    { "dc_removal", "", FLOAT_REAL, 4, [&] { std::vector<float> history(4096, 0.0f); instance.dc_removal(history.data(), 4096); } },
+    { "dc_block_ff", "", FLOAT_REAL, 4, [&] { DCBlock blocker(false, 16384.0, 0.0); blocker.filterSignal(); } },
+    { "dc_block_cc", "", FLOAT_IQ, 8, [&] { DCBlock blocker(true, 16384.0, 1048576.0); blocker.filterSignal(); } },
+    { "agc", "0.5", FLOAT_REAL, 4, [&] { instance.agc(0.5); } },
+    { "agc", "0.5 64 8192 256", FLOAT_REAL, 4, [&] { instance.agc(0.5, 64.0, 8192.0, 256); } },
+    { "fft_cc", "1024", FLOAT_IQ, 8, [&] { instance.fft_cc(1024); } },
+    { "real_to_quadrature_fc", "-H", FLOAT_REAL, 4, [&] { instance.real_to_quadrature_fc(true, false); } },
+    { "real_to_quadrature_fc", "-H -d", FLOAT_REAL, 4, [&] { instance.real_to_quadrature_fc(true, true); } },
+    { "real_to_quadrature_fc", "", FLOAT_REAL, 4, [&] { instance.real_to_quadrature_fc(false, false); } },
+    { "fmdemod_cf", "", FLOAT_IQ, 8, [&] { instance.fmdemod_cf(); } },
+    { "wbfm_demod", "240000 48000", FLOAT_IQ, 8,
+      [&] { FMDemod demodulator(240000.0, 48000.0, 75000.0, 15000.0, 19000.0, 75e-6); demodulator.demodulate(); } },
+    { "nbfm_demod", "48000 22050", FLOAT_IQ, 8,
+      [&] { FMDemod demodulator(48000.0, 22050.0, 5000.0, 8820.0, 11025.0, 0.0); demodulator.demodulate(); } },
+    { "fmmod_fc", "48000", FLOAT_REAL, 4, [&] { FMMod modulator(48000); modulator.modulate(); } },
+    { "mag_cf", "", FLOAT_IQ, 8, [&] { instance.mag_cf(); } },
+    { "real_of_complex_cf", "", FLOAT_IQ, 8, [&] { instance.real_of_complex_cf(); } },
+    { "gain", "2.0", FLOAT_REAL, 4, [&] { instance.gain(2.0); } },
+    { "limit_real_stream", "", FLOAT_REAL, 4, [&] { instance.limit_real_stream(); } },
+  };
+  return cases;
+}
+
+/* ---------------------------------------------------------------------- */
+static bool selected(const char * name, int argc, char * argv[], int first) {
+  if (first >= argc) return true;
+  for (int index = first; index < argc; index++) {
+    if (strcmp(argv[index], name) == 0) return true;
+  }
+  return false;
+}
+
+/* ---------------------------------------------------------------------- */
+int main(int argc, char * argv[]) {
+  double minimumTime = 0.5;
+  int first = 1;
+  if (argc > 2 && strcmp(argv[1], "-t") == 0) {
+    minimumTime = atof(argv[2]);
+    first = 3;
+  }
+  struct utsname host;
+  uname(&host);
+  dspp instance;
+  std::vector<std::vector<unsigned char>> signals;
+  for (int type = UBYTE_IQ; type <= SINT16_REAL; type++) signals.push_back(makeSignal((SignalType) type));
+
+  printf("host,machine,compiler,case,parameters,samples,seconds,Msamples_per_s,ns_per_sample\n");
+  fflush(stdout);
+  for (BenchCase & benchCase : benchCases(instance)) {
+    if (!selected(benchCase.name, argc, argv, first)) continue;
+    size_t samples = 1 << 18;
+    double elapsed = 0.0;
+    for (;;) {
+      PatternSource source(signals[benchCase.signal], samples * benchCase.sampleBytes);
+      DiscardSink sink;
+      Stream::bind(&source, &sink);
+      double start = seconds();
+      benchCase.run();
+      elapsed = seconds() - start;
+      if (elapsed >= minimumTime || samples >= ((size_t) 1 << 34)) break;
+      samples *= 2;
+    }
+    Stream::bind(0, 0);
+    printf("%s,%s,%s,%s,%s,%lu,%.6f,%.3f,%.3f\n", host.nodename, host.machine, "g++ " __VERSION__,
+           benchCase.name, benchCase.parameters, (unsigned long) samples, elapsed,
+           samples / elapsed * 1e-6, elapsed * 1e9 / samples);
+    fflush(stdout);
+  }
+  return 0;
+}
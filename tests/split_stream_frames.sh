@@ -0,0 +1,37 @@
+#!/bin/sh
+#
+#      split_stream_frames.sh - a framed stream through split_stream -d to
+#                               a command that falls behind
+#
+#      Copyright (C) 2026
+#          Mark Broihier
+#
+#  The command must lose whole frames only: frame_unwrap reads every frame
+#  that arrives, reports the gaps and, with -z, gives back a stream of the
+#  original length with zeros where frames were dropped.
+#
+DSPP=${DSPP:-./dspp}
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+fail() {
+  echo "split_stream_frames: $1"
+  cat "$WORK/unwrap.log"
+  exit 1
+}
+
+head -c 24000000 /dev/urandom > "$WORK/raw.u8"
+$DSPP frame_wrap uByte 2 2400000 0 < "$WORK/raw.u8" > "$WORK/framed.dspf" 2> /dev/null
+# paced over 2 seconds to a command that stalls twice for longer than the
+# ring lasts
+STALLING="sh -c 'sleep 0.6; dd bs=4096 count=300 iflag=fullblock 2> /dev/null; sleep 0.6; cat'"
+$DSPP file_source -r 12000000 "$WORK/framed.dspf" 2> /dev/null |
+  $DSPP split_stream -d "$STALLING | $DSPP frame_unwrap -z uByte > $WORK/out.u8 2> $WORK/unwrap.log" \
+  > /dev/null 2> "$WORK/split.log"
+
+grep -q "lost frame alignment\|went back\|ended inside" "$WORK/unwrap.log" && fail "frames were corrupted"
+grep -q "samples missing" "$WORK/unwrap.log" || fail "nothing was dropped, the test proves nothing"
+[ "$(wc -c < "$WORK/out.u8")" -eq "$(wc -c < "$WORK/raw.u8")" ] || fail "output length differs from the input"
+# every byte that differs from the input must be a zero filled sample
+BAD=$(cmp -l "$WORK/raw.u8" "$WORK/out.u8" | awk '$3 != 0 { bad++ } END { print bad + 0 }')
+[ "$BAD" -eq 0 ] || fail "$BAD bytes came through changed"
+echo "split_stream_frames: passed, $(grep "samples missing" "$WORK/unwrap.log")"